@@ -138,6 +138,8 @@ typedef struct {
 typedef struct {
    unsigned long long         ieee_address;
    struct input_event         event;
+   ctrlm_timestamp_t          received;  // monotonic time the event was read from the input device
+   unsigned long long         input_us;  // time from the event timestamp to the read, 0 when not known
 } ctrlm_hal_ble_IndKeypress_params_t;
 
 typedef struct {
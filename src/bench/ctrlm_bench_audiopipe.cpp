@@ -0,0 +1,149 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+// Measures the BLE voice audio path from the bluez notification pipe to the pipe read by the speech router.
+// A SEQPACKET socketpair stands in for the bluez notification pipe, so each send is one 20 byte notification,
+// and a reader thread drains the output pipe like the speech router does.  The per stream stats are logged by
+// GattAudioPipe::stop() and a summary is printed at the end.
+//
+// usage: ctrlm_bench_audiopipe [frames] [batched 0|1] [frame interval us]
+//
+// Without a frame interval the notifications are sent as fast as the socket takes them, which measures the cost
+// of the path.  The output pipe is packetised so every read must return exactly one frame.  The exit status is non
+// zero when any audio was lost or a read returned anything but one frame.  A frame interval gives latency figures
+// closer to a real RCU.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/socket.h>
+#include <memory>
+#include "blercu/bleservices/gatt/gatt_audiopipe.h"
+#include "blercu/bluez/blegattnotifypipe.h"
+#include "ctrlm_log_ble.h"
+
+#define BENCH_FRAME_SIZE        (100)
+#define BENCH_NOTIFICATION_SIZE (20)
+
+typedef struct {
+   int                fd;
+   unsigned long long bytes;
+   unsigned long long reads;
+   unsigned long long reads_bad; // reads that didn't return exactly one frame
+} bench_reader_t;
+
+static void *bench_reader_thread(void *data) {
+   bench_reader_t *reader = (bench_reader_t *)data;
+   uint8_t buffer[BENCH_FRAME_SIZE * 32];
+   struct pollfd pfd = { .fd = reader->fd, .events = POLLIN, .revents = 0 };
+
+   while(poll(&pfd, 1, -1) > 0) {
+      ssize_t rd = read(reader->fd, buffer, sizeof(buffer));
+      if(rd > 0) {
+         reader->bytes += rd;
+         reader->reads++;
+         if(rd != BENCH_FRAME_SIZE) {
+            reader->reads_bad++;
+         }
+      } else if(rd == 0 || (errno != EAGAIN && errno != EINTR)) {
+         break;
+      }
+   }
+   return(NULL);
+}
+
+int main(int argc, char *argv[]) {
+   uint32_t frames      = (argc > 1) ? strtoul(argv[1], NULL, 0) : 5000;
+   bool     batched     = (argc > 2) ? (atoi(argv[2]) != 0) : true;
+   uint32_t interval_us = (argc > 3) ? strtoul(argv[3], NULL, 0) : 0;
+
+   xlog_init(XLOG_MODULE_ID, NULL, 0, true, false);
+   xlog_level_set_all(XLOG_LEVEL_INFO);
+
+   int sv[2];
+   if(socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) < 0) {
+      perror("socketpair");
+      return(1);
+   }
+
+   std::shared_ptr<bool> alive = std::make_shared<bool>(true);
+   sem_t closed;
+   sem_init(&closed, 0, 0);
+
+   std::unique_ptr<GattAudioPipe> audio_pipe(new GattAudioPipe(BENCH_FRAME_SIZE, 0, NULL, -1, batched));
+   BleGattNotifyPipe notify_pipe(sv[1], BENCH_NOTIFICATION_SIZE, BleUuid());
+   close(sv[1]);
+   if(!audio_pipe->isValid() || !notify_pipe.isValid()) {
+      fprintf(stderr, "failed to create pipes\n");
+      return(1);
+   }
+
+   GattAudioPipe *pipe = audio_pipe.get();
+   notify_pipe.addNotificationSlot(Slot<const std::vector<uint8_t> &>(alive, [pipe](const std::vector<uint8_t> &value) {
+      pipe->addNotification(value.data(), value.size());
+   }));
+   notify_pipe.addBatchEndSlot(Slot<>(alive, [pipe]() { pipe->flush(); }));
+   notify_pipe.addClosedSlot(Slot<>(alive, [&closed]() { sem_post(&closed); }));
+
+   bench_reader_t reader = { .fd = audio_pipe->takeOutputReadFd(), .bytes = 0, .reads = 0, .reads_bad = 0 };
+   pthread_t reader_thread;
+   pthread_create(&reader_thread, NULL, bench_reader_thread, &reader);
+
+   audio_pipe->start();
+
+   struct timespec begin, end;
+   clock_gettime(CLOCK_MONOTONIC, &begin);
+
+   uint8_t notification[BENCH_NOTIFICATION_SIZE];
+   for(uint32_t frame = 0; frame < frames; frame++) {
+      for(uint32_t offset = 0; offset < BENCH_FRAME_SIZE; offset += BENCH_NOTIFICATION_SIZE) {
+         memset(notification, (uint8_t)frame, sizeof(notification));
+         if(send(sv[0], notification, sizeof(notification), MSG_NOSIGNAL) != sizeof(notification)) {
+            perror("send");
+            return(1);
+         }
+      }
+      if(interval_us > 0) {
+         usleep(interval_us);
+      }
+   }
+   close(sv[0]);
+   sem_wait(&closed);
+
+   clock_gettime(CLOCK_MONOTONIC, &end);
+   audio_pipe->stop();
+   notify_pipe.shutdown();
+
+   uint32_t frames_written = audio_pipe->framesWritten();
+   uint32_t output_batches = audio_pipe->outputBatches();
+   *alive = false;
+   audio_pipe.reset(); // closes the write end so the reader sees end of stream
+   pthread_join(reader_thread, NULL);
+   close(reader.fd);
+   sem_destroy(&closed);
+
+   double elapsed_us = ((end.tv_sec - begin.tv_sec) * 1000000.0) + ((end.tv_nsec - begin.tv_nsec) / 1000.0);
+   printf("mode <%s> frames <%u> written <%u> batches <%u> read <%llu> bytes in <%llu> reads, <%llu> not one frame\n", batched ? "batched" : "per frame", frames, frames_written, output_batches, reader.bytes, reader.reads, reader.reads_bad);
+   printf("elapsed <%.0f> us, <%.2f> us per frame, <%.2f> us per notification\n", elapsed_us, elapsed_us / frames, elapsed_us / (frames * (BENCH_FRAME_SIZE / BENCH_NOTIFICATION_SIZE)));
+
+   return((reader.bytes == (unsigned long long)frames * BENCH_FRAME_SIZE && reader.reads_bad == 0) ? 0 : 1);
+}
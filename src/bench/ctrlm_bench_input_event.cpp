@@ -0,0 +1,151 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+// Measures the cost of injecting a key through the uinput writer.  The constexpr key table is first checked against
+// ctrlm_key_to_linux_entries, then the lookup, write_event_internal and write_event are timed in ns per key.
+//
+// usage: ctrlm_bench_input_event [keys] [uinput 0|1]
+//
+// By default the events are written to /dev/null so only the lookup and the syscall are measured.  With uinput set
+// a virtual device is created (root is needed) and the time includes the kernel input core.  The exit status is non
+// zero if the table does not match the entry list or a write fails.
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <map>
+#include <vector>
+#include "ctrlm_input_event_writer.h"
+#include "ctrlm_log.h"
+#include "ctrlm_utils.h"
+
+class ctrlm_bench_input_event_writer : public ctrlm_input_event_writer {
+public:
+   bool attach(int fd) {
+      fd_          = fd;
+      initialized_ = (fd >= 0);
+      return(initialized_);
+   }
+
+   bool write_internal(uint32_t scan_code, uint16_t key_code, key_stroke stroke) {
+      return(write_event_internal(scan_code, key_code, stroke));
+   }
+};
+
+// ctrlm_utils.cpp pulls in the rest of the daemon, the writer only needs the name for its logs
+const char *ctrlm_key_code_str(ctrlm_key_code_t key_code) {
+   return("KEY");
+}
+
+static bool bench_values_equal(const linux_ui_code_values_t &one, const linux_ui_code_values_t &two) {
+   return(one.key_code == two.key_code && one.scan_code == two.scan_code && one.modifier == two.modifier && one.mapped == two.mapped);
+}
+
+// Every code must translate to the last entry listed for it, and codes that are not listed must be unmapped
+static bool bench_table_check(std::map<ctrlm_key_code_t, linux_ui_code_values_t> &entries) {
+   bool ret = true;
+   for(auto const &entry : ctrlm_key_to_linux_entries) {
+      entries[entry.code] = entry.values;
+   }
+   for(unsigned int code = 0; code < ctrlm_key_to_linux_table_t::CODE_QTY * 2; code++) {
+      auto entry = entries.find((ctrlm_key_code_t)code);
+      const linux_ui_code_values_t expected = (entry == entries.end()) ? linux_ui_code_values_t() : entry->second;
+      if(!bench_values_equal(ctrlm_key_to_linux_table.at((ctrlm_key_code_t)code), expected)) {
+         fprintf(stderr, "key table mismatch for code 0x%02X\n", code);
+         ret = false;
+      }
+   }
+   return(ret);
+}
+
+int main(int argc, char *argv[]) {
+   uint32_t keys   = (argc > 1) ? strtoul(argv[1], NULL, 0) : 1000000;
+   bool     uinput = (argc > 2) ? (atoi(argv[2]) != 0) : false;
+
+   xlog_init(XLOG_MODULE_ID, NULL, 0, true, false);
+   xlog_level_set_all(XLOG_LEVEL_WARN);
+
+   std::map<ctrlm_key_code_t, linux_ui_code_values_t> entries;
+   if(!bench_table_check(entries)) {
+      return(1);
+   }
+   printf("key table matches <%zu> entries\n", entries.size());
+
+   ctrlm_bench_input_event_writer writer;
+   if(uinput) {
+      if(!writer.init("ctrlm bench", 0, 0)) {
+         fprintf(stderr, "failed to create uinput device\n");
+         return(1);
+      }
+   } else if(!writer.attach(open("/dev/null", O_WRONLY | O_CLOEXEC))) {
+      perror("open");
+      return(1);
+   }
+
+   // The codes pressed, in list order so the map and the table see the same sequence
+   std::vector<ctrlm_key_code_t> codes;
+   for(auto const &entry : ctrlm_key_to_linux_entries) {
+      if(entry.values.key_code != KEY_RESERVED) {
+         codes.push_back(entry.code);
+      }
+   }
+
+   ctrlm_timestamp_t begin, end;
+   volatile uint32_t sink = 0;
+
+   ctrlm_timestamp_get_monotonic(&begin);
+   for(uint32_t key = 0; key < keys; key++) {
+      sink += entries.find(codes[key % codes.size()])->second.key_code;
+   }
+   ctrlm_timestamp_get_monotonic(&end);
+   double map_ns = (double)ctrlm_timestamp_subtract_ns(begin, end) / keys;
+
+   ctrlm_timestamp_get_monotonic(&begin);
+   for(uint32_t key = 0; key < keys; key++) {
+      sink += ctrlm_key_to_linux_table.at(codes[key % codes.size()]).key_code;
+   }
+   ctrlm_timestamp_get_monotonic(&end);
+   double table_ns = (double)ctrlm_timestamp_subtract_ns(begin, end) / keys;
+
+   bool ret = true;
+   ctrlm_timestamp_get_monotonic(&begin);
+   for(uint32_t key = 0; key < keys && ret; key++) {
+      const linux_ui_code_values_t &values = ctrlm_key_to_linux_table.at(codes[key % codes.size()]);
+      ret = writer.write_internal(values.scan_code, values.key_code, (key & 1) ? key_stroke::UP : key_stroke::DOWN);
+   }
+   ctrlm_timestamp_get_monotonic(&end);
+   double internal_ns = (double)ctrlm_timestamp_subtract_ns(begin, end) / keys;
+
+   ctrlm_timestamp_get_monotonic(&begin);
+   for(uint32_t key = 0; key < keys && ret; key++) {
+      ret = (writer.write_event(codes[key % codes.size()], (key & 1) ? CTRLM_KEY_STATUS_UP : CTRLM_KEY_STATUS_DOWN) != KEY_RESERVED);
+   }
+   ctrlm_timestamp_get_monotonic(&end);
+   double event_ns = (double)ctrlm_timestamp_subtract_ns(begin, end) / keys;
+
+   writer.shutdown();
+
+   if(!ret) {
+      fprintf(stderr, "write failed\n");
+      return(1);
+   }
+   printf("output <%s> keys <%u>\n", uinput ? "uinput" : "/dev/null", keys);
+   printf("lookup map <%.1f> ns table <%.1f> ns, write_event_internal <%.1f> ns, write_event <%.1f> ns per key\n", map_ns, table_ns, internal_ns, event_ns);
+
+   return(0);
+}
@@ -0,0 +1,186 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+// Measures the firmware upgrade DATA packet path against a simulated packet characteristic.  The characteristic is the
+// far end of a SEQPACKET socketpair, the same socket type bluez hands out for AcquireWrite, drained by a reader thread.
+//
+// usage: ctrlm_bench_upgrade [image kB] [reader delay us]
+//
+// Each 20 byte packet (2 byte block id and 18 bytes of image) is built either by a seek and read of the image file,
+// as the upgrade service used to, or by a copy from the image held in memory.  Writes are non blocking; when the
+// socket is full the sender waits for POLLOUT and resumes, as the service does with its G_IO_OUT watch.  A reader
+// delay slows the characteristic down so the socket fills.  The exit status is non zero if the reader does not
+// receive the whole image.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include "ctrlm_log.h"
+#include "ctrlm_utils.h"
+
+#define BENCH_PACKET_DATA_SIZE (18)
+
+typedef struct {
+   uint64_t packets;
+   uint64_t deferred;
+   double   ns;
+} bench_result_t;
+
+static bool bench_send(int fd, const uint8_t *packet, size_t length, uint64_t *deferred) {
+   while(send(fd, packet, length, MSG_DONTWAIT | MSG_NOSIGNAL) < 0) {
+      if(errno != EAGAIN && errno != EWOULDBLOCK) {
+         perror("send");
+         return(false);
+      }
+      (*deferred)++;
+      struct pollfd pfd = { fd, POLLOUT, 0 };
+      if(poll(&pfd, 1, -1) < 0) {
+         perror("poll");
+         return(false);
+      }
+   }
+   return(true);
+}
+
+static bool bench_run(int image_fd, const std::vector<uint8_t> &image, unsigned long delay_us, bench_result_t *result) {
+   uint64_t received = 0;
+
+   int sv[2];
+   if(socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) < 0) {
+      perror("socketpair");
+      return(false);
+   }
+   int reader_fd = sv[1];
+
+   std::thread reader([reader_fd, delay_us, &received] {
+      uint8_t buffer[64];
+      ssize_t rd;
+      while((rd = read(reader_fd, buffer, sizeof(buffer))) > 0) {
+         received += (rd - 2);
+         if(delay_us) {
+            usleep(delay_us);
+         }
+      }
+   });
+
+   bool ret = true;
+   ctrlm_timestamp_t begin, end;
+   *result = {};
+
+   ctrlm_timestamp_get_monotonic(&begin);
+   for(size_t offset = 0; offset <= image.size() && ret; offset += BENCH_PACKET_DATA_SIZE) {
+      uint8_t packet[2 + BENCH_PACKET_DATA_SIZE];
+      uint16_t block_id = (uint16_t)(result->packets & 0xFFFF);
+      size_t length;
+
+      packet[0] = (block_id >> 8) & 0xFF;
+      packet[1] = block_id & 0xFF;
+
+      if(image_fd >= 0) {
+         if(lseek(image_fd, offset, SEEK_SET) < 0) {
+            perror("lseek");
+            ret = false;
+            break;
+         }
+         ssize_t rd = read(image_fd, &packet[2], BENCH_PACKET_DATA_SIZE);
+         if(rd < 0) {
+            perror("read");
+            ret = false;
+            break;
+         }
+         length = rd;
+         std::vector<uint8_t> copy(packet, packet + 2 + length);
+         ret = bench_send(sv[0], copy.data(), copy.size(), &result->deferred);
+      } else {
+         length = std::min<size_t>(BENCH_PACKET_DATA_SIZE, image.size() - offset);
+         memcpy(&packet[2], image.data() + offset, length);
+         ret = bench_send(sv[0], packet, 2 + length, &result->deferred);
+      }
+      result->packets++;
+
+      // the last packet is short, an empty one if the image is a multiple of the packet size
+      if(length < BENCH_PACKET_DATA_SIZE) {
+         break;
+      }
+   }
+   ctrlm_timestamp_get_monotonic(&end);
+
+   close(sv[0]);
+   reader.join();
+   close(sv[1]);
+
+   result->ns = (double)ctrlm_timestamp_subtract_ns(begin, end);
+
+   if(ret && received != image.size()) {
+      fprintf(stderr, "reader received <%llu> of <%zu> bytes\n", (unsigned long long)received, image.size());
+      ret = false;
+   }
+   return(ret);
+}
+
+static void bench_print(const char *name, size_t size, const bench_result_t &result) {
+   printf("%-12s <%.0f> ns per packet <%.1f> MB/s deferred <%llu>\n", name, result.ns / result.packets,
+          (result.ns == 0) ? 0.0 : (size * 1000.0) / result.ns, (unsigned long long)result.deferred);
+}
+
+int main(int argc, char *argv[]) {
+   size_t        size     = ((argc > 1) ? strtoul(argv[1], NULL, 0) : 256) * 1024;
+   unsigned long delay_us = (argc > 2) ? strtoul(argv[2], NULL, 0) : 0;
+
+   xlog_init(XLOG_MODULE_ID, NULL, 0, true, false);
+   xlog_level_set_all(XLOG_LEVEL_WARN);
+
+   std::vector<uint8_t> image(size);
+   for(size_t i = 0; i < size; i++) {
+      image[i] = (uint8_t)(i * 31 + 7);
+   }
+
+   char path[] = "/tmp/ctrlm_bench_upgrade_XXXXXX";
+   int image_fd = mkstemp(path);
+   if(image_fd < 0) {
+      perror("mkstemp");
+      return(1);
+   }
+   unlink(path);
+   if(write(image_fd, image.data(), size) != (ssize_t)size) {
+      perror("write");
+      close(image_fd);
+      return(1);
+   }
+
+   bench_result_t file_result, memory_result;
+   bool ret = bench_run(image_fd, image, delay_us, &file_result) &&
+              bench_run(-1, image, delay_us, &memory_result);
+   close(image_fd);
+
+   if(!ret) {
+      return(1);
+   }
+   printf("image <%zu> bytes packets <%llu> reader delay <%lu> us\n", size, (unsigned long long)memory_result.packets, delay_us);
+   bench_print("file read", size, file_result);
+   bench_print("memory", size, memory_result);
+
+   return(0);
+}
@@ -0,0 +1,42 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+// The timestamp helpers used by the code under benchmark.  ctrlm_utils.cpp has them too but it pulls in
+// the rest of the daemon, so the benchmarks get these minimal copies instead.
+#include <time.h>
+#include "ctrlm_hal.h"
+
+void ctrlm_timestamp_get(ctrlm_timestamp_t *timestamp) {
+   clock_gettime(CLOCK_REALTIME, timestamp);
+}
+
+void ctrlm_timestamp_get_monotonic(ctrlm_timestamp_t *timestamp) {
+   clock_gettime(CLOCK_MONOTONIC_RAW, timestamp);
+}
+
+signed long long ctrlm_timestamp_subtract_ns(ctrlm_timestamp_t one, ctrlm_timestamp_t two) {
+   return(((two.tv_sec - one.tv_sec) * 1000000000LL) + two.tv_nsec - one.tv_nsec);
+}
+
+signed long long ctrlm_timestamp_subtract_us(ctrlm_timestamp_t one, ctrlm_timestamp_t two) {
+   return(ctrlm_timestamp_subtract_ns(one, two) / 1000);
+}
+
+signed long long ctrlm_timestamp_subtract_ms(ctrlm_timestamp_t one, ctrlm_timestamp_t two) {
+   return(ctrlm_timestamp_subtract_ns(one, two) / 1000000);
+}
@@ -2369,7 +2369,7 @@ void ctrlm_obj_network_ble_t::ind_process_unpaired(void *data, int size) {
 void ctrlm_obj_network_ble_t::ind_keypress(ctrlm_hal_ble_IndKeypress_params_t *params) {
 
    // push to the main queue and process it synchronously there
-   ctrlm_main_queue_handler_push(CTRLM_HANDLER_NETWORK, 
+   ctrlm_main_queue_handler_push_priority(CTRLM_MAIN_QUEUE_PRIORITY_INTERACTIVE, CTRLM_HANDLER_NETWORK, 
          (ctrlm_msg_handler_network_t)&ctrlm_obj_network_ble_t::ind_process_keypress, 
          params, sizeof(*params), NULL, id_);
 }
@@ -2383,6 +2383,10 @@ void ctrlm_obj_network_ble_t::ind_process_keypress(void *data, int size) {
       XLOGD_ERROR("Invalid size!");
       return;
    }
+   ctrlm_key_latency_trace_t trace;
+   trace.received = dqm->received;
+   trace.input_us = dqm->input_us;
+   ctrlm_timestamp_get_monotonic(&trace.dequeued);
    if (!ready_) {
       XLOGD_INFO("Network is not ready!");
       return;
@@ -2515,6 +2519,7 @@ void ctrlm_obj_network_ble_t::ind_process_keypress(void *data, int size) {
       }
 
       controller->process_event_key(key_status, dqm->event.code, mask_key_codes_get());
+      controller->key_latency_add(trace);
    } else {
       XLOGD_WARN("Controller (%s) doesn't exist in the network, doing nothing...", 
             ctrlm_convert_mac_long_to_string(dqm->ieee_address).c_str());
@@ -2661,6 +2666,7 @@ void ctrlm_obj_network_ble_t::controllers_load() {
 
    ctrlm_db_ble_controllers_list(network_id, &controller_ids);
 
+   // The attributes read while loading are served by the database value cache
    for (auto &id : controller_ids) {
       ctrlm_obj_controller_ble_t *add_controller = new ctrlm_obj_controller_ble_t(id, *this, 0, CTRLM_BLE_RESULT_VALIDATION_SUCCESS);
       add_controller->db_load();
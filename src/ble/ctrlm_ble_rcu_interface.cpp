@@ -29,17 +29,36 @@
 #define KEY_INPUT_DEVICE_BASE_DIR    "/dev/input/"
 #define KEY_INPUT_DEVICE_BASE_FILE   "event"
 
+#define KEY_MONITOR_EPOLL_EVENTS_MAX            (16)
+#define KEY_MONITOR_INPUT_EVENTS_MAX            (64)
+#define KEY_MONITOR_RESCAN_PERIOD_MS            (30000)
+#define KEY_MONITOR_RESCAN_PERIOD_NO_INOTIFY_MS (1000)
+#define KEY_MONITOR_STATS_PERIOD_MS             (60 * 60 * 1000)
+
+typedef struct {
+    int               fd = -1;
+    ctrlm_timestamp_t opened;   // When the input device was opened, to measure the time to the first key
+    bool              key_seen = false;
+} ctrlm_ble_key_input_t;
+
 
 using namespace std;
 
 
 void *KeyMonitorThread(void *data);
 static int HandleKeypress(ctrlm_ble_rcu_interface_t *metadata, struct input_event *event, const BleAddress &address);
+static int OpenKeyInputDeviceNode(const string &keyInputFilename, uint64_t *ieee_address);
 static int OpenKeyInputDevice(uint64_t ieee_address);
+static void AddRcuInputDevice(ctrlm_ble_rcu_interface_t *metadata, int epoll_fd, const BleAddress &address, ctrlm_ble_key_input_t &input, int input_device_fd);
+static void CloseRcuInputDevice(ctrlm_ble_key_input_t &input);
 static void FindRcuInputDevices(ctrlm_ble_rcu_interface_t *metadata, 
-                                std::map <BleAddress, int> &rcuKeypressFds, 
-                                fd_set &rfds, 
-                                int &nfds);
+                                std::map <BleAddress, ctrlm_ble_key_input_t> &rcuKeypressFds, 
+                                int epoll_fd);
+static void HandleInputDirChanges(ctrlm_ble_rcu_interface_t *metadata, 
+                                  std::map <BleAddress, ctrlm_ble_key_input_t> &rcuKeypressFds, 
+                                  int inotify_fd,
+                                  int epoll_fd);
+static bool HasPendingRcuInputDevices(const std::map <BleAddress, ctrlm_ble_key_input_t> &rcuKeypressFds);
 
 
 
@@ -1463,6 +1482,16 @@ static int HandleKeypress(ctrlm_ble_rcu_interface_t *metadata, struct input_even
         ctrlm_hal_ble_IndKeypress_params_t params;
         params.ieee_address = address.toUInt64();
         params.event = *event;
+        params.input_us = 0;
+        ctrlm_timestamp_get_monotonic(&params.received);
+
+        // The event is stamped by the kernel on the realtime clock
+        struct timeval now;
+        gettimeofday(&now, NULL);
+        signed long long input_us = (signed long long)(now.tv_sec - event->time.tv_sec) * 1000000 + (now.tv_usec - event->time.tv_usec);
+        if (input_us > 0) {
+            params.input_us = input_us;
+        }
 
         metadata->m_rcuKeypressSlots.invoke(&params);
     }
@@ -1470,146 +1499,243 @@ static int HandleKeypress(ctrlm_ble_rcu_interface_t *metadata, struct input_even
 }
 
 
+static int OpenKeyInputDeviceNode(const string &keyInputFilename, uint64_t *ieee_address)
+{
+    int input_fd = open(keyInputFilename.c_str(), O_RDONLY|O_NONBLOCK|O_CLOEXEC);
+    if (input_fd < 0) {
+        return -1;
+    }
+    struct libevdev *evdev = NULL;
+    int rc = libevdev_new_from_fd(input_fd, &evdev);
+    if (rc < 0) {
+        XLOGD_ERROR("Failed to init libevdev (%s)", strerror(-rc));   //on failure, rc is negative errno
+    } else if (evdev != NULL) {
+        XLOGD_DEBUG("Input device <%s> name: <%s> ID: bus %#x vendor %#x product %#x, phys = <%s>, unique = <%s>",
+                keyInputFilename.c_str(),
+                libevdev_get_name(evdev),libevdev_get_id_bustype(evdev),libevdev_get_id_vendor(evdev),
+                libevdev_get_id_product(evdev),libevdev_get_phys(evdev),libevdev_get_uniq(evdev));
+
+        *ieee_address = ctrlm_convert_mac_string_to_long(libevdev_get_uniq(evdev));
+        libevdev_free(evdev);
+        return input_fd;
+    }
+    close(input_fd);
+    return -1;
+}
+
 static int OpenKeyInputDevice(uint64_t ieee_address)
 {
-    int retry = 0;
-    do {
-        string keyInputBaseDir(KEY_INPUT_DEVICE_BASE_DIR);
-        DIR *dir_p = opendir(keyInputBaseDir.c_str());
-        if (NULL == dir_p) {
-            return -1;
-        }
-        dirent *file_p;
-        while ((file_p = readdir(dir_p)) != NULL) {
-            if(strstr(file_p->d_name, KEY_INPUT_DEVICE_BASE_FILE) != NULL) {
-                //this is one of the event devices, open it and see if it belongs to this MAC
-                string keyInputFilename = keyInputBaseDir + file_p->d_name;
-                int input_fd = open(keyInputFilename.c_str(), O_RDONLY|O_NONBLOCK);
-                if (input_fd >= 0) {
-                    struct libevdev *evdev = NULL;
-                    int rc = libevdev_new_from_fd(input_fd, &evdev);
-                    if (rc < 0) {
-                        XLOGD_ERROR("Failed to init libevdev (%s)", strerror(-rc));   //on failure, rc is negative errno
-                    } else if (evdev != NULL) {
-                        XLOGD_DEBUG("Input device <%s> name: <%s> ID: bus %#x vendor %#x product %#x, phys = <%s>, unique = <%s>",
-                                keyInputFilename.c_str(),
-                                libevdev_get_name(evdev),libevdev_get_id_bustype(evdev),libevdev_get_id_vendor(evdev),
-                                libevdev_get_id_product(evdev),libevdev_get_phys(evdev),libevdev_get_uniq(evdev));
-
-                        uint64_t evdev_macaddr = ctrlm_convert_mac_string_to_long(libevdev_get_uniq(evdev));
-                        if (evdev_macaddr == ieee_address) {
-                            XLOGD_INFO("Input Dev Node (%s) for device: <%s> (0x%llX) FOUND, returning file descriptor: <%d>", 
-                                    keyInputFilename.c_str(), libevdev_get_name(evdev), ieee_address, input_fd);
-
-                            libevdev_free(evdev);
-                            evdev = NULL;
-                            closedir(dir_p);
-                            return input_fd;
-                        }
-                    }
-                    close(input_fd);
-                    if (NULL != evdev) {
-                        libevdev_free(evdev);
-                        evdev = NULL;
-                    }
+    string keyInputBaseDir(KEY_INPUT_DEVICE_BASE_DIR);
+    DIR *dir_p = opendir(keyInputBaseDir.c_str());
+    if (NULL == dir_p) {
+        return -1;
+    }
+    dirent *file_p;
+    while ((file_p = readdir(dir_p)) != NULL) {
+        if(strstr(file_p->d_name, KEY_INPUT_DEVICE_BASE_FILE) != NULL) {
+            //this is one of the event devices, open it and see if it belongs to this MAC
+            string keyInputFilename = keyInputBaseDir + file_p->d_name;
+            uint64_t evdev_macaddr = 0;
+            int input_fd = OpenKeyInputDeviceNode(keyInputFilename, &evdev_macaddr);
+            if (input_fd >= 0) {
+                if (evdev_macaddr == ieee_address) {
+                    XLOGD_INFO("Input Dev Node (%s) for device: (0x%llX) FOUND, returning file descriptor: <%d>", 
+                            keyInputFilename.c_str(), ieee_address, input_fd);
+                    closedir(dir_p);
+                    return input_fd;
                 }
+                close(input_fd);
             }
         }
-        closedir(dir_p);
-        retry++;
-    } while (retry < 1);
+    }
+    closedir(dir_p);
 
     return -1;
 }
 
+static void AddRcuInputDevice(ctrlm_ble_rcu_interface_t *metadata, int epoll_fd, const BleAddress &address, ctrlm_ble_key_input_t &input, int input_device_fd)
+{
+    struct epoll_event ev;
+    ev.events  = EPOLLIN;
+    ev.data.fd = input_device_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, input_device_fd, &ev) < 0) {
+        int errsv = errno;
+        XLOGD_ERROR("epoll_ctl() failed: error = <%d>, <%s>", errsv, strerror(errsv));
+        close(input_device_fd);
+        return;
+    }
+    input.fd       = input_device_fd;
+    input.key_seen = false;
+    ctrlm_timestamp_get_monotonic(&input.opened);
+
+    // Get the device minor ID, which gets reported up to the app as deviceid
+    struct stat sb;
+    if (-1 == fstat(input.fd, &sb)) {
+        int errsv = errno;
+        XLOGD_ERROR("fstat() failed: error = <%d>, <%s>", errsv, strerror(errsv));
+    } else {
+        int deviceMinorId = minor(sb.st_rdev);
+
+        XLOGD_DEBUG("%s device minor ID = <%d>, reporting status change up to the network", 
+                address.toString().c_str(), deviceMinorId);
+
+        // send deviceid up to the network
+        ctrlm_hal_ble_RcuStatusData_t params;
+        params.property_updated = CTRLM_HAL_BLE_PROPERTY_DEVICE_ID;
+        params.rcu_data.ieee_address = address.toUInt64();
+        params.rcu_data.device_minor_id = deviceMinorId;
+        metadata->m_rcuStatusChangedSlots.invoke(&params);
+    }
+}
+
+static void CloseRcuInputDevice(ctrlm_ble_key_input_t &input)
+{
+    if (input.fd >= 0) {
+        close(input.fd); // Closing the fd also removes it from the epoll set
+        input.fd = -1;
+    }
+}
+
 static void FindRcuInputDevices(ctrlm_ble_rcu_interface_t *metadata, 
-                                std::map <BleAddress, int> &rcuKeypressFds, 
-                                fd_set &rfds, 
-                                int &nfds)
+                                std::map <BleAddress, ctrlm_ble_key_input_t> &rcuKeypressFds, 
+                                int epoll_fd)
 {   
-    // Since the metadata map can be updated outside this thread, we need to lock with a mutex and then make a copy.
-    // But only after getting the fd and device minor ID which need to be written to the metadata.
-    // Otherwise, removing/adding an entry to the map while iterating will invalidate the iterator
     for (auto &rcu : rcuKeypressFds) {
-        if (rcu.second < 0) {
-            // We have an rcu in the metadata without an input device opened.
-            int input_device_fd = -1;
-            // Loop through the linux input device nodes to find the one corresponding to this ieee_address
-            input_device_fd = OpenKeyInputDevice(rcu.first.toUInt64());
+        if (rcu.second.fd < 0) {
+            // We have an rcu without an input device opened, loop through the linux input device nodes to find the one corresponding to this ieee_address
+            int input_device_fd = OpenKeyInputDevice(rcu.first.toUInt64());
+            if (input_device_fd >= 0) {
+                AddRcuInputDevice(metadata, epoll_fd, rcu.first, rcu.second, input_device_fd);
+            }
+        }
+    }
+}
 
+static void HandleInputDirChanges(ctrlm_ble_rcu_interface_t *metadata, 
+                                  std::map <BleAddress, ctrlm_ble_key_input_t> &rcuKeypressFds, 
+                                  int inotify_fd,
+                                  int epoll_fd)
+{
+    char buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    ssize_t len;
+    while ((len = read(inotify_fd, buf, sizeof(buf))) > 0) {
+        for (char *ptr = buf; ptr < buf + len; ptr += sizeof(struct inotify_event) + ((struct inotify_event *)ptr)->len) {
+            const struct inotify_event *event = (const struct inotify_event *)ptr;
+            if (event->len == 0 || strncmp(event->name, KEY_INPUT_DEVICE_BASE_FILE, strlen(KEY_INPUT_DEVICE_BASE_FILE)) != 0) {
+                continue;
+            }
+            // Only the new node is opened. The attribute change catches nodes that were not readable yet when they were created.
+            uint64_t evdev_macaddr = 0;
+            string keyInputFilename = string(KEY_INPUT_DEVICE_BASE_DIR) + event->name;
+            int input_device_fd = OpenKeyInputDeviceNode(keyInputFilename, &evdev_macaddr);
             if (input_device_fd < 0) {
-                // XLOGD_DEBUG("Did not find input device for RCU 0x%llX", rcu.first);
+                continue;
+            }
+            auto rcu = rcuKeypressFds.find(BleAddress(evdev_macaddr));
+            if (rcu != rcuKeypressFds.end() && rcu->second.fd < 0) {
+                XLOGD_INFO("Input Dev Node (%s) for device: <%s> created, file descriptor: <%d>", 
+                        keyInputFilename.c_str(), rcu->first.toString().c_str(), input_device_fd);
+                AddRcuInputDevice(metadata, epoll_fd, rcu->first, rcu->second, input_device_fd);
             } else {
-                // add this fd to select
-                FD_SET(input_device_fd,  &rfds);
-                nfds = MAX(nfds, input_device_fd);
-                rcu.second = input_device_fd;
-
-                // Get the device minor ID, which gets reported up to the app as deviceid
-                struct stat sb;
-                if (-1 == fstat(rcu.second, &sb)) {
-                    int errsv = errno;
-                    XLOGD_ERROR("fstat() failed: error = <%d>, <%s>", errsv, strerror(errsv));
-                } else {
-                    int deviceMinorId = minor(sb.st_rdev);
-
-                    XLOGD_DEBUG("%s device minor ID = <%d>, reporting status change up to the network", 
-                            rcu.first.toString().c_str(), deviceMinorId);
-
-                    // send deviceid up to the network
-                    ctrlm_hal_ble_RcuStatusData_t params;
-                    params.property_updated = CTRLM_HAL_BLE_PROPERTY_DEVICE_ID;
-                    params.rcu_data.ieee_address = rcu.first.toUInt64();
-                    params.rcu_data.device_minor_id = deviceMinorId;
-                    metadata->m_rcuStatusChangedSlots.invoke(&params);
-                }
+                close(input_device_fd);
             }
-        } else {
-            FD_SET(rcu.second,  &rfds);
-            nfds = MAX(nfds, rcu.second);
         }
     }
 }
 
+static bool HasPendingRcuInputDevices(const std::map <BleAddress, ctrlm_ble_key_input_t> &rcuKeypressFds)
+{
+    for (auto const &rcu : rcuKeypressFds) {
+        if (rcu.second.fd < 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 
 void *KeyMonitorThread(void *data)
 {
     ctrlm_ble_rcu_interface_t *metadata = (ctrlm_ble_rcu_interface_t *)data;
-    // std::map<BleAddress, RcuMetadata> rcu_metadata;
 
-    std::map <BleAddress, int> rcuKeypressFds;
+    std::map <BleAddress, ctrlm_ble_key_input_t> rcuKeypressFds;
 
-    struct input_event event;
-    fd_set rfds;
-    int nfds = -1;
-    errno_t safec_rc = -1;
+    struct input_event events[KEY_MONITOR_INPUT_EVENTS_MAX];
+    struct epoll_event epoll_events[KEY_MONITOR_EPOLL_EVENTS_MAX];
     bool running = true;
     char msg[CTRLM_BLE_KEY_MSG_QUEUE_MSG_SIZE_MAX];
 
+    // Key counters, logged hourly from the thread monitor tickle
+    unsigned long     stats_key_wakeups = 0;
+    unsigned long     stats_keys        = 0;
+    unsigned long     stats_keys_max    = 0;
+    ctrlm_timestamp_t stats_logged;
+    ctrlm_timestamp_get_monotonic(&stats_logged);
+
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        int errsv = errno;
+        XLOGD_ERROR("epoll_create1() failed: error = <%d>, <%s>", errsv, strerror(errsv));
+        sem_post(&metadata->m_keyThreadSem);
+        return NULL;
+    }
+    struct epoll_event ev;
+    ev.events  = EPOLLIN;
+    ev.data.fd = metadata->m_keyThreadMsgQ;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, metadata->m_keyThreadMsgQ, &ev) < 0) {
+        int errsv = errno;
+        XLOGD_ERROR("epoll_ctl() failed: error = <%d>, <%s>", errsv, strerror(errsv));
+    }
+
+    // Watch for new input device nodes so that only the new node is opened instead of rescanning the directory
+    int inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0 || inotify_add_watch(inotify_fd, KEY_INPUT_DEVICE_BASE_DIR, IN_CREATE | IN_ATTRIB) < 0) {
+        int errsv = errno;
+        XLOGD_WARN("inotify failed, falling back to rescanning input devices: error = <%d>, <%s>", errsv, strerror(errsv));
+        if (inotify_fd >= 0) {
+            close(inotify_fd);
+            inotify_fd = -1;
+        }
+    } else {
+        ev.events  = EPOLLIN;
+        ev.data.fd = inotify_fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, inotify_fd, &ev) < 0) {
+            int errsv = errno;
+            XLOGD_ERROR("epoll_ctl() failed: error = <%d>, <%s>", errsv, strerror(errsv));
+        }
+    }
+
     // Unblock the caller that launched this thread
     sem_post(&metadata->m_keyThreadSem);
 
     XLOGD_INFO("Enter main loop for new key monitor thread");
     do {
-        // Needs to be reinitialized before each call to select() because select() will modify these variables
-        FD_ZERO(&rfds);
-        FD_SET(metadata->m_keyThreadMsgQ, &rfds);
-        nfds = metadata->m_keyThreadMsgQ;
-        FindRcuInputDevices(metadata, rcuKeypressFds, rfds, nfds);
-        nfds++;
-
-        int ret = select(nfds, &rfds, NULL, NULL, NULL);
-        if (ret < 0) {
+        // Rescan periodically while an RCU has no input device in case a node was missed (or inotify is not available)
+        int timeout = HasPendingRcuInputDevices(rcuKeypressFds) ? (inotify_fd < 0 ? KEY_MONITOR_RESCAN_PERIOD_NO_INOTIFY_MS : KEY_MONITOR_RESCAN_PERIOD_MS) : -1;
+
+        int qty = epoll_wait(epoll_fd, epoll_events, KEY_MONITOR_EPOLL_EVENTS_MAX, timeout);
+        if (qty < 0) {
             int errsv = errno;
-            XLOGD_DEBUG("select() failed: error = <%d>, <%s>", errsv, strerror(errsv));
+            if (errsv != EINTR) {
+                XLOGD_DEBUG("epoll_wait() failed: error = <%d>, <%s>", errsv, strerror(errsv));
+            }
+            continue;
+        }
+        if (qty == 0) {
+            FindRcuInputDevices(metadata, rcuKeypressFds, epoll_fd);
             continue;
         }
 
-        if(FD_ISSET(metadata->m_keyThreadMsgQ, &rfds)) {
-            ssize_t bytes_read = xr_mq_pop(metadata->m_keyThreadMsgQ, msg, sizeof(msg));
-            if(bytes_read <= 0) {
-                XLOGD_ERROR("mq_receive failed, rc <%d>", bytes_read);
-            } else {
+        unsigned long keys = 0;
+        for (int index = 0; index < qty; index++) {
+            int fd = epoll_events[index].data.fd;
+
+            if (fd == metadata->m_keyThreadMsgQ) {
+                ssize_t bytes_read = xr_mq_pop(metadata->m_keyThreadMsgQ, msg, sizeof(msg));
+                if(bytes_read <= 0) {
+                    XLOGD_ERROR("mq_receive failed, rc <%d>", bytes_read);
+                    continue;
+                }
                 ctrlm_ble_key_queue_msg_header_t *hdr = (ctrlm_ble_key_queue_msg_header_t *) msg;
                 switch(hdr->type) {
                     case CTRLM_BLE_KEY_QUEUE_MSG_TYPE_DEVICE_ADDED: {
@@ -1618,15 +1744,16 @@ void *KeyMonitorThread(void *data)
 
                         if (rcuKeypressFds.end() == rcuKeypressFds.find(device_changed_msg->address)) {
                             // device not found in our map, create an entry and init the fd to -1
-                            rcuKeypressFds[device_changed_msg->address] = -1;
+                            rcuKeypressFds[device_changed_msg->address].fd = -1;
                         } else {
-                            if (rcuKeypressFds[device_changed_msg->address] >= 0) {
+                            if (rcuKeypressFds[device_changed_msg->address].fd >= 0) {
                                 XLOGD_TELEMETRY("RCU <%s> RE-CONNECTED, closing key input device so key monitor thread can reopen...", 
                                         device_changed_msg->address.toString().c_str());
-                                close(rcuKeypressFds[device_changed_msg->address]);
-                                rcuKeypressFds[device_changed_msg->address] = -1;
+                                CloseRcuInputDevice(rcuKeypressFds[device_changed_msg->address]);
                             }
                         }
+                        // The node may already exist, otherwise inotify reports it when it is created
+                        FindRcuInputDevices(metadata, rcuKeypressFds, epoll_fd);
                         break;
                     }
                     case CTRLM_BLE_KEY_QUEUE_MSG_TYPE_DEVICE_REMOVED: {
@@ -1634,9 +1761,7 @@ void *KeyMonitorThread(void *data)
                         XLOGD_INFO("message type CTRLM_BLE_KEY_QUEUE_MSG_TYPE_DEVICE_REMOVED");
 
                         if (rcuKeypressFds.end() != rcuKeypressFds.find(device_changed_msg->address)) {
-                            if (rcuKeypressFds[device_changed_msg->address] >= 0) {
-                                close(rcuKeypressFds[device_changed_msg->address]);
-                            }
+                            CloseRcuInputDevice(rcuKeypressFds[device_changed_msg->address]);
                             rcuKeypressFds.erase(device_changed_msg->address);
                         }
                         break;
@@ -1645,19 +1770,31 @@ void *KeyMonitorThread(void *data)
                         XLOGD_INFO("message type CTRLM_BLE_KEY_QUEUE_MSG_TYPE_DEEPSLEEP_WAKEUP");
 
                         for (auto &rcu : rcuKeypressFds) {
-                            if (rcu.second >= 0) {
+                            if (rcu.second.fd >= 0) {
                                 XLOGD_INFO("Closing key input device for RCU <%s> so key monitor thread can reopen...", 
                                         rcu.first.toString().c_str());
-                                close(rcu.second);
-                                rcu.second = -1;
+                                CloseRcuInputDevice(rcu.second);
                             }
                         }
+                        FindRcuInputDevices(metadata, rcuKeypressFds, epoll_fd);
                         break;
                     }
                     case CTRLM_BLE_KEY_QUEUE_MSG_TYPE_TICKLE: {
                         XLOGD_DEBUG("message type CTRLM_BLE_KEY_QUEUE_MSG_TYPE_TICKLE");
                         ctrlm_ble_key_thread_monitor_msg_t *thread_monitor_msg = (ctrlm_ble_key_thread_monitor_msg_t *) msg;
                         *thread_monitor_msg->response = CTRLM_HAL_THREAD_MONITOR_RESPONSE_ALIVE;
+
+                        ctrlm_timestamp_t now;
+                        ctrlm_timestamp_get_monotonic(&now);
+                        if (ctrlm_timestamp_subtract_ms(stats_logged, now) >= KEY_MONITOR_STATS_PERIOD_MS) {
+                            if (stats_key_wakeups > 0) {
+                                XLOGD_INFO("key wakeups <%lu> keys <%lu> keys per wakeup avg <%.2f> max <%lu>", stats_key_wakeups, stats_keys, (double)stats_keys / stats_key_wakeups, stats_keys_max);
+                            }
+                            stats_key_wakeups = 0;
+                            stats_keys        = 0;
+                            stats_keys_max    = 0;
+                            stats_logged      = now;
+                        }
                         break;
                     }
                     case CTRLM_BLE_KEY_QUEUE_MSG_TYPE_TERMINATE: {
@@ -1665,10 +1802,7 @@ void *KeyMonitorThread(void *data)
                         running = false;
 
                         for (auto &rcu : rcuKeypressFds) {
-                            if (rcu.second >= 0) {
-                                close(rcu.second);
-                                rcu.second = -1;
-                            }
+                            CloseRcuInputDevice(rcu.second);
                         }
                         break;
                     }
@@ -1677,27 +1811,56 @@ void *KeyMonitorThread(void *data)
                         break;
                     }
                 }
-            }
-        }
-
-        // loop the rcu fds to see if any has data to read
-        for (auto const &rcu : rcuKeypressFds) {
-            if (rcu.second >= 0) {
-                if (FD_ISSET(rcu.second, &rfds)) {
-                    safec_rc = memset_s ((void*) &event, sizeof(event), 0, sizeof(event));
-                    ERR_CHK(safec_rc);
-                    ret = read(rcu.second, (void*)&event, sizeof(event));
-                    if (ret < 0) {
-                        // int errsv = errno;
-                        // XLOGD_ERROR("Error reading event: error = <%d>, <%s>", errsv, strerror(errsv));
-                    } else {
-                        HandleKeypress(metadata, &event, rcu.first);
+            } else if (fd == inotify_fd) {
+                HandleInputDirChanges(metadata, rcuKeypressFds, inotify_fd, epoll_fd);
+            } else {
+                auto rcu = rcuKeypressFds.begin();
+                while (rcu != rcuKeypressFds.end() && rcu->second.fd != fd) {
+                    ++rcu;
+                }
+                if (rcu == rcuKeypressFds.end()) { // Closed earlier in this batch
+                    continue;
+                }
+                // Drain everything the device has queued with as few syscalls as possible
+                ssize_t ret;
+                while ((ret = read(fd, (void*)events, sizeof(events))) > 0) {
+                    size_t count = ret / sizeof(struct input_event);
+                    for (size_t i = 0; i < count; i++) {
+                        if (events[i].type == EV_KEY) {
+                            keys++;
+                            if (!rcu->second.key_seen) {
+                                rcu->second.key_seen = true;
+                                ctrlm_timestamp_t now;
+                                ctrlm_timestamp_get_monotonic(&now);
+                                XLOGD_INFO("RCU <%s> first key <%lld> ms after input device opened", rcu->first.toString().c_str(), ctrlm_timestamp_subtract_ms(rcu->second.opened, now));
+                            }
+                        }
+                        HandleKeypress(metadata, &events[i], rcu->first);
+                    }
+                    if ((size_t)ret < sizeof(events)) {
+                        break;
                     }
                 }
+                if (ret < 0 && errno == ENODEV) {
+                    XLOGD_INFO("Key input device for RCU <%s> removed", rcu->first.toString().c_str());
+                    CloseRcuInputDevice(rcu->second);
+                }
+            }
+        }
+        if (keys > 0) {
+            stats_key_wakeups++;
+            stats_keys += keys;
+            if (keys > stats_keys_max) {
+                stats_keys_max = keys;
             }
         }
     } while (running);
 
+    if (inotify_fd >= 0) {
+        close(inotify_fd);
+    }
+    close(epoll_fd);
+
     if (running) {
         XLOGD_ERROR("key monitor thread broke out of loop without being told, an error occurred...");
     } else {
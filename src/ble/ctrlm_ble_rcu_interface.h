@@ -48,6 +48,9 @@
 #include <sys/file.h>
 #include <sys/types.h>
 #include <sys/select.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/time.h>
 #include <sys/stat.h>
 #include <dirent.h>
 
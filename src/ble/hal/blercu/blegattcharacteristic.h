@@ -33,6 +33,7 @@
 
 #include "utils/bleuuid.h"
 #include "utils/slot.h"
+#include "utils/filedescriptor.h"
 #include "dbus/dbusabstractinterface.h"
 
 #include <memory>
@@ -82,11 +83,13 @@ public:
     virtual void readValue(PendingReply<std::vector<uint8_t>> &&reply) = 0;
     virtual void writeValue(const std::vector<uint8_t> &value, PendingReply<> &&reply) = 0;
     virtual void writeValueWithoutResponse(const std::vector<uint8_t> &value, PendingReply<> &&reply) = 0;
+    virtual void acquireWrite(PendingReply<FileDescriptor> &&reply) = 0;
     virtual bool notificationsEnabled() = 0;
     virtual void enableNotifications(const Slot<const std::vector<uint8_t> &> &notifyCB, PendingReply<> &&reply) = 0;
     virtual void enableDbusNotifications(const Slot<const std::vector<uint8_t> &> &notifyCB, PendingReply<> &&reply) = 0;
     virtual void enablePipeNotifications(const Slot<const std::vector<uint8_t> &> &notifyCB, PendingReply<> &&reply) = 0;
     virtual void disableNotifications() = 0;
+    virtual void addNotificationBatchEndSlot(const Slot<> &func) = 0;
 
     virtual std::vector<uint8_t> readValueSync(std::string &errorMessage) = 0;
 
@@ -37,6 +37,7 @@
 #include <stdio.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <time.h>
 #include "safec_lib.h"
 
 using namespace std;
@@ -56,6 +57,12 @@ using namespace std;
 
     When this object is destroyed both the input and output pipes are closed.
 
+    In batched mode the completed frames are held back until flush() is called
+    at the end of a batch of notifications (or the batch buffer is full), then
+    they are all written to the output pipe.  The output pipe is packetised in
+    either mode and each frame is written separately, so every read by the
+    client returns exactly one frame.
+
  */
 
 
@@ -67,23 +74,31 @@ using namespace std;
     into the pipe.
 
  */
-GattAudioPipe::GattAudioPipe(uint8_t frameSize, uint32_t frameCountMax, cbFrameValidator frameValidator, int outputPipeFd)
+GattAudioPipe::GattAudioPipe(uint8_t frameSize, uint32_t frameCountMax, cbFrameValidator frameValidator, int outputPipeFd, bool batched)
     : m_isAlive(make_shared<bool>(true))
     , m_outputPipeRdFd(-1)
     , m_outputPipeWrFd(-1)
     , m_frameSize(frameSize)
     , m_frameBufferOffset(0)
+    , m_batchFrameQty(0)
+    , m_batched(batched)
     , m_frameValidator(frameValidator)
     , m_running(false)
     , m_frameCount(0)
     , m_frameCountMax(frameCountMax)
+    , m_framesWritten(0)
+    , m_outputBatches(0)
+    , m_notificationCount(0)
+    , m_batchCpuStarted(false)
+    , m_cpuTimeUs(0)
     , m_recordingTimer(0)
     , m_recordingDuration(0)
 {
 
-    if(frameSize > sizeof(m_frameBuffer)) {
+    if(frameSize > m_frameSizeMax) {
         XLOGD_ERROR("frame size is too large <%u>", frameSize);
-        frameSize = sizeof(m_frameBuffer);
+        frameSize   = m_frameSizeMax;
+        m_frameSize = m_frameSizeMax;
     }
 
     if (outputPipeFd >= 0) {
@@ -199,6 +214,11 @@ bool GattAudioPipe::start()
 
     m_recordingTimer = g_timer_new();
     m_frameCount = 0;
+    m_framesWritten = 0;
+    m_outputBatches = 0;
+    m_notificationCount = 0;
+    m_frameLatency.reset();
+    m_cpuTimeUs = 0;
     m_recordingDuration = 0;
 
     m_running = true;
@@ -218,10 +238,39 @@ void GattAudioPipe::stop()
         return;
     }
 
+    // write out any frames still held in the batch
+    flush();
+
     m_running = false;
 
     gulong microseconds;
     m_recordingDuration = g_timer_elapsed(m_recordingTimer, &microseconds);
+
+    logStreamStats();
+}
+
+// -----------------------------------------------------------------------------
+/*!
+    \internal
+
+    Logs the throughput, latency and cost of the stream that just stopped.  The
+    latency is from the first notification of a frame arriving to the frame
+    being written to the output pipe.  The cpu time is that used by the notify
+    thread from the first notification of each batch to the end of the batch.
+
+ */
+void GattAudioPipe::logStreamStats() const
+{
+    if (m_recordingDuration <= 0 || m_notificationCount == 0) {
+        return;
+    }
+
+    XLOGD_INFO("audio stream stats: duration <%.3f> s, notifications <%u> (%.1f/s), frames <%u> (%.1f/s), batches <%u>",
+               m_recordingDuration, m_notificationCount, m_notificationCount / m_recordingDuration,
+               m_frameCount, m_frameCount / m_recordingDuration, m_outputBatches);
+    XLOGD_INFO("audio stream stats: frame latency us p50 <%llu> p95 <%llu> p99 <%llu> max <%llu>, cpu <%llu> us per second",
+               m_frameLatency.percentile(50), m_frameLatency.percentile(95), m_frameLatency.percentile(99), m_frameLatency.max(),
+               (unsigned long long)(m_cpuTimeUs / m_recordingDuration));
 }
 
 // -----------------------------------------------------------------------------
@@ -234,6 +283,22 @@ uint32_t GattAudioPipe::framesReceived() const
     return m_frameCount;
 }
 
+// -----------------------------------------------------------------------------
+/*!
+    Returns the number of frames written to the output pipe and the number of
+    batches they were written in.
+
+ */
+uint32_t GattAudioPipe::framesWritten() const
+{
+    return m_framesWritten;
+}
+
+uint32_t GattAudioPipe::outputBatches() const
+{
+    return m_outputBatches;
+}
+
 // -----------------------------------------------------------------------------
 /*!
     Returns the number of frames expected.
@@ -319,29 +384,61 @@ bool GattAudioPipe::addNotification(const uint8_t value[20], const uint8_t lengt
         return endOfStream;
     }
 
-    if(m_frameBufferOffset == 0 && m_frameCount == 0) { // First chunk of first frame
-        ctrlm_timestamp_get_monotonic(&m_firstAudioDataTime);
+    if(!m_batchCpuStarted) { // First notification of a batch
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &m_batchCpuStart);
+        m_batchCpuStarted = true;
+    }
+    m_notificationCount++;
+
+    if(m_frameBufferOffset == 0) { // First chunk of a frame
+        ctrlm_timestamp_get_monotonic(&m_frameStartTime[m_batchFrameQty]);
+        if(m_frameCount == 0) { // First chunk of first frame
+            m_firstAudioDataTime = m_frameStartTime[m_batchFrameQty];
+        }
     }
 
-    // add the notification to the buffer, if we have a complete frame
-    // then pass on to the decoder
-    errno_t safec_rc = memcpy_s(m_frameBuffer + m_frameBufferOffset, m_frameSize - m_frameBufferOffset, value, length);
+    // add the notification to the frame being assembled, which sits after any
+    // completed frames waiting in the batch.  If we have a complete frame then
+    // pass on to the decoder
+    uint8_t *frame = m_frameBuffer + (m_batchFrameQty * m_frameSize);
+    errno_t safec_rc = memcpy_s(frame + m_frameBufferOffset, m_frameSize - m_frameBufferOffset, value, length);
     ERR_CHK(safec_rc);
 
     m_frameBufferOffset += length;
 
 
     if (m_frameBufferOffset == m_frameSize) {
+        m_frameBufferOffset = 0;
         if (!m_running) {
             XLOGD_WARN("received GATT notification before pipe was running");
         } else {
             endOfStream = processAudioFrame();
         }
-        m_frameBufferOffset = 0;
     }
     return(endOfStream);
 }
 
+// -----------------------------------------------------------------------------
+/*!
+    Call at the end of a batch of notifications to write the frames held in the
+    batch to the output pipe.  Does nothing if there are no complete frames
+    waiting, which is always the case when the pipe isn't batched.
+
+ */
+void GattAudioPipe::flush()
+{
+    if (m_batchFrameQty > 0) {
+        writeAudioFrames();
+    }
+
+    if (m_batchCpuStarted) {
+        struct timespec now;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        m_cpuTimeUs += ((now.tv_sec - m_batchCpuStart.tv_sec) * 1000000LL) + ((now.tv_nsec - m_batchCpuStart.tv_nsec) / 1000);
+        m_batchCpuStarted = false;
+    }
+}
+
 // -----------------------------------------------------------------------------
 /*!
     Call to set the frame count maximum during the stream.
@@ -376,7 +473,7 @@ bool GattAudioPipe::processAudioFrame()
     if (!m_running) {
         return false;
     }
-    const uint8_t *frame = m_frameBuffer;
+    const uint8_t *frame = m_frameBuffer + (m_batchFrameQty * m_frameSize);
 
     if(m_frameValidator != NULL) {
         m_frameValidator(frame, m_frameCount);
@@ -384,38 +481,77 @@ bool GattAudioPipe::processAudioFrame()
 
     // increment the count of audio frames received
     m_frameCount++;
+    m_batchFrameQty++;
+
+    bool endOfStream = (m_frameCountMax > 0 && m_frameCount >= m_frameCountMax); // if frame count max is non-zero then the stream ends when the max is reached
+
+    // unless batching, write each frame as it completes
+    if (!m_batched || endOfStream || m_batchFrameQty == m_batchFrameQtyMax) {
+        writeAudioFrames();
+    }
+
+    if(endOfStream) {
+        XLOGD_INFO("frame count limited reached <%u>", m_frameCount);
+        return true;
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+/*!
+    \internal
+
+    Writes the completed frames in the batch into the output pipe, one write()
+    per frame so each frame is a packet of its own, then moves any partially
+    assembled frame to the start of the buffer.
 
-    const size_t bufferSize = m_frameSize;
+ */
+void GattAudioPipe::writeAudioFrames()
+{
+    const size_t bufferSize = m_batchFrameQty * m_frameSize;
 
     // write the pcm data into the output pipe
     if (m_outputPipeWrFd >= 0) {
-        ssize_t wr = TEMP_FAILURE_RETRY(::write(m_outputPipeWrFd, frame, bufferSize));
-        if (wr < 0) {
-            // check if the pipe is full
-            if ((errno == EWOULDBLOCK) || (errno == EAGAIN)) {
-                XLOGD_WARN("voice audio pipe is full, frame discarded");
-            } else {
-                // check if VSDK closed the pipe, this is not an error so don't log it as such
-                if (errno == EPIPE) {
-                    XLOGD_INFO("output voice audio pipe closed by client");
+        m_outputBatches++;
+
+        ctrlm_timestamp_t now;
+        ctrlm_timestamp_get_monotonic(&now);
+
+        for (size_t frame = 0; frame < m_batchFrameQty; frame++) {
+            ssize_t wr = TEMP_FAILURE_RETRY(::write(m_outputPipeWrFd, m_frameBuffer + (frame * m_frameSize), m_frameSize));
+            if (wr < 0) {
+                // check if the pipe is full
+                if ((errno == EWOULDBLOCK) || (errno == EAGAIN)) {
+                    XLOGD_WARN("voice audio pipe is full, %zu frame(s) discarded", m_batchFrameQty - frame);
                 } else {
-                    int errsv = errno;
-                    XLOGD_ERROR("output voice audio pipe write failed: error = <%d>, <%s>", errsv, strerror(errsv));
+                    // check if VSDK closed the pipe, this is not an error so don't log it as such
+                    if (errno == EPIPE) {
+                        XLOGD_INFO("output voice audio pipe closed by client");
+                    } else {
+                        int errsv = errno;
+                        XLOGD_ERROR("output voice audio pipe write failed: error = <%d>, <%s>", errsv, strerror(errsv));
+                    }
+
+                    // close down the pipe
+                    onOutputPipeException(m_outputPipeWrFd);
                 }
-
-                // close down the pipe
-                onOutputPipeException(m_outputPipeWrFd);
+                break;
+            } else if (static_cast<size_t>(wr) != m_frameSize) {
+                XLOGD_WARN("only %zd of the possible %u bytes of audio data could be sent", wr, m_frameSize);
+            } else {
+                m_framesWritten++;
+                m_frameLatency.add(ctrlm_timestamp_subtract_us(m_frameStartTime[frame], now));
             }
-        } else if (static_cast<size_t>(wr) != bufferSize) {
-            XLOGD_WARN("only %zd of the possible %zu bytes of audio data could be sent", wr, bufferSize);
         }
     }
 
-    if(m_frameCountMax > 0 && m_frameCount >= m_frameCountMax) { // if frame count max is non-zero then the stream ends when the max is reached 
-        XLOGD_INFO("frame count limited reached <%u>", m_frameCount);
-        return true;
+    // the partial frame is always shorter than the completed frames in front of it so the copy can't overlap
+    if (m_frameBufferOffset > 0) {
+        errno_t safec_rc = memcpy_s(m_frameBuffer, sizeof(m_frameBuffer), m_frameBuffer + bufferSize, m_frameBufferOffset);
+        ERR_CHK(safec_rc);
+        m_frameStartTime[0] = m_frameStartTime[m_batchFrameQty];
     }
-    return false;
+    m_batchFrameQty = 0;
 }
 
 // -----------------------------------------------------------------------------
@@ -33,6 +33,7 @@
 #include "utils/filedescriptor.h"
 #include "utils/slot.h"
 #include "ctrlm_hal.h"
+#include "ctrlm_histogram.h"
 
 #include <memory>
 #include <gio/gio.h>
@@ -45,7 +46,7 @@ class GattAudioPipe
 public:
     using cbFrameValidator = std::function<void(const uint8_t *frame, uint32_t frameCount)>;
 
-    explicit GattAudioPipe(uint8_t frameSize, uint32_t frameCountMax, cbFrameValidator frameValidator = NULL, int outputPipeFd = -1);
+    explicit GattAudioPipe(uint8_t frameSize, uint32_t frameCountMax, cbFrameValidator frameValidator = NULL, int outputPipeFd = -1, bool batched = false);
     ~GattAudioPipe();
 
 public:
@@ -57,11 +58,14 @@ public:
     void stop();
 
     uint32_t framesReceived() const;
+    uint32_t framesWritten() const;
+    uint32_t outputBatches() const;
     uint32_t framesExpected(uint32_t lostFrameCount, uint32_t usecPerFrame) const;
 
     int takeOutputReadFd();
 
     bool addNotification(const uint8_t value[20], const uint8_t length);
+    void flush();
 
     bool setFrameCountMax(uint32_t frameCountMax);
     bool getFirstAudioDataTime(struct timespec &time);
@@ -78,22 +82,39 @@ private:
     void onOutputPipeException(int pipeFd);
 
     bool processAudioFrame();
+    void writeAudioFrames();
+    void logStreamStats() const;
 
 private:
+    static const size_t m_frameSizeMax = 140;
+    static const size_t m_batchFrameQtyMax = 16;
+
     std::shared_ptr<bool> m_isAlive;
     
     int m_outputPipeRdFd;
     int m_outputPipeWrFd;
 
     uint8_t m_frameSize;
-    uint8_t m_frameBuffer[140];
+    uint8_t m_frameBuffer[m_frameSizeMax * m_batchFrameQtyMax];
     size_t m_frameBufferOffset;
+    size_t m_batchFrameQty;
+    bool m_batched;
     cbFrameValidator m_frameValidator;
 
     bool m_running;
 
     uint32_t m_frameCount;
     uint32_t m_frameCountMax;
+    uint32_t m_framesWritten;
+    uint32_t m_outputBatches;
+
+    // streaming performance, logged when the pipe is stopped
+    uint32_t m_notificationCount;
+    ctrlm_timestamp_t m_frameStartTime[m_batchFrameQtyMax];
+    ctrlm_histogram_t m_frameLatency;
+    bool m_batchCpuStarted;
+    struct timespec m_batchCpuStart;
+    unsigned long long m_cpuTimeUs;
     GTimer* m_recordingTimer;
     double m_recordingDuration;
     ctrlm_timestamp_t m_firstAudioDataTime;
@@ -344,8 +344,12 @@ void GattAudioService::onExitedStreamingState()
         m_lastStats.expectedPackets = std::max(m_lastStats.expectedPackets, m_lastStats.actualPackets);
         m_lastStats.voiceKeyHeldMs = m_audioDurationMs;
 
-        XLOGD_INFO("audio frame stats: actual=%u, expected=%u voiceKeyHeld=%d ms",
-              m_lastStats.actualPackets, m_lastStats.expectedPackets, m_lastStats.voiceKeyHeldMs);
+        const uint32_t framesWritten = m_audioPipe->framesWritten();
+        const uint32_t outputBatches = m_audioPipe->outputBatches();
+
+        XLOGD_INFO("audio frame stats: actual=%u, expected=%u voiceKeyHeld=%d ms, frames per batch=%.2f (%u/%u)",
+              m_lastStats.actualPackets, m_lastStats.expectedPackets, m_lastStats.voiceKeyHeldMs,
+              outputBatches ? ((double)framesWritten / outputBatches) : 0.0, framesWritten, outputBatches);
 
         // destroy the audio pipe (closes all file handles)
         m_audioPipe.reset();
@@ -420,6 +424,22 @@ void GattAudioService::onAudioDataNotification(const vector<uint8_t> &value)
     }
 }
 
+// -----------------------------------------------------------------------------
+/*!
+    \internal
+
+    Called after the last of a batch of notifications from the Audio Data
+    characteristic, writes the frames assembled from the batch to the pipe.
+
+ */
+void GattAudioService::onAudioDataNotificationBatchEnd()
+{
+    std::unique_lock<std::mutex> guard(mAudioPipeMutex);
+    if (m_audioPipe) {
+        m_audioPipe->flush();
+    }
+}
+
 // -----------------------------------------------------------------------------
 /*!
     \internal
@@ -563,7 +583,7 @@ void GattAudioService::startStreaming(Encoding encoding, PendingReply<int> &&rep
     }
 
     // create a new audio pipe for the client
-    m_audioPipe = make_shared<GattAudioPipe>(m_frameSize, frameCountMax, frameValidator);
+    m_audioPipe = make_shared<GattAudioPipe>(m_frameSize, frameCountMax, frameValidator, -1, true);
     if (!m_audioPipe || !m_audioPipe->isValid()) {
         m_audioPipe.reset();
         guard.unlock();
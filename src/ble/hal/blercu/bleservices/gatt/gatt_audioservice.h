@@ -62,6 +62,7 @@ public:
     virtual void onEnteredStartStreamingState();
     virtual void onEnteredStopStreamingState();
     virtual void onAudioDataNotification(const std::vector<uint8_t> &value);
+    virtual void onAudioDataNotificationBatchEnd();
     virtual void onAudioInfoReceived(uint16_t frameCount, uint32_t durationMs);
 
     virtual void validateFrame(const uint8_t *frame, uint32_t frameCount);
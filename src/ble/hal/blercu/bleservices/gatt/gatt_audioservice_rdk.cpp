@@ -419,6 +419,10 @@ bool GattAudioServiceRdk::getAudioDataCharacteristic(const shared_ptr<const BleG
         return false;
     }
 
+    // frames are written to the audio pipe once per batch of notifications
+    m_audioDataCharacteristic->addNotificationBatchEndSlot(
+            Slot<>(getIsAlivePtr(), std::bind(&GattAudioService::onAudioDataNotificationBatchEnd, this)));
+
     return true;
 }
 
@@ -74,7 +74,7 @@ GattServices::GattServices(const BleAddress &address,
     // Add the built-in services to the list of services available
     m_audioServices.push_back(make_shared<GattAudioServiceRdk>(mainLoop));
     m_infraredServices.push_back(make_shared<GattInfraredService>(settings, m_deviceInfoService, mainLoop));
-    m_upgradeServices.push_back(make_shared<GattUpgradeService>(mainLoop));
+    m_upgradeServices.push_back(make_shared<GattUpgradeService>(settings, mainLoop));
 
     #ifdef CTRLM_BLE_SERVICES
     ctrlm_ble_gatt_services_install(mainLoop, settings, m_deviceInfoService, m_audioServices, m_infraredServices, m_upgradeServices);
@@ -35,9 +35,11 @@
 
 #include "ctrlm_log_ble.h"
 
+#include <algorithm>
 #include <errno.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include "ctrlm_utils.h"
 
@@ -52,6 +54,9 @@
 /// The maximum number of data bytes in a DATA packet
 #define FIRMWARE_PACKET_MTU           18
 
+/// The number of DATA packets sent per window if not set by the RCU or config
+#define FIRMWARE_WINDOW_SIZE_DEFAULT  5
+
 using namespace std;
 
 typedef gmain_loop_obj_user_data<GattUpgradeService> GattUpgradeService_userdata;
@@ -64,16 +69,25 @@ struct ControlPoint {
 };
 
 static gboolean timerEvent(gpointer user_data);
+static gboolean packetWriteEvent(GIOChannel *source, GIOCondition condition, gpointer user_data);
+static void packetWriteEventDestroy(gpointer user_data);
+static uint64_t elapsedUs(const struct timespec &begin, const struct timespec &end);
 
-GattUpgradeService::GattUpgradeService(GMainLoop* mainLoop)
+GattUpgradeService::GattUpgradeService(const ConfigModelSettings &settings,
+                                       GMainLoop* mainLoop)
     : m_isAlive(make_shared<bool>(true))
     , m_ready(false)
+    , m_packetWriteWatch(0)
     , m_setupFlags(0)
     , m_progress(-1)
-    , m_windowSize(5)
+    , m_windowSize(FIRMWARE_WINDOW_SIZE_DEFAULT)
+    , m_defaultWindowSize((settings.upgradeWindowSize() > 0) ? settings.upgradeWindowSize() : FIRMWARE_WINDOW_SIZE_DEFAULT)
     , m_timeoutTimer(0)
     , m_lastAckBlockId(-1)
+    , m_deferredBlockId(0)
+    , m_deferredPackets(0)
     , m_timeoutCounter(0)
+    , m_stats{}
 {
     // initialise the state machine for the upgrades
     m_stateMachine.setGMainLoop(mainLoop);
@@ -84,6 +98,9 @@ GattUpgradeService::~GattUpgradeService()
 {
     *m_isAlive = false;
 
+    // the watch must not outlive the socket
+    removePacketWriteWatch();
+
     // clean up the firmware file
     m_fwFile.reset();
 }
@@ -360,6 +377,11 @@ void GattUpgradeService::onEnteredInitialState()
     // clear the setup flags
     m_setupFlags = 0;
 
+    // reset the transfer stats
+    m_stats = TransferStats{};
+    m_stats.highestBlockSent = -1;
+    clock_gettime(CLOCK_MONOTONIC, &m_stats.startTime);
+
     // all the following operations are async, they will set a flag in m_setupFlags
     // once complete or in case of an error they will post error events to the
     // state machine object
@@ -371,12 +393,15 @@ void GattUpgradeService::onEnteredInitialState()
     // read the control point, used to verify the f/w image is indeed for the target RCU device
     readControlPoint();
 
+    // get a socket for writing packets, if this fails the packets are written over dbus
+    acquirePacketWrite();
+
     // check if a window size descriptor exists, if so try and read it's value
     if (!m_windowSizeDescriptor) {
 
         // no characteristic so just use the default value and pretend we
         // actually read the value and go with the default
-        m_windowSize = 5;
+        m_windowSize = m_defaultWindowSize;
         m_setupFlags |= ReadWindowSize;
 
     } else {
@@ -561,6 +586,42 @@ void GattUpgradeService::readWindowSize()
     m_windowSizeDescriptor->readValue(PendingReply<std::vector<uint8_t>>(m_isAlive, replyHandler));
 }
 
+// -----------------------------------------------------------------------------
+/*!
+    \internal
+
+    Requests a socket from bluez for writing to the packet characteristic. Each
+    write to the socket goes out as a single WRITE_CMD without a dbus method
+    call per packet.  This is optional, on failure the packets are written
+    with writeValueWithoutResponse and the AcquiredWrite flag is still set.
+
+ */
+void GattUpgradeService::acquirePacketWrite()
+{
+    removePacketWriteWatch();
+    m_packetWriteFd.reset();
+
+    if (!m_packetCharacteristic) {
+        setSetupFlag(AcquiredWrite);
+        return;
+    }
+
+    // lambda invoked when the request returns
+    auto replyHandler = [this](PendingReply<FileDescriptor> *reply)
+        {
+            if (reply->isError()) {
+                XLOGD_WARN("failed to acquire OTA packet write socket due to <%s>, using dbus writes",
+                        reply->errorMessage().c_str());
+            } else {
+                m_packetWriteFd = reply->result();
+            }
+
+            setSetupFlag(AcquiredWrite);
+        };
+
+    m_packetCharacteristic->acquireWrite(PendingReply<FileDescriptor>(m_isAlive, replyHandler));
+}
+
 // -----------------------------------------------------------------------------
 /*!
     \internal
@@ -579,7 +640,8 @@ void GattUpgradeService::setSetupFlag(SetupFlag flag)
 
     if ( (m_setupFlags & EnabledNotifications) &&
          (m_setupFlags & ReadWindowSize) &&
-         (m_setupFlags & VerifiedDeviceModel)) {
+         (m_setupFlags & VerifiedDeviceModel) &&
+         (m_setupFlags & AcquiredWrite)) {
 
         m_stateMachine.postEvent(FinishedSetupEvent);
     }
@@ -623,6 +685,8 @@ void GattUpgradeService::onEnteredSendWriteRequestState()
  */
 void GattUpgradeService::onEnteredSendingDataState()
 {
+    clock_gettime(CLOCK_MONOTONIC, &m_stats.dataStartTime);
+
     if (!m_startPromise) {
         XLOGD_ERROR("start promise already completed?");
         return;
@@ -704,6 +768,13 @@ void GattUpgradeService::onEnteredFinishedState()
         m_timeoutTimer = 0;
     }
 
+    logTransferStats();
+
+    // close the packet write socket, bluez releases the characteristic when it's closed
+    removePacketWriteWatch();
+    m_deferredPackets = 0;
+    m_packetWriteFd.reset();
+
     // get the number of blocks in the f/w file
     const int fwBlockCount = static_cast<int>((m_fwFile->size() + (FIRMWARE_PACKET_MTU - 1)) / FIRMWARE_PACKET_MTU);
 
@@ -744,13 +815,35 @@ void GattUpgradeService::onEnteredFinishedState()
 /*!
     \internal
 
-    Requests a write of \a value to the packet characteristic.
+    Requests a write of \a length bytes from \a data to the packet
+    characteristic, using the acquired write socket if there is one.
+
+    Returns \c false if the socket is full and the packet wasn't sent; the
+    caller should stop sending the window and resume it once the socket is
+    writable, see addPacketWriteWatch().
 
  */
-void GattUpgradeService::doPacketWrite(const vector<uint8_t> &value)
+bool GattUpgradeService::doPacketWrite(const uint8_t *data, size_t length)
 {
     if (!m_packetCharacteristic) {
-        return;
+        return true;
+    }
+
+    if (m_packetWriteFd.isValid()) {
+        ssize_t wr = TEMP_FAILURE_RETRY(send(m_packetWriteFd.fd(), data, length, MSG_DONTWAIT | MSG_NOSIGNAL));
+        if (wr == static_cast<ssize_t>(length)) {
+            return true;
+        }
+        if ((wr < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+            return false;
+        }
+
+        // bluez closed the socket (or a short write), drop back to dbus writes
+        int errsv = errno;
+        XLOGD_WARN("failed to write to OTA packet socket, error <%s>, using dbus writes",
+                (wr < 0) ? strerror(errsv) : "short write");
+        removePacketWriteWatch();
+        m_packetWriteFd.reset();
     }
 
     // lambda called if an error occurs writing to the packet characteristic,
@@ -765,7 +858,85 @@ void GattUpgradeService::doPacketWrite(const vector<uint8_t> &value)
 
 
     // send the write without response request
-    m_packetCharacteristic->writeValueWithoutResponse(value, PendingReply<>(m_isAlive, replyHandler));
+    m_packetCharacteristic->writeValueWithoutResponse(vector<uint8_t>(data, data + length),
+                                                      PendingReply<>(m_isAlive, replyHandler));
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+/*!
+    \internal
+
+    Adds a watch on the packet write socket so the rest of a window deferred
+    by a full socket is sent as soon as there is room, rather than when the
+    timeout fires.
+
+ */
+void GattUpgradeService::addPacketWriteWatch()
+{
+    if ((m_packetWriteWatch > 0) || !m_packetWriteFd.isValid()) {
+        return;
+    }
+
+    GIOChannel *channel = g_io_channel_unix_new(m_packetWriteFd.fd());
+    GattUpgradeService_userdata *packetWriteEvent_userdata = new GattUpgradeService_userdata(m_isAlive, this);
+    m_packetWriteWatch = g_io_add_watch_full(channel, G_PRIORITY_DEFAULT, GIOCondition(G_IO_OUT | G_IO_ERR | G_IO_HUP),
+                                             packetWriteEvent, packetWriteEvent_userdata, packetWriteEventDestroy);
+    g_io_channel_unref(channel);
+}
+
+void GattUpgradeService::removePacketWriteWatch()
+{
+    if (m_packetWriteWatch > 0) {
+        g_source_remove(m_packetWriteWatch);
+        m_packetWriteWatch = 0;
+    }
+}
+
+static gboolean packetWriteEvent(GIOChannel *source, GIOCondition condition, gpointer user_data)
+{
+    GattUpgradeService_userdata *us = (GattUpgradeService_userdata*)user_data;
+
+    if (us == nullptr) {
+        XLOGD_ERROR("user data pointer is null!");
+        return false;
+    } else if (!us->is_alive()) {
+        XLOGD_ERROR("GattUpgradeService is not alive");
+        return false;
+    }
+    return us->m_ptr->onPacketWriteReady();
+}
+
+static void packetWriteEventDestroy(gpointer user_data)
+{
+    delete (GattUpgradeService_userdata*)user_data;
+}
+
+// -----------------------------------------------------------------------------
+/*!
+    \internal
+
+    Called when the packet write socket has room (or has errored, in which case
+    the write fails and drops back to dbus writes).  Sends the packets of the
+    current window that were deferred.
+
+ */
+bool GattUpgradeService::onPacketWriteReady()
+{
+    // the watch is removed on return
+    m_packetWriteWatch = 0;
+
+    const int deferredPackets = m_deferredPackets;
+    m_deferredPackets = 0;
+
+    // an ACK since the packets were deferred sends a new window that covers them
+    if ((deferredPackets <= 0) || (m_deferredBlockId <= m_lastAckBlockId) ||
+        !m_stateMachine.isRunning() || !m_stateMachine.inState(SendingDataState)) {
+        return false;
+    }
+
+    sendDATAPackets(m_deferredBlockId, deferredPackets);
+    return false;
 }
 
 // -----------------------------------------------------------------------------
@@ -797,11 +968,8 @@ void GattUpgradeService::sendWRQ()
 	XLOGD_DEBUG("sending WRQ packet (length:0x%08x version:0x%08x crc32:0x%08x)",
 	       writePacket.length, writePacket.version, writePacket.crc32);
 
-    const char* buffer = reinterpret_cast<const char*>(&writePacket);
-    vector<uint8_t> value(buffer, buffer + sizeof(writePacket));
-
     // send the WRQ packet
-    doPacketWrite(value);
+    doPacketWrite(reinterpret_cast<const uint8_t*>(&writePacket), sizeof(writePacket));
 }
 
 // -----------------------------------------------------------------------------
@@ -810,19 +978,43 @@ void GattUpgradeService::sendWRQ()
 
     Sends the next window of firmware upgrade packets.
 
-    If any packets were queued but not written to the pipe then they are
-    discarded before new packets are pushed into the q
+    If any packets of the last window were deferred because the socket was
+    full then they are dropped, the new window starts at the same block.
 
  */
 void GattUpgradeService::sendDATA()
 {
-    int16_t blockId = static_cast<int16_t>(m_lastAckBlockId + 1);
+    m_deferredPackets = 0;
+
+    sendDATAPackets(static_cast<int16_t>(m_lastAckBlockId + 1), m_windowSize);
+}
+
+// -----------------------------------------------------------------------------
+/*!
+    \internal
+
+    Sends up to \a count DATA packets starting at \a blockId.
+
+ */
+void GattUpgradeService::sendDATAPackets(int16_t blockId, int count)
+{
+    if (m_fwFile == nullptr || !m_fwFile->isValid()) {
+        XLOGD_WARN("firmware file closed, was the upgrade cancelled?");
 
-    // (re)seek to the right block
-    if (m_fwFile == nullptr || !m_fwFile->seek((blockId - 1) * FIRMWARE_PACKET_MTU)) {
-        XLOGD_WARN("failed to seek to location of block %hu", blockId);
+        m_lastError = "unable to read firmware file, its been closed";
+        m_stateMachine.postEvent(WriteErrorEvent);
+        return;
+    }
+
+    // the image is held in memory, block 1 is the first block of data
+    const uint8_t *fwData = m_fwFile->data();
+    const int64_t fwDataSize = m_fwFile->dataSize();
+    int64_t offset = int64_t(blockId - 1) * FIRMWARE_PACKET_MTU;
 
-        m_lastError = "Failed seeking to correct place in firmware file";
+    if ((offset < 0) || (offset > fwDataSize)) {
+        XLOGD_WARN("block %hd is outside of the firmware image", blockId);
+
+        m_lastError = "Block outside of firmware image";
         m_stateMachine.postEvent(WriteErrorEvent);
         return;
     }
@@ -830,42 +1022,47 @@ void GattUpgradeService::sendDATA()
     // buffer for storing DATA packets
     struct {
         uint8_t header[2];
-        uint8_t body[18];
+        uint8_t body[FIRMWARE_PACKET_MTU];
     } __attribute__((packed)) packet;
 
     // fire off a bunch of DATA packets for the next window
-    for (int i = 0; i < m_windowSize; i++) {
-
-        // read up to 18 bytes of data
-        if (m_fwFile == nullptr) {
-            XLOGD_WARN("firmware file closed, was the upgrade cancelled?");
+    for (int i = 0; i < count; i++) {
 
-            m_lastError = "unable to read firmware file, its been closed";
-            m_stateMachine.postEvent(WriteErrorEvent);
-            return;
-        }
-
-        int64_t rd = m_fwFile->readFile(packet.body, FIRMWARE_PACKET_MTU);
-        if ((rd != FIRMWARE_PACKET_MTU) && !m_fwFile->atEnd()) {
-            XLOGD_WARN("read too few bytes but not at end of file?");
-        }
+        // up to 18 bytes of data, the last packet is short (or empty if the
+        // image is a multiple of 18 bytes) to mark the end of the image
+        const int64_t length = std::min<int64_t>(FIRMWARE_PACKET_MTU, fwDataSize - offset);
+        memcpy(packet.body, fwData + offset, length);
 
         // set the block id
         packet.header[0] = OPCODE_DATA | uint8_t((blockId >> 8) & 0x3f);
         packet.header[1] = uint8_t(blockId & 0xff);
 
-        // send / queue the data packet
-        const char* buffer = reinterpret_cast<const char*>(&packet);
-        vector<uint8_t> value(buffer, buffer + static_cast<int>(2 + rd));
+        // do the packet write, if the socket is full the rest of the window
+        // goes out when the socket is writable
+        if (!doPacketWrite(reinterpret_cast<const uint8_t*>(&packet), static_cast<size_t>(2 + length))) {
+            m_stats.packetsDeferred += (count - i);
+            m_deferredBlockId = blockId;
+            m_deferredPackets = count - i;
+            addPacketWriteWatch();
+            break;
+        }
 
-        // do the packet write
-        doPacketWrite(value);
+        m_stats.packetsSent++;
+        m_stats.bytesSent += length;
+        if (blockId <= m_stats.highestBlockSent) {
+            m_stats.packetsResent++;
+        } else {
+            m_stats.highestBlockSent = blockId;
+            m_stats.bytesSentUnique += length;
+        }
+        m_stats.maxPacketsInFlight = std::max(m_stats.maxPacketsInFlight, blockId - m_lastAckBlockId);
 
         // increment the block number
         blockId++;
+        offset += length;
 
         // break out if we've sent a packet smaller than 18 bytes
-        if (rd < FIRMWARE_PACKET_MTU) {
+        if (length < FIRMWARE_PACKET_MTU) {
             break;
         }
     }
@@ -1111,3 +1308,37 @@ void GattUpgradeService::onERRORPacket(const vector<uint8_t> &data)
 
     m_stateMachine.postEvent(PacketErrorEvent);
 }
+
+// -----------------------------------------------------------------------------
+/*!
+    \internal
+
+    Logs the time taken by the upgrade and the throughput of the data
+    transfer.
+
+ */
+void GattUpgradeService::logTransferStats() const
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    uint64_t totalUs = elapsedUs(m_stats.startTime, now);
+    uint64_t dataUs  = (m_stats.dataStartTime.tv_sec == 0) ? 0 : elapsedUs(m_stats.dataStartTime, now);
+    // goodput only counts each byte of the image once, resent packets are in the bytes sent
+    uint64_t bytesPerSec   = (dataUs == 0) ? 0 : (m_stats.bytesSent * 1000000) / dataUs;
+    uint64_t goodputPerSec = (dataUs == 0) ? 0 : (m_stats.bytesSentUnique * 1000000) / dataUs;
+
+    XLOGD_INFO("f/w upgrade %s, total <%llu> ms, data <%llu> ms, sent <%llu> bytes <%llu> bytes/sec, goodput <%llu> bytes <%llu> bytes/sec",
+            m_packetWriteFd.isValid() ? "socket writes" : "dbus writes",
+            (unsigned long long)(totalUs / 1000), (unsigned long long)(dataUs / 1000),
+            (unsigned long long)m_stats.bytesSent, (unsigned long long)bytesPerSec,
+            (unsigned long long)m_stats.bytesSentUnique, (unsigned long long)goodputPerSec);
+    XLOGD_INFO("f/w upgrade packets sent <%u> resent <%u> deferred <%u> window <%d> max in flight <%d>",
+            m_stats.packetsSent, m_stats.packetsResent, m_stats.packetsDeferred, m_windowSize, m_stats.maxPacketsInFlight);
+}
+
+static uint64_t elapsedUs(const struct timespec &begin, const struct timespec &end)
+{
+    int64_t us = (int64_t(end.tv_sec) - begin.tv_sec) * 1000000 + (end.tv_nsec - begin.tv_nsec) / 1000;
+    return (us < 0) ? 0 : us;
+}
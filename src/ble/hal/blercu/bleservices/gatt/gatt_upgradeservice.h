@@ -32,10 +32,14 @@
 
 #include "blercu/bleservices/blercuupgradeservice.h"
 #include "utils/bleuuid.h"
+#include "utils/filedescriptor.h"
+#include "configsettings/configsettings.h"
 
 #include "utils/statemachine.h"
 #include "utils/fwimagefile.h"
 
+#include <time.h>
+
 
 class BleGattService;
 class BleGattCharacteristic;
@@ -45,7 +49,8 @@ class BleGattDescriptor;
 class GattUpgradeService : public BleRcuUpgradeService
 {
 public:
-    GattUpgradeService(GMainLoop *mainLoop = NULL);
+    explicit GattUpgradeService(const ConfigModelSettings &settings,
+                                GMainLoop *mainLoop = NULL);
     ~GattUpgradeService() final;
 
 public:
@@ -97,6 +102,7 @@ private:
         EnabledNotifications = 0x01,
         ReadWindowSize = 0x02,
         VerifiedDeviceModel = 0x04,
+        AcquiredWrite = 0x08,
     };
 
 // private slots:
@@ -111,23 +117,30 @@ private:
 
 public:
     bool onTimeout();
+    bool onPacketWriteReady();
 
 private:
 
     void enablePacketNotifications();
     void readControlPoint();
     void readWindowSize();
+    void acquirePacketWrite();
 
     void setSetupFlag(SetupFlag flag);
 
-    void doPacketWrite(const std::vector<uint8_t> &value);
+    bool doPacketWrite(const uint8_t *data, size_t length);
+    void addPacketWriteWatch();
+    void removePacketWriteWatch();
 
     void sendWRQ();
     void sendDATA();
+    void sendDATAPackets(int16_t blockId, int count);
 
     void onACKPacket(const std::vector<uint8_t> &data);
     void onERRORPacket(const std::vector<uint8_t> &data);
 
+    void logTransferStats() const;
+
 private:
     std::shared_ptr<bool> m_isAlive;
     bool m_ready;
@@ -136,11 +149,15 @@ private:
     std::shared_ptr<BleGattCharacteristic> m_packetCharacteristic;
     std::shared_ptr<BleGattDescriptor> m_windowSizeDescriptor;
 
+    FileDescriptor m_packetWriteFd;
+    unsigned int m_packetWriteWatch;
+
     uint16_t m_setupFlags;
 
     int m_progress;
 
     int m_windowSize;
+    const int m_defaultWindowSize;
 
     std::shared_ptr<FwImageFile> m_fwFile;
 
@@ -153,10 +170,26 @@ private:
 private:
     int m_lastAckBlockId;
 
+    int16_t m_deferredBlockId;
+    int m_deferredPackets;
+
     int m_timeoutCounter;
 
     std::string m_lastError;
 
+private:
+    struct TransferStats {
+        struct timespec startTime;
+        struct timespec dataStartTime;
+        uint64_t bytesSent;
+        uint64_t bytesSentUnique;
+        uint32_t packetsSent;
+        uint32_t packetsResent;
+        uint32_t packetsDeferred;
+        int highestBlockSent;
+        int maxPacketsInFlight;
+    } m_stats;
+
 private:
     static const Event::Type CancelledEvent         = Event::Type(Event::User + 1);
     static const Event::Type TimeoutErrorEvent      = Event::Type(Event::User + 2);
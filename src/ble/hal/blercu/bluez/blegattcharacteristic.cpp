@@ -419,6 +419,88 @@ void BleGattCharacteristicBluez::writeValueWithoutResponse(const std::vector<uin
     proxy->WriteValueWithouResponse(value, std::move(reply));
 }
 
+// -----------------------------------------------------------------------------
+/*!
+    Requests a socket from bluez for writing to the characteristic.  Each
+    write to the socket is sent as a single writeWithoutResponse (aka
+    WRITE_CMD), so a stream of writes doesn't need a dbus round trip each.
+
+    The socket is returned in the reply, on failure the client should fall
+    back to writeValueWithoutResponse().
+
+ */
+void BleGattCharacteristicBluez::acquireWrite(PendingReply<FileDescriptor> &&reply)
+{
+    // sanity check write without response is supported
+    if (!(m_flags & WriteWithoutResponse)) {
+        reply.setError("write without response not supported for this characteristic");
+        reply.finish();
+        return;
+    }
+
+    auto proxy = getProxy();
+
+    if (!proxy || !proxy->isValid()) {
+        reply.setError("no proxy connection");
+        reply.finish();
+        return;
+    }
+
+
+    // lambda invoked when the request returns
+    auto convertVariant = [this, reply](PendingReply<DBusVariant> *dbusReply) mutable
+        {
+            reply.setName(dbusReply->getName());
+            if (dbusReply->isError()) {
+                reply.setError(dbusReply->errorMessage());
+                reply.finish();
+                return;
+            }
+
+            int32_t fdIndex, writeFd;
+            uint16_t mtu;
+            g_variant_get(dbusReply->result().getGVariant(), "(hq)", &fdIndex, &mtu);
+
+            if (!dbusReply->result().getFd(fdIndex, writeFd)) {
+                reply.setError("invalid write socket fd from bluez");
+                reply.finish();
+                return;
+            }
+
+            if (mtu < 23) {
+                close(writeFd);
+
+                XLOGD_ERROR("invalid MTU size on the write socket (%hd bytes)", mtu);
+                reply.setError("Invalid MTU size from bluez");
+                reply.finish();
+                return;
+            }
+
+            XLOGD_INFO("acquired write socket for %s, mtu <%hu>", m_uuid.toString().c_str(), mtu);
+
+            // FileDescriptor dups the fd, so close the original here
+            reply.setResult(FileDescriptor(writeFd));
+            close(writeFd);
+
+            reply.finish();
+        };
+
+    // request a write socket from bluez
+    proxy->AcquireWrite(PendingReply<DBusVariant>(m_isAlive, convertVariant));
+}
+
+
+// -----------------------------------------------------------------------------
+/*!
+    Adds a slot that is called after each batch of notifications has been
+    delivered, lets the client defer work until it has all the pending data.
+
+ */
+void BleGattCharacteristicBluez::addNotificationBatchEndSlot(const Slot<> &func)
+{
+    m_notifyBatchEndSlots.addSlot(func);
+}
+
 
 bool BleGattCharacteristicBluez::notificationsEnabled()
 {
@@ -509,7 +591,15 @@ void BleGattCharacteristicBluez::enableDbusNotifications(const Slot<const std::v
         return;
     }
 
-    proxy->StartNotify(notifyCB, std::move(reply));
+    // each dbus notification arrives on its own, so it is also the end of a batch
+    Slot<const std::vector<uint8_t> &> batchNotifyCB(m_isAlive,
+        [this, notifyCB](const std::vector<uint8_t> &value)
+        {
+            notifyCB.invokeCallback(value);
+            m_notifyBatchEndSlots.invoke();
+        });
+
+    proxy->StartNotify(batchNotifyCB, std::move(reply));
     m_notifyEnabled = true;
 }
 
@@ -607,6 +697,9 @@ void BleGattCharacteristicBluez::enablePipeNotifications(const Slot<const std::v
             m_notifyPipe->addClosedSlot(Slot<>(m_isAlive,
                     std::bind(&BleGattCharacteristicBluez::onNotifyPipeClosed, this)));
 
+            m_notifyPipe->addBatchEndSlot(Slot<>(m_isAlive,
+                    std::bind(&BleGattCharacteristicBluez::onNotifyPipeBatchEnd, this)));
+
             reply.finish();
         };
 
@@ -628,3 +721,16 @@ void BleGattCharacteristicBluez::onNotifyPipeClosed()
     // Nothing to be done here.  This callback is invoked from inside the 
     // m_notifyPipe object itself, which will get cleaned up later
 }
+
+// -----------------------------------------------------------------------------
+/*!
+    \internal
+
+    Slot called when the notification pipe has delivered all the notifications
+    that were pending, passes it on to anyone interested in batches.
+
+ */
+void BleGattCharacteristicBluez::onNotifyPipeBatchEnd()
+{
+    m_notifyBatchEndSlots.invoke();
+}
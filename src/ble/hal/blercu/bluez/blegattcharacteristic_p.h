@@ -104,12 +104,14 @@ public:
     void readValue(PendingReply<std::vector<uint8_t>> &&reply) override;
     void writeValue(const std::vector<uint8_t> &value, PendingReply<> &&reply) override;
     void writeValueWithoutResponse(const std::vector<uint8_t> &value, PendingReply<> &&reply) override;
+    void acquireWrite(PendingReply<FileDescriptor> &&reply) override;
 
     bool notificationsEnabled() override;
     void enableNotifications(const Slot<const std::vector<uint8_t> &> &notifyCB, PendingReply<> &&reply) override;
     void enableDbusNotifications(const Slot<const std::vector<uint8_t> &> &notifyCB, PendingReply<> &&reply) override;
     void enablePipeNotifications(const Slot<const std::vector<uint8_t> &> &notifyCB, PendingReply<> &&reply) override;
     void disableNotifications() override;
+    void addNotificationBatchEndSlot(const Slot<> &func) override;
 
 
     std::vector<uint8_t> readValueSync(std::string &errorMessage) override;
@@ -120,6 +122,7 @@ public:
 
 // private slots:
     void onNotifyPipeClosed();
+    void onNotifyPipeBatchEnd();
 
 private:
     friend class BleGattProfileBluez;
@@ -139,6 +142,7 @@ private:
 
     bool m_notifyEnabled;
     std::shared_ptr<BleGattNotifyPipe> m_notifyPipe;
+    Slots<> m_notifyBatchEndSlots;
 
     std::map<BleUuid, std::shared_ptr<BleGattDescriptorBluez>> m_descriptors;
 };
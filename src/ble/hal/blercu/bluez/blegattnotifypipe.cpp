@@ -125,7 +125,6 @@ BleGattNotifyPipe::BleGattNotifyPipe(int notifyPipeFd, uint16_t mtu, BleUuid uui
     : m_isAlive(make_shared<bool>(true))
     , m_pipeFd(-1)
     , m_bufferSize(23)
-    , m_buffer(nullptr)
     , m_uuid(std::move(uuid))
 {
     m_notifyThread.name = "";
@@ -168,7 +167,8 @@ BleGattNotifyPipe::BleGattNotifyPipe(int notifyPipeFd, uint16_t mtu, BleUuid uui
     }
 
 
-    // allocate a buffer for each individual notification
+    // allocate a buffer for the notifications, it's reused for every
+    // notification so nothing is allocated on the notify path
     m_bufferSize = mtu;
     if (m_bufferSize < 1) {
         XLOGD_ERROR("invalid mtu size, defaulting to 23");
@@ -178,7 +178,7 @@ BleGattNotifyPipe::BleGattNotifyPipe(int notifyPipeFd, uint16_t mtu, BleUuid uui
         XLOGD_ERROR("mtu size is larger than atomic pipe buffer size");
         m_bufferSize = PIPE_BUF;
     }
-    m_buffer = new uint8_t[m_bufferSize];
+    m_buffer.reserve(m_bufferSize);
 
 
     m_notifyThread.name = "ble_notify";
@@ -202,10 +202,6 @@ BleGattNotifyPipe::~BleGattNotifyPipe()
     *m_isAlive = false;
 
     shutdown();
-
-    if (m_buffer) {
-        delete [] m_buffer;
-    }
 }
 
 // -----------------------------------------------------------------------------
@@ -250,16 +246,24 @@ bool BleGattNotifyPipe::isValid() const
 
     Slot called when there is data available to be read from the input pipe.
 
+    All the pending notifications are read in one pass, once the pipe is empty
+    the batch end signal is emitted so listeners can act on the whole batch.
+
  */
 bool BleGattNotifyPipe::onActivated()
 {
+    uint32_t notificationCount = 0;
+
     // read as much as we can from the pipe
     while (m_pipeFd >= 0) {
 
         // note that bluez sensibly uses the O_DIRECT flag for the pipe so that
         // the data in the pipe is packetised, meaning we must read in 20 byte
         // chunks, and we should only get 20 bytes
-        ssize_t rd = TEMP_FAILURE_RETRY(::read(m_pipeFd, m_buffer, m_bufferSize));
+        //
+        // the buffer capacity was reserved up front so resizing it never allocates
+        m_buffer.resize(m_bufferSize);
+        ssize_t rd = TEMP_FAILURE_RETRY(::read(m_pipeFd, m_buffer.data(), m_bufferSize));
         if (rd < 0) {
 
             // check if the pipe is empty, if not the error is valid
@@ -281,18 +285,27 @@ bool BleGattNotifyPipe::onActivated()
                 XLOGD_ERROR("failed to close pipe fd: error = <%d>, <%s>", errsv, strerror(errsv));
             }
             m_pipeFd = -1;
-            
+
+            if (notificationCount > 0) {
+                m_batchEndSlots.invoke();
+            }
             m_closedSlots.invoke();
 
             return false;
 
         } else {
-            std::vector<uint8_t> vec(m_buffer, m_buffer + rd);
+            m_buffer.resize(rd);
 
-            // emit a notification signal
-            m_notificationSlots.invoke(vec);
+            // emit a notification signal, the slots must copy anything they
+            // want to keep as the buffer is overwritten by the next read
+            m_notificationSlots.invoke(m_buffer);
+            notificationCount++;
         }
     }
+
+    if (notificationCount > 0) {
+        m_batchEndSlots.invoke();
+    }
     return true;
 }
 
@@ -36,6 +36,7 @@
 #include <cstdint>
 #include <memory>
 #include <pthread.h>
+#include <vector>
 
 #include "bleuuid.h"
 
@@ -66,9 +67,14 @@ public:
     {
         m_closedSlots.addSlot(func);
     }
+    inline void addBatchEndSlot(const Slot<> &func)
+    {
+        m_batchEndSlots.addSlot(func);
+    }
 
     Slots<const std::vector<uint8_t> &> m_notificationSlots;
     Slots<> m_closedSlots;
+    Slots<> m_batchEndSlots;
 
 
     bool onActivated();
@@ -80,7 +86,7 @@ public:
     int m_exitEventFds[2] = {-1,-1};
 
     size_t m_bufferSize;
-    uint8_t *m_buffer;
+    std::vector<uint8_t> m_buffer;
     BleUuid m_uuid;
 
 
@@ -210,6 +210,15 @@ public:
         asyncMethodCall("AcquireNotify", reply, g_variant_new_tuple(&dict,1));
     }
 
+    inline void AcquireWrite(PendingReply<DBusVariant> &&reply)
+    {
+        GVariantBuilder builder;
+        g_variant_builder_init(&builder, G_VARIANT_TYPE_VARDICT);
+        GVariant *dict = g_variant_builder_end(&builder);
+
+        asyncMethodCall("AcquireWrite", reply, g_variant_new_tuple(&dict,1));
+    }
+
     inline void StartNotify(const Slot<const std::vector<uint8_t>&> &notifyCB, PendingReply<> &&reply)
     {
         addPropertyChangedSlot("Value", notifyCB);
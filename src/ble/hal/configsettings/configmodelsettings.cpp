@@ -39,6 +39,7 @@ ConfigModelSettingsData::ConfigModelSettingsData()
     , m_disabled(false)
     , m_voiceKeyCodePresent(false)
     , m_typeZ(false)
+    , m_upgradeWindowSize(0)
     , m_hasConnParams(false)
     , m_servicesType(ConfigModelSettings::GattServiceType)
 {
@@ -57,6 +58,7 @@ ConfigModelSettingsData::ConfigModelSettingsData(const ConfigModelSettingsData &
     , m_connParamUpdateBeforeOtaVersion(other.m_connParamUpdateBeforeOtaVersion)
     , m_upgradePauseVersion(other.m_upgradePauseVersion)
     , m_upgradeStuckVersion(other.m_upgradeStuckVersion)
+    , m_upgradeWindowSize(other.m_upgradeWindowSize)
     , m_hasConnParams(other.m_hasConnParams)
     // , m_connParams(other.m_connParams)
     , m_servicesType(other.m_servicesType)
@@ -83,6 +85,7 @@ ConfigModelSettingsData::ConfigModelSettingsData(json_t *json)
     , m_connParamUpdateBeforeOtaVersion("")
     , m_upgradePauseVersion("")
     , m_upgradeStuckVersion("")
+    , m_upgradeWindowSize(0)
     , m_hasConnParams(false)
     , m_servicesType(ConfigModelSettings::GattServiceType)
 {
@@ -211,6 +214,22 @@ ConfigModelSettingsData::ConfigModelSettingsData(json_t *json)
         }
     }
 
+    // (optional) upgradeWindowSize field
+    obj = json_object_get(json, "upgradeWindowSize");
+    if (obj) {
+        if (!json_is_integer(obj)) {
+            XLOGD_WARN("Optional field 'upgradeWindowSize' invalid, continuing...");
+        } else {
+            json_int_t windowSize = json_integer_value(obj);
+            if (windowSize < 1 || windowSize > 0xFF) {
+                XLOGD_WARN("Optional field 'upgradeWindowSize' out of range, continuing...");
+            } else {
+                m_upgradeWindowSize = windowSize;
+                XLOGD_INFO("parsed 'upgradeWindowSize' field value <%d>", m_upgradeWindowSize);
+            }
+        }
+    }
+
     // (optional) standbyMode field
     obj = json_object_get(json, "standbyMode");
     if (obj) {
@@ -460,6 +479,16 @@ std::string ConfigModelSettings::upgradeStuckVersion() const
     return d->m_upgradeStuckVersion;
 }
 
+// -----------------------------------------------------------------------------
+/*!
+    The number of f/w upgrade packets sent per window when the RCU doesn't
+    advertise its own window size, 0 if not set.
+ */
+int ConfigModelSettings::upgradeWindowSize() const
+{
+    return d->m_upgradeWindowSize;
+}
+
 // -----------------------------------------------------------------------------
 /*!
     The standby mode used in the IR service.
@@ -70,6 +70,7 @@ public:
     std::string connParamUpdateBeforeOtaVersion() const;
     std::string upgradePauseVersion() const;
     std::string upgradeStuckVersion() const;
+    int upgradeWindowSize() const;
 
     std::string standbyMode() const;
     bool voiceKeyCode(uint16_t &keyCode) const;
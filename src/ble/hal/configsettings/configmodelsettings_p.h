@@ -60,6 +60,7 @@ public:
     std::string m_connParamUpdateBeforeOtaVersion;
     std::string m_upgradePauseVersion;
     std::string m_upgradeStuckVersion;
+    int m_upgradeWindowSize;
 
     bool m_hasConnParams;
     // BleConnectionParameters m_connParams;
@@ -77,7 +77,6 @@ struct FwFileHeader {
 FwImageFile::FwImageFile(const string &filePath)
     : m_valid(false)
     , m_fd(-1)
-    , m_eof(false)
 {
     m_path = filePath;
 
@@ -91,12 +90,12 @@ FwImageFile::FwImageFile(const string &filePath)
     }
     m_fd = fd;
 
-    // check the file header / contents
+    // check the file header / contents, this also loads the image data so
+    // the file isn't needed after this
     m_valid = checkFile();
-    if (!m_valid) {
-        close(m_fd);
-        m_fd = -1;
-    }
+
+    close(m_fd);
+    m_fd = -1;
 }
 
 FwImageFile::~FwImageFile()
@@ -172,23 +171,37 @@ bool FwImageFile::checkFile()
     //     return false;
     // }
 
-    // calculate the crc over the rest of the file after the header
+    // load the rest of the file after the header, the image is sent to the RCU
+    // in small packets so it's read once here rather than for every packet
+    struct stat fileStat;
+    if ((fstat(m_fd, &fileStat) == 0) && (fileStat.st_size > (off_t)sizeof(FwFileHeader))) {
+        m_data.reserve(fileStat.st_size - sizeof(FwFileHeader));
+    }
+
+    uint8_t buffer[4096];
+    while ((ret = read(m_fd, buffer, sizeof(buffer))) != 0) {
+        if (ret < 0) {
+            int errsv = errno;
+            if (errsv == EINTR) {
+                continue;
+            }
+            XLOGD_ERROR("Error reading from file: error = <%d>, <%s>", errsv, strerror(errsv));
+            m_error = "Error reading from file";
+            m_data.clear();
+            return false;
+        }
+        m_data.insert(m_data.end(), buffer, buffer + ret);
+    }
+
+    // calculate the crc over the image data
     Crc32 fileCrc;
-    fileCrc.addData(m_fd);
+    fileCrc.addData(m_data.data(), static_cast<int>(m_data.size()));
 
     if (m_firmwareCrc != fileCrc.result()) {
 
         m_error = "Firmware file header crc error";
         XLOGD_ERROR("%s, m_firmwareCrc = 0x%X, fileCrc = 0x%X", m_error.c_str(), m_firmwareCrc, fileCrc.result());
-        return false;
-    }
-
-
-    // now need to rewind the file to the point right after the header
-    if (lseek(m_fd, sizeof(FwFileHeader), SEEK_SET) < 0) {
-        int errsv = errno;
-        XLOGD_ERROR("failed to rewind the file to the point right after the header, error <%s>", strerror(errsv));
-        m_error = strerror(errsv);
+        m_data.clear();
         return false;
     }
 
@@ -278,98 +291,45 @@ uint32_t FwImageFile::crc32() const
 
 // -----------------------------------------------------------------------------
 /*!
-    Returns the current position within the f/w file.  This is excluding the
-    header, i.e. a position of 0 means we're at the start of the firmware image
-    data.
-
- */
-// int64_t FwImageFile::pos() const
-// {
-//     if (!m_valid) {
-//         return -1;
-//     }
-
-//     return m_file->pos() - sizeof(FwFileHeader);
-// }
-
-// -----------------------------------------------------------------------------
-/*!
-    Returns \c true if the end of the file has been reached; otherwise returns
-    \c false.
-
- */
-bool FwImageFile::atEnd() const
-{
-    if (!m_valid) {
-        return true;
-    }
-
-    return m_eof;
-}
-
-// -----------------------------------------------------------------------------
-/*!
-    Seeks to a position within the image data segment, ie. seeking to postion
-    0 will be at the first byte in the f/w data image, not the first byte in
-    the file.
+    Returns the size of the f/w image data, not the size of the file.  I.e. this
+    is the size of the image to transfer to the RCU.
 
  */
-bool FwImageFile::seek(int64_t pos)
+uint32_t FwImageFile::size() const
 {
     if (!m_valid) {
-        return false;
-    }
-    if (pos < 0) {
-        return false;
-    }
-
-
-    if (lseek(m_fd, sizeof(FwFileHeader) + pos, SEEK_SET) < 0) {
-        int errsv = errno;
-        XLOGD_ERROR("failed to seek the file to offset %llu, error <%s>", 
-                sizeof(FwFileHeader) + pos, strerror(errsv));
-        m_error = strerror(errsv);
-        return false;
+        return -1;
     }
 
-    return true;
+    return m_firmwareSize;
 }
 
 // -----------------------------------------------------------------------------
 /*!
-    Returns the size of the f/w image data, not the size of the file.  I.e. this
-    is the size of the image to transfer to the RCU.
+    Returns a pointer to the f/w image data loaded from the file, excluding
+    the header.  The data is valid for the lifetime of this object.
 
  */
-uint32_t FwImageFile::size() const
+const uint8_t *FwImageFile::data() const
 {
     if (!m_valid) {
-        return -1;
+        return nullptr;
     }
 
-    return m_firmwareSize;
+    return m_data.data();
 }
 
 // -----------------------------------------------------------------------------
 /*!
-    Reads data from the firmware data segment starting at the current position.
+    Returns the number of bytes of image data loaded from the file, i.e. the
+    number of bytes available from data().
 
  */
-int64_t FwImageFile::readFile(void *data, int64_t len)
+uint32_t FwImageFile::dataSize() const
 {
     if (!m_valid) {
-        return -1;
-    }
-
-    ssize_t ret = read(m_fd, (void*)data, len);
-    if (ret < 0) {
-        int errsv = errno;
-        XLOGD_ERROR("Error reading from file: error = <%d>, <%s>", errsv, strerror(errsv));
-        m_error = "Error reading from file";
-    } else if (ret == 0) {
-        m_eof = true;
+        return 0;
     }
 
-    return ret;
+    return static_cast<uint32_t>(m_data.size());
 }
-
@@ -31,6 +31,7 @@
 #define FWIMAGEFILE_H
 
 #include <string>
+#include <vector>
 
 class FwImageFile
 {
@@ -56,13 +57,10 @@ public:
     uint32_t crc32() const;
 
 public:
-    bool atEnd() const;
-    // int64_t pos() const;
-    bool seek(int64_t pos);
-
     uint32_t size() const;
 
-    int64_t readFile(void *data, int64_t len);
+    const uint8_t *data() const;
+    uint32_t dataSize() const;
 
 private:
     bool checkFile();
@@ -71,6 +69,8 @@ private:
     bool m_valid;
     int m_fd;
 
+    std::vector<uint8_t> m_data;
+
     std::string m_path;
     std::string m_error;
 
@@ -78,8 +78,6 @@ private:
     uint32_t m_firmwareVersion = 0;
     uint32_t m_firmwareSize = 0;
     uint32_t m_firmwareCrc = 0;
-    
-    bool m_eof;
 };
 
 #endif // !defined(FWIMAGEFILE_H)
@@ -32,6 +32,7 @@
 
 #include <string>
 #include <functional>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -95,56 +96,78 @@ private:
     std::function<void(Args...)> m_callback;
 };
 
+// The slot list is copy-on-write: addSlot() and clear() build a new list and
+// publish it, invoke() just takes a reference to the current list.  So invoke
+// neither copies the slots nor holds m_lock while the callbacks run, and a
+// callback is free to add more slots (they'll be called on the next invoke).
+// Note std::atomic_load/store of a shared_ptr isn't lock-free, libstdc++ guards
+// them with a mutex from a small internal pool, but that's only held for the
+// reference count update and not while the callbacks run.
 template<typename... Args>
 class Slots
 {
 public:
-    Slots() = default;
+    Slots()
+        : m_slots(std::make_shared<const SlotList>())
+    { }
     ~Slots()
     { }
 
     Slots(const Slots<Args...>& other)
-        : m_slots(other.m_slots)
+        : m_slots(std::atomic_load(&other.m_slots))
     { }
 
 public:
     inline void clear()
     {
         std::lock_guard<std::mutex> lock(m_lock);
-        m_slots.clear();
+        std::atomic_store(&m_slots, std::make_shared<const SlotList>());
     }
 
     inline void invoke(Args... args)
     {
-        //First, delete any invalid callbacks
-        m_lock.lock();
-        for (auto it = m_slots.begin(); it != m_slots.end();) {
-            if (it->isCallbackValid()) {
-                ++it;
+        const std::shared_ptr<const SlotList> slots = std::atomic_load(&m_slots);
+
+        bool pruneRequired = false;
+        for (const auto &slot : *slots) {
+            if (slot.isCallbackValid()) {
+                slot.invokeCallback(args...);
             } else {
-                it = m_slots.erase(it);
+                pruneRequired = true;
             }
         }
 
-        // make a local copy of slots inside mutex.
-        // I'm doing this because a slot callback could invoke other slots or functions
-        // that add more slots.  This could be a mutex deadlock risk.
-        const std::vector<Slot<Args...>> slots = m_slots;
-        m_lock.unlock();
-
-        for(const auto &slot : slots) {
-            slot.invokeCallback(args...);
+        // delete any invalid callbacks, this is rare so it's fine to do the copy here
+        if (pruneRequired) {
+            prune();
         }
     }
 
     inline void addSlot(const Slot<Args...> &slot)
     {
         std::lock_guard<std::mutex> lock(m_lock);
-        m_slots.push_back(slot);
+        auto slots = std::make_shared<SlotList>(*std::atomic_load(&m_slots));
+        slots->push_back(slot);
+        std::atomic_store(&m_slots, std::shared_ptr<const SlotList>(std::move(slots)));
+    }
+
+private:
+    typedef std::vector<Slot<Args...>> SlotList;
+
+    inline void prune()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        auto slots = std::make_shared<SlotList>();
+        for (const auto &slot : *std::atomic_load(&m_slots)) {
+            if (slot.isCallbackValid()) {
+                slots->push_back(slot);
+            }
+        }
+        std::atomic_store(&m_slots, std::shared_ptr<const SlotList>(std::move(slots)));
     }
 
 private:
-    std::vector<Slot<Args...>> m_slots;
+    std::shared_ptr<const SlotList> m_slots;
     std::mutex m_lock;
 };
 
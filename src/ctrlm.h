@@ -55,6 +55,7 @@ class ctrlm_irdb_interface_t;
 class ctrlm_auth_t;
 class ctrlm_telemetry_t;
 class ctrlm_rcp_ipc_net_status_t;
+class ctrlm_rcp_ipc_net_status_snapshot_t;
 typedef enum {
    CTRLM_THREAD_MONITOR_RESPONSE_DEAD  = 0,
    CTRLM_THREAD_MONITOR_RESPONSE_ALIVE = 1
@@ -125,10 +126,20 @@ typedef enum {
    CTRLM_MAIN_QUEUE_MSG_TYPE_EXPORT_CONTROLLER_LIST,
    CTRLM_MAIN_QUEUE_MSG_TYPE_ACCOUNT_ID_UPDATE,
    CTRLM_MAIN_QUEUE_MSG_TYPE_STARTUP,
-   CTRLM_MAIN_QUEUE_MSG_TYPE_HANDLER_NEW
+   CTRLM_MAIN_QUEUE_MSG_TYPE_HANDLER_NEW,
+   CTRLM_MAIN_QUEUE_MSG_TYPE_DISPATCH_STATS,
+   CTRLM_MAIN_QUEUE_MSG_TYPE_BACKUP_COMPLETE
    // End global messages
 } ctrlm_main_queue_msg_type_t;
 
+// Interactive messages (RF4CE and BLE key presses, voice session begin/end/request/stop) may be handled ahead of
+// background messages from other networks. Messages from the same network keep their order whatever their priority.
+typedef enum {
+   CTRLM_MAIN_QUEUE_PRIORITY_INTERACTIVE = 0, // User visible latency (key presses, voice session begin/end)
+   CTRLM_MAIN_QUEUE_PRIORITY_BACKGROUND  = 1, // Everything else
+   CTRLM_MAIN_QUEUE_PRIORITY_QTY         = 2
+} ctrlm_main_queue_priority_t;
+
 typedef enum
 {
    CTRLM_REMOTE_KEYPAD_CONFIG_HAS_SETUP_KEY_WITH_NUMBER_KEYS,
@@ -424,6 +435,16 @@ typedef struct {
    ctrlm_power_state_t           new_state;
 } ctrlm_main_queue_power_state_change_t;
 
+typedef struct {
+   ctrlm_main_queue_msg_header_t header;
+   bool                          telemetry; // Report to telemetry and start a new interval (otherwise only log)
+} ctrlm_main_queue_msg_dispatch_stats_t;
+
+typedef struct {
+   ctrlm_main_queue_msg_header_t header;
+   bool                          success; // Result of the ctrlm db backup
+} ctrlm_main_queue_msg_backup_complete_t;
+
 typedef struct {
    time_t last_key_time;
    uint16_t last_key_code;
@@ -442,6 +463,8 @@ std::vector<ctrlm_network_type_t>  ctrlm_network_types_get(void);
 ctrlm_network_id_t                 ctrlm_network_id_get(ctrlm_network_type_t network_type);
 gboolean                           ctrlm_precomission_lookup(ctrlm_network_id_t network_id, ctrlm_controller_id_t controller_id);
 void                               ctrlm_main_queue_msg_push(gpointer msg);
+void                               ctrlm_main_queue_msg_push_priority(gpointer msg, ctrlm_main_queue_priority_t priority);
+gpointer                           ctrlm_main_queue_msg_alloc(gsize size);
 void                               ctrlm_stop_binding_button(void);
 void                               ctrlm_stop_binding_screen(void);
 void                               ctrlm_stop_one_touch_autobind(void);
@@ -511,6 +534,8 @@ ctrlm_irdb_interface_t* ctrlm_main_irdb_get();
 ctrlm_auth_t* ctrlm_main_auth_get();
 void          ctrlm_main_auth_start_poll();
 std::shared_ptr<void> ctrlm_main_all_network_rcu_status_get();
+void          ctrlm_main_rcu_status_publish(const ctrlm_rcp_ipc_net_status_t &net_status);
+std::shared_ptr<const ctrlm_rcp_ipc_net_status_snapshot_t> ctrlm_main_rcu_status_snapshot_get();
 std::string ctrlm_device_id_get();
 std::string ctrlm_stb_name_get();
 std::string ctrlm_device_mac_get();
@@ -524,13 +549,14 @@ std::string ctrlm_main_ir_controller_name_get();
 
 
 template <typename T>
-void ctrlm_main_queue_handler_push(ctrlm_handler_type_t type, T handler, void *data, int size, void *obj = NULL, ctrlm_network_id_t network_id = CTRLM_MAIN_NETWORK_ID_INVALID, bool synchronous = false) {
+void ctrlm_main_queue_handler_push_priority(ctrlm_main_queue_priority_t priority, ctrlm_handler_type_t type, T handler, void *data, int size, void *obj = NULL, ctrlm_network_id_t network_id = CTRLM_MAIN_NETWORK_ID_INVALID, bool synchronous = false) {
    int msg_size = sizeof(ctrlm_main_queue_msg_handler_t) + size;
    if (size > 1) {
       --msg_size;
    }
    errno_t safec_rc = -1;
-   ctrlm_main_queue_msg_handler_t *msg = (ctrlm_main_queue_msg_handler_t *)g_malloc(msg_size);
+   // Allocated from the main queue's preallocated slots (heap only for oversized payloads), already zeroed
+   ctrlm_main_queue_msg_handler_t *msg = (ctrlm_main_queue_msg_handler_t *)ctrlm_main_queue_msg_alloc(msg_size);
 
    if(NULL == msg) {
       g_assert(0);
@@ -540,8 +566,6 @@ void ctrlm_main_queue_handler_push(ctrlm_handler_type_t type, T handler, void *d
    if(synchronous) {
       sem_init(&semaphore, 0, 0);
    }
-   safec_rc = memset_s(msg, msg_size, 0, msg_size);
-   ERR_CHK(safec_rc);
    msg->header.type       = CTRLM_MAIN_QUEUE_MSG_TYPE_HANDLER;
    msg->header.network_id = network_id;
    msg->obj               = obj;
@@ -558,7 +582,7 @@ void ctrlm_main_queue_handler_push(ctrlm_handler_type_t type, T handler, void *d
       safec_rc = memcpy_s(msg->data, msg->data_len, data, size);
       ERR_CHK(safec_rc);
    }
-   ctrlm_main_queue_msg_push(msg);
+   ctrlm_main_queue_msg_push_priority(msg, priority);
 
    if(synchronous) { // Wait for the result semaphore to be signaled
       sem_wait(&semaphore);
@@ -566,6 +590,11 @@ void ctrlm_main_queue_handler_push(ctrlm_handler_type_t type, T handler, void *d
    }
 }
 
+template <typename T>
+void ctrlm_main_queue_handler_push(ctrlm_handler_type_t type, T handler, void *data, int size, void *obj = NULL, ctrlm_network_id_t network_id = CTRLM_MAIN_NETWORK_ID_INVALID, bool synchronous = false) {
+   ctrlm_main_queue_handler_push_priority(CTRLM_MAIN_QUEUE_PRIORITY_BACKGROUND, type, handler, data, size, obj, network_id, synchronous);
+}
+
 template <typename T1, typename T2>
 void ctrlm_main_queue_handler_push_new(ctrlm_handler_type_t type, T1 handler, std::shared_ptr<T2> data, void *obj = NULL, ctrlm_network_id_t network_id = CTRLM_MAIN_NETWORK_ID_INVALID, bool synchronous = false) {
    ctrlm_main_queue_msg_handler_new_t *msg = new (std::nothrow) ctrlm_main_queue_msg_handler_new_t();
@@ -264,6 +264,40 @@ void ctrlm_obj_controller_t::update_voice_metrics(bool is_short_utterance, uint3
    voice_metrics_->print(__FUNCTION__, true);
 }
 
+// Records the stages of a key press which has just been emitted
+void ctrlm_obj_controller_t::key_latency_add(const ctrlm_key_latency_trace_t &trace) {
+   ctrlm_timestamp_t now;
+   ctrlm_timestamp_get_monotonic(&now);
+
+   signed long long queue_us   = ctrlm_timestamp_subtract_us(trace.received, trace.dequeued);
+   signed long long process_us = ctrlm_timestamp_subtract_us(trace.dequeued, now);
+   if(queue_us < 0) {
+      queue_us = 0;
+   }
+   if(process_us < 0) {
+      process_us = 0;
+   }
+   if(trace.input_us != 0) {
+      key_latency_[CTRLM_KEY_LATENCY_STAGE_INPUT].add(trace.input_us);
+   }
+   key_latency_[CTRLM_KEY_LATENCY_STAGE_QUEUE].add(queue_us);
+   key_latency_[CTRLM_KEY_LATENCY_STAGE_PROCESS].add(process_us);
+   key_latency_[CTRLM_KEY_LATENCY_STAGE_TOTAL].add(trace.input_us + queue_us + process_us);
+}
+
+const ctrlm_histogram_atomic_t &ctrlm_obj_controller_t::key_latency_get(ctrlm_key_latency_stage_t stage) const {
+   if((unsigned int)stage >= CTRLM_KEY_LATENCY_STAGE_QTY) {
+      stage = CTRLM_KEY_LATENCY_STAGE_TOTAL;
+   }
+   return(key_latency_[stage]);
+}
+
+void ctrlm_obj_controller_t::key_latency_reset() {
+   for(unsigned int stage = 0; stage < CTRLM_KEY_LATENCY_STAGE_QTY; stage++) {
+      key_latency_[stage].reset();
+   }
+}
+
 void ctrlm_obj_controller_t::set_device_minor_id(int device_minor_id) {
     XLOGD_DEBUG("Controller %u set device ID to %d", controller_id_get(), device_minor_id);
     device_minor_id_ = device_minor_id;
@@ -26,9 +26,26 @@
 #include "ctrlm_attr_general.h"
 #include "ctrlm_attr_voice.h"
 #include "ctrlm_version.h"
+#include "ctrlm_histogram.h"
 
 #define LAST_KEY_DATABASE_FLUSH_INTERVAL (2 * 60 * 60) // in seconds
 
+// Stages of a key press on its way from the remote to uinput/IARM emission
+typedef enum {
+   CTRLM_KEY_LATENCY_STAGE_INPUT   = 0, // evdev event timestamp to the key monitor reading it (BLE only)
+   CTRLM_KEY_LATENCY_STAGE_QUEUE   = 1, // key read or HAL indication to the main thread picking it up
+   CTRLM_KEY_LATENCY_STAGE_PROCESS = 2, // main thread pick up to key emission
+   CTRLM_KEY_LATENCY_STAGE_TOTAL   = 3, // sum of the stages
+   CTRLM_KEY_LATENCY_STAGE_QTY     = 4
+} ctrlm_key_latency_stage_t;
+
+// Timestamps carried with a key press for end to end key latency
+typedef struct {
+   ctrlm_timestamp_t  received; // monotonic time the key entered ctrlm (evdev read or HAL indication)
+   ctrlm_timestamp_t  dequeued; // monotonic time the main thread started processing the key
+   unsigned long long input_us; // evdev event timestamp to the read, 0 when not known
+} ctrlm_key_latency_trace_t;
+
 class ctrlm_obj_network_t;
 
 class ctrlm_obj_controller_t
@@ -108,6 +125,10 @@ public:
 
    void                    update_voice_metrics(bool is_short_utterance, uint32_t voice_packets_sent, uint32_t voice_packets_lost);
 
+   void                            key_latency_add(const ctrlm_key_latency_trace_t &trace);
+   const ctrlm_histogram_atomic_t &key_latency_get(ctrlm_key_latency_stage_t stage) const;
+   void                            key_latency_reset();
+
 private:
    ctrlm_controller_id_t      controller_id_ = CTRLM_MAIN_CONTROLLER_ID_INVALID;
    ctrlm_obj_network_t       *obj_network_   = NULL;
@@ -139,6 +160,8 @@ protected:
    std::string                             upgrade_error_msg_ = "";
    std::string                             upgrade_session_uuid_ = "";
    uint8_t                                 upgrade_increment_ = -1;
+
+   ctrlm_histogram_atomic_t                key_latency_[CTRLM_KEY_LATENCY_STAGE_QTY];
 };
 
 #endif
@@ -25,6 +25,9 @@
 #include <semaphore.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "libIBus.h"
 #include "ctrlm.h"
 #include "ctrlm_log.h"
@@ -146,16 +149,19 @@ typedef struct {
    guint                                   timeout_source_id;
    device_update_timeout_session_params_t *timeout_params;
    guint32                                 timeout_value;
-   FILE *                                  fd;
-   char *                                  chunk_even;
-   char *                                  chunk_odd;
-   guint32                                 offset_even;
-   guint32                                 offset_odd;
-   guint32                                 bytes_read_file;
+   const guchar *                          image;           // Shared mapping of the image file
+   guint32                                 bytes_read_file; // End of the readahead window
    guint32                                 bytes_read_controller;
    gboolean                                resume_pending;
 } ctrlm_device_update_rf4ce_session_t;
 
+typedef struct {
+   string                                  file_path;
+   const guchar *                          data;
+   size_t                                  size;
+   guint32                                 ref_count;
+} ctrlm_device_update_rf4ce_image_map_t;
+
 typedef struct {
    bool     interactive;
    bool     background;
@@ -197,6 +203,7 @@ typedef struct {
    guint32                                         rf4ce_session_active_count;
    guint32                                         rf4ce_session_count;
    map<ctrlm_controller_id_t, ctrlm_device_update_rf4ce_session_t> rf4ce_sessions;
+   map<guint16, ctrlm_device_update_rf4ce_image_map_t>             rf4ce_image_maps; // Only accessed from the device update thread
    
    gboolean                                        xr15_crash_update;
    
@@ -232,6 +239,9 @@ static void     ctrlm_device_update_rf4ce_archive_remove(const std::string &file
 static gboolean ctrlm_device_update_rf4ce_image_stage(ctrlm_controller_id_t controller_id, guint16 image_id, guint32 session_count, guint32 rf4ce_session_count, guint32 reader_count);
 static gboolean ctrlm_device_update_rf4ce_image_unstage(ctrlm_controller_id_t controller_id, guint16 image_id, guint32 session_count, guint32 rf4ce_session_count, guint32 reader_count);
 static gboolean ctrlm_device_update_rf4ce_image_read_next_chunk(ctrlm_controller_id_t controller_id, guint16 image_id, guint32 *offset);
+static const guchar *ctrlm_device_update_rf4ce_image_map_acquire(guint16 image_id, const std::string &file_path, guint32 size);
+static void     ctrlm_device_update_rf4ce_image_map_release(guint16 image_id);
+static void     ctrlm_device_update_rf4ce_image_readahead(const guchar *image, guint32 offset, guint32 length);
 static void     ctrlm_device_update_rf4ce_download_complete(ctrlm_device_update_rf4ce_session_t *session_info);
 static void     ctrlm_device_update_process_dirs(void);
 static void     ctrlm_device_update_rf4ce_session_resume_check(vector<rf4ce_device_update_session_resume_info_t> *sessions, bool process_local_files);
@@ -1412,6 +1422,79 @@ gboolean ctrlm_device_update_rf4ce_image_read_next_chunk(ctrlm_controller_id_t c
    return(true);
 }
 
+const guchar *ctrlm_device_update_rf4ce_image_map_acquire(guint16 image_id, const std::string &file_path, guint32 size) {
+   auto itr = g_ctrlm_device_update.rf4ce_image_maps.find(image_id);
+   if(itr != g_ctrlm_device_update.rf4ce_image_maps.end()) {
+      if(itr->second.file_path != file_path) {
+         XLOGD_ERROR("Image id %u is mapped from <%s>", image_id, itr->second.file_path.c_str());
+         return(NULL);
+      }
+      itr->second.ref_count++;
+      XLOGD_INFO("Image id %u mapping shared, ref count %u", image_id, itr->second.ref_count);
+      return(itr->second.data);
+   }
+
+   int fd = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+   if(fd < 0) {
+      XLOGD_TELEMETRY("Unable to open image file <%s>", file_path.c_str());
+      return(NULL);
+   }
+   struct stat st;
+   if(fstat(fd, &st) != 0 || st.st_size <= 0 || (guint32)st.st_size < size) {
+      XLOGD_ERROR("Image file <%s> is smaller than expected <%u>", file_path.c_str(), size);
+      close(fd);
+      return(NULL);
+   }
+   void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   int errsv = errno;
+   close(fd); // The mapping holds its own reference to the file
+   if(data == MAP_FAILED) {
+      XLOGD_ERROR("Unable to map image file <%s> <%s>", file_path.c_str(), strerror(errsv));
+      return(NULL);
+   }
+   if(madvise(data, st.st_size, MADV_SEQUENTIAL) != 0) {
+      XLOGD_WARN("madvise failed <%s>", strerror(errno));
+   }
+
+   ctrlm_device_update_rf4ce_image_map_t &image_map = g_ctrlm_device_update.rf4ce_image_maps[image_id];
+   image_map.file_path = file_path;
+   image_map.data      = (const guchar *)data;
+   image_map.size      = st.st_size;
+   image_map.ref_count = 1;
+   XLOGD_INFO("Image id %u mapped, size %zu", image_id, image_map.size);
+   return(image_map.data);
+}
+
+void ctrlm_device_update_rf4ce_image_map_release(guint16 image_id) {
+   auto itr = g_ctrlm_device_update.rf4ce_image_maps.find(image_id);
+   if(itr == g_ctrlm_device_update.rf4ce_image_maps.end()) {
+      XLOGD_ERROR("Image id %u is not mapped", image_id);
+      return;
+   }
+   if(itr->second.ref_count > 1) {
+      itr->second.ref_count--;
+      return;
+   }
+   if(munmap((void *)itr->second.data, itr->second.size) != 0) {
+      XLOGD_ERROR("munmap failed <%s>", strerror(errno));
+   }
+   XLOGD_INFO("Image id %u unmapped", image_id);
+   g_ctrlm_device_update.rf4ce_image_maps.erase(itr);
+}
+
+void ctrlm_device_update_rf4ce_image_readahead(const guchar *image, guint32 offset, guint32 length) {
+   // The mapping is page aligned so rounding the start down stays within it
+   uintptr_t page  = (uintptr_t)sysconf(_SC_PAGESIZE);
+   uintptr_t start = ((uintptr_t)image + offset) & ~(page - 1);
+   uintptr_t end   = (uintptr_t)image + offset + length;
+   if(length == 0) {
+      return;
+   }
+   if(madvise((void *)start, end - start, MADV_WILLNEED) != 0) {
+      XLOGD_WARN("madvise failed <%s>", strerror(errno));
+   }
+}
+
 
 gpointer ctrlm_device_update_thread(gpointer param) {
    bool running = true;
@@ -1494,39 +1577,24 @@ gpointer ctrlm_device_update_thread(gpointer param) {
                ctrlm_device_update_rf4ce_archive_extract(image_info->file_path_archive, image_info->file_name_archive);
             }
 
-            // Open the file with read access
+            // Map the file, sessions updating from the same image share the mapping
             string file_path_image = g_ctrlm_device_update.prefs.temp_file_path + "rf4ce/" + image_info->file_name_archive + "/" + image_info->file_name_image;
 
-            XLOGD_INFO("Opening image file <%s>", file_path_image.c_str());
+            XLOGD_INFO("Mapping image file <%s>", file_path_image.c_str());
 
-            session_info->fd = fopen(file_path_image.c_str(), "r");
-            if(session_info->fd == NULL) {
-               XLOGD_TELEMETRY("Unable to open image file <%s>", file_path_image.c_str());
+            const guchar *image = ctrlm_device_update_rf4ce_image_map_acquire(stage->image_id, file_path_image, image_info->size);
+            if(image == NULL) {
                break;
             }
+            guint32 window = MIN(image_info->size, DEVICE_UPDATE_IMAGE_CHUNK_SIZE * 2);
+            ctrlm_device_update_rf4ce_image_readahead(image, 0, window);
 
-            // Allocate two chunk buffers
-            char *chunks = (char *) g_malloc(DEVICE_UPDATE_IMAGE_CHUNK_SIZE * 2);
-            if(chunks == NULL) {
-               XLOGD_INFO("Out of memory");
-            } else {
-               size_t size = fread(chunks, 1, DEVICE_UPDATE_IMAGE_CHUNK_SIZE * 2, session_info->fd);
-
-               if(size != DEVICE_UPDATE_IMAGE_CHUNK_SIZE * 2) {
-                  XLOGD_INFO("Unable to read first two chunks %u", size);
-                  g_free(chunks);
-               } else {
-                  DEVICE_UPDATE_MUTEX_LOCK();
+            DEVICE_UPDATE_MUTEX_LOCK();
 
-                  session_info->chunk_even      = chunks;
-                  session_info->chunk_odd       = chunks + DEVICE_UPDATE_IMAGE_CHUNK_SIZE;
-                  session_info->offset_even     = 0;
-                  session_info->offset_odd      = DEVICE_UPDATE_IMAGE_CHUNK_SIZE;
-                  session_info->bytes_read_file = size;
+            session_info->image           = image;
+            session_info->bytes_read_file = window;
 
-                  DEVICE_UPDATE_MUTEX_UNLOCK();
-               }
-            }
+            DEVICE_UPDATE_MUTEX_UNLOCK();
             break;
          }
          case DEVICE_UPDATE_QUEUE_MSG_TYPE_IMAGE_READ: {
@@ -1541,65 +1609,35 @@ gpointer ctrlm_device_update_thread(gpointer param) {
             }
             session_info = &g_ctrlm_device_update.rf4ce_sessions[read->controller_id];
 
+            if(session_info->image == NULL) {
+               XLOGD_WARN("READ image not staged %u", read->controller_id);
+               break;
+            }
+
+            // The data is read straight from the mapping, this only asks the kernel to page in the next window ahead of the controller
+            guint32 offset;
             if(read->use_offset) { // Controller has resumed download from a different point in the file
                XLOGD_INFO("RESET Image id %u Offset %u", read->image_id, read->offset);
-
-               guint32 offset = read->offset & ~(DEVICE_UPDATE_IMAGE_CHUNK_SIZE - 1);
-
-               int rc = fseek(session_info->fd, offset, SEEK_SET);
-               if(rc != 0) {
-                  int errsv = errno;
-                  XLOGD_ERROR("%u fseek failed  <%s>", read->controller_id, strerror(errsv));
-                  break;
-               }
-
-               size_t size = fread(session_info->chunk_even, 1, DEVICE_UPDATE_IMAGE_CHUNK_SIZE * 2, session_info->fd);
-
-               if(size != DEVICE_UPDATE_IMAGE_CHUNK_SIZE * 2) {
-                  XLOGD_INFO("Unable to read two chunks %u", size);
-               } else {
-                  DEVICE_UPDATE_MUTEX_LOCK();
-
-                  session_info->offset_even     = offset;
-                  session_info->offset_odd      = offset + DEVICE_UPDATE_IMAGE_CHUNK_SIZE;
-                  session_info->bytes_read_file = offset + (DEVICE_UPDATE_IMAGE_CHUNK_SIZE * 2);
-                  session_info->resume_pending  = false;
-
-                  DEVICE_UPDATE_MUTEX_UNLOCK();
-               }
+               offset = read->offset & ~(DEVICE_UPDATE_IMAGE_CHUNK_SIZE - 1);
             } else {
-               guint32 chunk_size = DEVICE_UPDATE_IMAGE_CHUNK_SIZE;
-
                XLOGD_INFO("READ Image id %u Offset %u", read->image_id, session_info->bytes_read_file);
+               offset = session_info->bytes_read_file;
+            }
+            if(offset >= image_info->size) {
+               XLOGD_INFO("End of file reached %u", image_info->size);
+               break;
+            }
+            guint32 length = MIN(image_info->size - offset, read->use_offset ? DEVICE_UPDATE_IMAGE_CHUNK_SIZE * 2 : DEVICE_UPDATE_IMAGE_CHUNK_SIZE);
+            ctrlm_device_update_rf4ce_image_readahead(session_info->image, offset, length);
 
-               // This section does not use a mutex to avoid blocking the controller image read which is time sensitive.
-
-               if(session_info->offset_even > session_info->offset_odd) {
-                  if(session_info->offset_odd + DEVICE_UPDATE_IMAGE_CHUNK_SIZE * 3 >= image_info->size) {
-                     XLOGD_INFO("End of file reached %u", image_info->size);
-                     chunk_size = image_info->size - (session_info->offset_odd + DEVICE_UPDATE_IMAGE_CHUNK_SIZE * 2);
-                  }
-                  size_t size = fread(session_info->chunk_odd, 1, chunk_size, session_info->fd);
-                  if(size == chunk_size) {
-                     session_info->offset_odd      += DEVICE_UPDATE_IMAGE_CHUNK_SIZE * 2;
-                     session_info->bytes_read_file += size;
-                  } else {
-                     XLOGD_INFO("Unable to read next chunk. req %u got %u", chunk_size, size);
-                  }
-               } else {
-                  if(session_info->offset_even + DEVICE_UPDATE_IMAGE_CHUNK_SIZE * 3 >= image_info->size) {
-                     XLOGD_INFO("End of file reached %u", image_info->size);
-                     chunk_size = image_info->size - (session_info->offset_even + DEVICE_UPDATE_IMAGE_CHUNK_SIZE * 2);
-                  }
-                  size_t size = fread(session_info->chunk_even, 1, chunk_size, session_info->fd);
-                  if(size == chunk_size) {
-                     session_info->offset_even     += DEVICE_UPDATE_IMAGE_CHUNK_SIZE * 2;
-                     session_info->bytes_read_file += size;
-                  } else {
-                     XLOGD_INFO("Unable to read next chunk. req %u got %u", chunk_size, size);
-                  }
-               }
+            DEVICE_UPDATE_MUTEX_LOCK();
+
+            session_info->bytes_read_file = offset + length;
+            if(read->use_offset) {
+               session_info->resume_pending = false;
             }
+
+            DEVICE_UPDATE_MUTEX_UNLOCK();
             break;
          }
          case DEVICE_UPDATE_QUEUE_MSG_TYPE_IMAGE_UNSTAGE: {
@@ -1616,18 +1654,10 @@ gpointer ctrlm_device_update_thread(gpointer param) {
 
             session_info = &g_ctrlm_device_update.rf4ce_sessions[unstage->controller_id];
 
-            if(session_info->fd != NULL) {
-               fclose(session_info->fd);
-               session_info->fd = NULL;
-            }
-
-            if(session_info->chunk_even != NULL) {
-               g_free(session_info->chunk_even);
+            if(session_info->image != NULL) {
+               session_info->image = NULL;
+               ctrlm_device_update_rf4ce_image_map_release(unstage->image_id);
             }
-            session_info->chunk_even  = NULL;
-            session_info->chunk_odd   = NULL;
-            session_info->offset_even = 0;
-            session_info->offset_odd  = 0;
 
             // Remove timeout source
             ctrlm_device_update_timeout_session_destroy(&g_ctrlm_device_update.rf4ce_sessions[unstage->controller_id].timeout_source_id);
@@ -1694,7 +1724,7 @@ guint16 ctrlm_device_update_rf4ce_image_data_read(ctrlm_network_id_t network_id,
    // Kick the session timeout
    ctrlm_device_update_timeout_session_update(&session_info->timeout_source_id, g_ctrlm_device_update.rf4ce_sessions[controller_id].timeout_value, session_info->timeout_params);
 
-   if(session_info->chunk_even == NULL) {
+   if(session_info->image == NULL) {
       XLOGD_INFO("Controller id %u: : No data yet", controller_id);
       DEVICE_UPDATE_MUTEX_UNLOCK();
       return(qty_read);
@@ -1702,43 +1732,19 @@ guint16 ctrlm_device_update_rf4ce_image_data_read(ctrlm_network_id_t network_id,
    XLOGD_INFO("Controller id %u: Image id %u Offset %u Length %u", controller_id, image_id, offset, length);
 
    // Read the data
-   if(offset >= session_info->offset_even && (offset + length) <= (session_info->offset_even + DEVICE_UPDATE_IMAGE_CHUNK_SIZE)) { // Data is in even chunk
-      safec_rc = memcpy_s(data, length, &session_info->chunk_even[offset - session_info->offset_even], length);
-      ERR_CHK(safec_rc);
-      qty_read = length;
-   } else if(offset >= session_info->offset_odd && (offset + length) <= (session_info->offset_odd + DEVICE_UPDATE_IMAGE_CHUNK_SIZE)) { // Data is in odd chunk
-      safec_rc = memcpy_s(data, length, &session_info->chunk_odd[offset - session_info->offset_odd], length);
-      ERR_CHK(safec_rc);
-      qty_read = length;
-   } else if(session_info->offset_odd  > session_info->offset_even && offset < session_info->offset_odd && (offset + length) > session_info->offset_even) { // Data crosses from even to odd
-      safec_rc = memcpy_s(data, length, &session_info->chunk_even[offset - session_info->offset_even], length);
-      ERR_CHK(safec_rc);
-      qty_read = length;
-   } else if(session_info->offset_even > session_info->offset_odd  && offset < session_info->offset_even  && (offset + length) > session_info->offset_odd)  { // Data crosses from odd to even
-      guint16 length_odd, length_even;
-      length_odd  = session_info->offset_even - offset;
-      length_even = length - length_odd;
-      //XLOGD_INFO("Odd to even crossing. length odd %u even %u", length_odd, length_even);
-      safec_rc = memcpy_s(data, length, &session_info->chunk_odd[offset - session_info->offset_odd], length_odd);
-      ERR_CHK(safec_rc);
-      safec_rc = memcpy_s(&data[length_odd], length, &session_info->chunk_even[0], length_even);
-      ERR_CHK(safec_rc);
-      qty_read = length;
-   } else {
-      XLOGD_INFO("Controller id %u: Data not found. offset odd <%u> even <%u> chunk size <%u> resume pending <%s>", controller_id, session_info->offset_odd, session_info->offset_even, DEVICE_UPDATE_IMAGE_CHUNK_SIZE, session_info->resume_pending ? "YES" : "NO");
+   safec_rc = memcpy_s(data, length, &session_info->image[offset], length);
+   ERR_CHK(safec_rc);
+   qty_read = length;
 
-      // Controller is resuming download
+   guint32 window_start = (session_info->bytes_read_file > DEVICE_UPDATE_IMAGE_CHUNK_SIZE * 2) ? (session_info->bytes_read_file - DEVICE_UPDATE_IMAGE_CHUNK_SIZE * 2) : 0;
+   if(offset < window_start || offset > session_info->bytes_read_file) { // Controller is resuming download
+      XLOGD_INFO("Controller id %u: Resume from offset <%u> readahead window <%u, %u> resume pending <%s>", controller_id, offset, window_start, session_info->bytes_read_file, session_info->resume_pending ? "YES" : "NO");
       if(!session_info->resume_pending) {
          ctrlm_device_update_rf4ce_image_read_next_chunk(controller_id, image_id, &offset);
          session_info->bytes_read_controller = offset;
          session_info->resume_pending        = true;
       }
-      DEVICE_UPDATE_MUTEX_UNLOCK();
-      return(0);
-   }
-   
-   // Request to read the next chunk?
-   if((qty_read == length) && ((offset + length + DEVICE_UPDATE_IMAGE_CHUNK_THRESHOLD) > session_info->bytes_read_file) && (session_info->bytes_read_file < image_info->size)) {
+   } else if(!session_info->resume_pending && ((offset + length + DEVICE_UPDATE_IMAGE_CHUNK_THRESHOLD) > session_info->bytes_read_file) && (session_info->bytes_read_file < image_info->size)) { // Request readahead of the next chunk?
       ctrlm_device_update_rf4ce_image_read_next_chunk(controller_id, image_id, NULL);
    }
 
@@ -1841,11 +1847,7 @@ gboolean ctrlm_device_update_rf4ce_begin(ctrlm_network_id_t network_id, ctrlm_co
       g_ctrlm_device_update.rf4ce_sessions[controller_id].timeout_source_id     = 0;
       g_ctrlm_device_update.rf4ce_sessions[controller_id].timeout_params        = NULL;
       g_ctrlm_device_update.rf4ce_sessions[controller_id].timeout_value         = (timeout + 999) / 1000;
-      g_ctrlm_device_update.rf4ce_sessions[controller_id].fd                    = NULL;
-      g_ctrlm_device_update.rf4ce_sessions[controller_id].chunk_even            = NULL;
-      g_ctrlm_device_update.rf4ce_sessions[controller_id].chunk_odd             = NULL;
-      g_ctrlm_device_update.rf4ce_sessions[controller_id].offset_even           = 0;
-      g_ctrlm_device_update.rf4ce_sessions[controller_id].offset_odd            = 0;
+      g_ctrlm_device_update.rf4ce_sessions[controller_id].image                 = NULL;
       g_ctrlm_device_update.rf4ce_sessions[controller_id].bytes_read_file       = 0;
       g_ctrlm_device_update.rf4ce_sessions[controller_id].bytes_read_controller = 0;
       g_ctrlm_device_update.rf4ce_sessions[controller_id].download_initiated    = false;
@@ -0,0 +1,185 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#ifndef _CTRLM_HISTOGRAM_H_
+#define _CTRLM_HISTOGRAM_H_
+
+#include <atomic>
+#include <string>
+
+// Counter types for ctrlm_histogram_base_t.  The plain counter is for a histogram owned by one thread.  The atomic
+// counter uses relaxed operations so one thread can add values while others read without a lock.
+template <typename T>
+class ctrlm_histogram_counter_t {
+public:
+    T load() const {
+        return(m_value);
+    }
+
+    void store(T value) {
+        m_value = value;
+    }
+
+    void add(T value) {
+        m_value += value;
+    }
+
+    void raise(T value) {
+        if(value > m_value) {
+            m_value = value;
+        }
+    }
+
+private:
+    T m_value;
+};
+
+template <typename T>
+class ctrlm_histogram_counter_atomic_t {
+public:
+    T load() const {
+        return(m_value.load(std::memory_order_relaxed));
+    }
+
+    void store(T value) {
+        m_value.store(value, std::memory_order_relaxed);
+    }
+
+    void add(T value) {
+        m_value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    void raise(T value) {
+        T current = m_value.load(std::memory_order_relaxed);
+        while(value > current && !m_value.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+private:
+    std::atomic<T> m_value;
+};
+
+// Log2 bucketed histogram of durations in microseconds. Bucket 0 counts values below 1 us and
+// bucket N counts values in [2^(N-1), 2^N) us. The last bucket also collects everything beyond
+// its range (about 8 seconds). Adding a value is a few instructions and never allocates.
+// With atomic counters a reader may see a value counted in a bucket before the totals, which only
+// skews a percentile by one sample.
+template <template <typename> class counter_t>
+class ctrlm_histogram_base_t {
+public:
+    static const unsigned int BUCKET_QTY = 24;
+
+    ctrlm_histogram_base_t() {
+        reset();
+    }
+
+    void add(unsigned long long value_us) {
+        unsigned int bucket = (value_us == 0) ? 0 : (64 - __builtin_clzll(value_us));
+        if(bucket >= BUCKET_QTY) {
+            bucket = BUCKET_QTY - 1;
+        }
+        m_buckets[bucket].add(1);
+        m_count.add(1);
+        m_total.add(value_us);
+        m_max.raise(value_us);
+    }
+
+    void reset() {
+        for(unsigned int bucket = 0; bucket < BUCKET_QTY; bucket++) {
+            m_buckets[bucket].store(0);
+        }
+        m_count.store(0);
+        m_total.store(0);
+        m_max.store(0);
+    }
+
+    unsigned long long count() const {
+        return(m_count.load());
+    }
+
+    unsigned long long total() const {
+        return(m_total.load());
+    }
+
+    unsigned long long max() const {
+        return(m_max.load());
+    }
+
+    unsigned long long average() const {
+        unsigned long long count = m_count.load();
+        return(count ? (m_total.load() / count) : 0);
+    }
+
+    // Returns the upper bound of the bucket holding the given percentile (never more than the maximum value seen)
+    unsigned long long percentile(unsigned int percent) const {
+        unsigned long long buckets[BUCKET_QTY];
+        unsigned long long count = 0;
+        for(unsigned int bucket = 0; bucket < BUCKET_QTY; bucket++) {
+            buckets[bucket] = m_buckets[bucket].load();
+            count          += buckets[bucket];
+        }
+        unsigned long long max = m_max.load();
+        if(count == 0) {
+            return(0);
+        }
+        unsigned long long target = (count * percent + 99) / 100;
+        unsigned long long sum    = 0;
+        for(unsigned int bucket = 0; bucket < BUCKET_QTY; bucket++) {
+            sum += buckets[bucket];
+            if(sum >= target && sum > 0) {
+                unsigned long long upper = (1ULL << bucket);
+                return((upper < max) ? upper : max);
+            }
+        }
+        return(max);
+    }
+
+    // Comma separated bucket counts with trailing empty buckets omitted
+    std::string buckets_str() const {
+        unsigned long buckets[BUCKET_QTY];
+        unsigned int  last = 0;
+        for(unsigned int bucket = 0; bucket < BUCKET_QTY; bucket++) {
+            buckets[bucket] = m_buckets[bucket].load();
+            if(buckets[bucket] != 0) {
+                last = bucket;
+            }
+        }
+        std::string str;
+        for(unsigned int bucket = 0; bucket <= last; bucket++) {
+            if(bucket != 0) {
+                str += ",";
+            }
+            str += std::to_string(buckets[bucket]);
+        }
+        return(str);
+    }
+
+private:
+    counter_t<unsigned long>      m_buckets[BUCKET_QTY];
+    counter_t<unsigned long long> m_count;
+    counter_t<unsigned long long> m_total;
+    counter_t<unsigned long long> m_max;
+};
+
+// Owned by one thread
+typedef ctrlm_histogram_base_t<ctrlm_histogram_counter_t>        ctrlm_histogram_t;
+// Added to by one thread and read by others without a lock
+typedef ctrlm_histogram_base_t<ctrlm_histogram_counter_atomic_t> ctrlm_histogram_atomic_t;
+
+#endif
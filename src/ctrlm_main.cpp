@@ -22,6 +22,7 @@
 #include <sys/signalfd.h>
 #include <sys/sysinfo.h>
 #include <poll.h>
+#include <sched.h>
 #include <glib.h>
 #include <glib-unix.h>
 #include <string.h>
@@ -32,6 +33,10 @@
 #include <memory>
 #include <algorithm>
 #include <fstream>
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <cxxabi.h>
 #include <secure_wrapper.h>
 #include <rdkversion.h>
 #include "jansson.h"
@@ -52,6 +57,8 @@
 #include "ctrlm.h"
 #include "ctrlm_log.h"
 #include "ctrlm_utils.h"
+#include "ctrlm_ring.h"
+#include "ctrlm_histogram.h"
 #include "ctrlm_database.h"
 #include "ctrlm_rcu.h"
 #include "ctrlm_validation.h"
@@ -117,12 +124,58 @@ using namespace std;
 #define CTRLM_RF4CE_LEN_PAIRING_METRICS sizeof(ctrlm_pairing_metrics_t)
 
 #define CTRLM_MAIN_QUEUE_REPEAT_DELAY   (5000)
+#define CTRLM_MAIN_QUEUE_RING_SIZE      (1024) // pending messages per priority before producers spill into the overflow list
+#define CTRLM_MAIN_QUEUE_INTERACTIVE_RUN_MAX (8) // consecutive interactive messages before a waiting background message is served
+#define CTRLM_MAIN_QUEUE_SOURCE_QTY     (256)  // one per network id, messages are ordered per source
+#define CTRLM_MAIN_QUEUE_SLOT_SIZE      (256)  // bytes per preallocated message slot
+#define CTRLM_MAIN_QUEUE_SLOT_QTY       (256)  // number of preallocated message slots
 
 #define CTRLM_MAIN_FIRST_BOOT_TIME_MAX (180) // maximum amount of uptime allowed (in seconds) for declaring "first boot"
 
 typedef void (*ctrlm_queue_push_t)(gpointer);
 typedef void (*ctrlm_monitor_poll)(void *data);
 
+typedef struct {
+   gpointer           msg;
+   ctrlm_timestamp_t  enqueued;
+   ctrlm_network_id_t source;
+} ctrlm_main_queue_entry_t;
+
+typedef struct {
+   ctrlm_ring_t<ctrlm_main_queue_entry_t> *ring;
+   std::mutex                              overflow_mutex;
+   std::deque<ctrlm_main_queue_entry_t>    overflow;
+   std::atomic<unsigned long>              overflow_pending;
+   std::atomic<unsigned long>              source_pending[CTRLM_MAIN_QUEUE_SOURCE_QTY]; // Messages in this lane per network id
+   std::atomic<unsigned long>              overflow_qty;
+   // Updated by the main thread after each pop, read and reset by the thread monitor
+   std::atomic<unsigned long>              msg_qty;
+   std::atomic<unsigned long>              depth_max;
+   std::atomic<unsigned long>              wait_us_total;
+   std::atomic<unsigned long>              wait_us_max;
+} ctrlm_main_queue_lane_t;
+
+// Dispatch statistics are kept per message type, and per handler function for handler messages
+typedef struct ctrlm_main_dispatch_key_s {
+   unsigned int type;
+   uintptr_t    handler[2];
+
+   bool operator<(const struct ctrlm_main_dispatch_key_s &other) const {
+      if(type != other.type) {
+         return(type < other.type);
+      }
+      if(handler[0] != other.handler[0]) {
+         return(handler[0] < other.handler[0]);
+      }
+      return(handler[1] < other.handler[1]);
+   }
+} ctrlm_main_dispatch_key_t;
+
+typedef struct {
+   ctrlm_histogram_t wait; // Time spent in the queue
+   ctrlm_histogram_t run;  // Time spent in the handler
+} ctrlm_main_dispatch_stats_t;
+
 typedef struct {
    const char *                    name;
    ctrlm_queue_push_t              queue_push;
@@ -183,7 +236,15 @@ typedef struct {
    GMainLoop *                        main_loop;
    sem_t                              semaphore;
    sem_t                              ctrlm_utils_sem;
-   GAsyncQueue *                      queue;
+   ctrlm_main_queue_lane_t            queue[CTRLM_MAIN_QUEUE_PRIORITY_QTY];
+   sem_t                              queue_semaphore;
+   guint                              queue_interactive_run;
+   std::map<ctrlm_main_dispatch_key_t, ctrlm_main_dispatch_stats_t> dispatch_stats; // Only accessed by the main thread
+   guint                              dispatch_stats_timeout_tag;
+   guchar *                           queue_slots;
+   ctrlm_ring_t<guint> *              queue_slots_free;
+   std::atomic<unsigned long>         queue_slot_alloc_qty;
+   std::atomic<unsigned long>         queue_heap_alloc_qty;
    string                             stb_name;
    string                             device_id;
    ctrlm_device_type_t                device_type;
@@ -287,6 +348,8 @@ typedef struct {
    ctrlm_ir_controller_t             *ir_controller;
    bool                               networked_standby_supported;
    gboolean                           wake_with_voice_allowed;
+   std::shared_ptr<const ctrlm_rcp_ipc_net_status_snapshot_t> rcu_status_snapshot; // swapped atomically, read from any thread
+   unsigned long long                 rcu_status_version;
 } ctrlm_global_t;
 
 static ctrlm_global_t g_ctrlm;
@@ -338,6 +401,11 @@ static void     ctrlm_trigger_startup_actions(void);
 
 static gpointer ctrlm_main_thread(gpointer param);
 static void     ctrlm_queue_msg_destroy(gpointer msg);
+static void     ctrlm_main_queue_stats_log(bool reset);
+static void     ctrlm_main_dispatch_stats_dump(bool telemetry);
+static void     ctrlm_main_key_latency_dump(bool telemetry);
+static gboolean ctrlm_main_dispatch_stats_timeout(gpointer user_data);
+static gboolean ctrlm_unix_signal_dispatch_stats(gpointer user_data);
 static gboolean ctrlm_timeout_recently_booted(gpointer user_data);
 static gboolean ctrlm_timeout_systemd_restart_delay(gpointer user_data);
 static gboolean ctrlm_thread_monitor(gpointer user_data);
@@ -399,6 +467,9 @@ static void     ctrlm_check_for_key_tag(int key_tag) __attribute__((unused)); //
 #if CTRLM_HAL_RF4CE_API_VERSION >= 9
 static void ctrlm_crash_recovery_check();
 static void ctrlm_backup_data();
+static void ctrlm_backup_data_db_complete(bool success, void *user_data);
+static void ctrlm_backup_data_end(bool success);
+static bool ctrlm_backup_data_timestamps_set();
 #endif
 
 static void ctrlm_ir_controller_thread_poll(void *data);
@@ -490,7 +561,25 @@ int main(int argc, char *argv[]) {
    // Initialize control manager global structure
    g_ctrlm.main_loop                      = g_main_loop_new(NULL, true);
    g_ctrlm.main_thread                    = NULL;
-   g_ctrlm.queue                          = NULL;
+   for(int priority = 0; priority < CTRLM_MAIN_QUEUE_PRIORITY_QTY; priority++) {
+      ctrlm_main_queue_lane_t *lane = &g_ctrlm.queue[priority];
+      lane->ring             = NULL;
+      lane->overflow_pending = 0;
+      lane->overflow_qty     = 0;
+      lane->msg_qty          = 0;
+      lane->depth_max        = 0;
+      lane->wait_us_total    = 0;
+      lane->wait_us_max      = 0;
+      for(int source = 0; source < CTRLM_MAIN_QUEUE_SOURCE_QTY; source++) {
+         lane->source_pending[source] = 0;
+      }
+   }
+   g_ctrlm.queue_interactive_run          = 0;
+   g_ctrlm.dispatch_stats_timeout_tag     = 0;
+   g_ctrlm.queue_slots                    = NULL;
+   g_ctrlm.queue_slots_free               = NULL;
+   g_ctrlm.queue_slot_alloc_qty           = 0;
+   g_ctrlm.queue_heap_alloc_qty           = 0;
    g_ctrlm.production_build               = true;
    g_ctrlm.rf4ce_hal_handle               = ctrlm_load_plugin_rf4ce_hal();
    g_ctrlm.rf4ce_enabled                  = (NULL == g_ctrlm.rf4ce_hal_handle) ? false : true;
@@ -587,8 +676,17 @@ int main(int argc, char *argv[]) {
    }
 
    // Launch a thread to handle DB writes asynchronously
-   // Create an asynchronous queue to receive incoming messages from the networks
-   g_ctrlm.queue = g_async_queue_new_full(ctrlm_queue_msg_destroy);
+   // Create a lock-free queue per priority to receive incoming messages from the networks along with
+   // preallocated message slots so the common small messages don't touch the heap
+   for(int priority = 0; priority < CTRLM_MAIN_QUEUE_PRIORITY_QTY; priority++) {
+      g_ctrlm.queue[priority].ring = new ctrlm_ring_t<ctrlm_main_queue_entry_t>(CTRLM_MAIN_QUEUE_RING_SIZE);
+   }
+   g_ctrlm.queue_slots      = (guchar *)g_malloc0(CTRLM_MAIN_QUEUE_SLOT_SIZE * CTRLM_MAIN_QUEUE_SLOT_QTY);
+   g_ctrlm.queue_slots_free = new ctrlm_ring_t<guint>(CTRLM_MAIN_QUEUE_SLOT_QTY);
+   for(guint slot = 0; slot < CTRLM_MAIN_QUEUE_SLOT_QTY; slot++) {
+      g_ctrlm.queue_slots_free->push(slot);
+   }
+   sem_init(&g_ctrlm.queue_semaphore, 0, 0);
 
    g_ctrlm.mask_pii = ctrlm_is_production_build() ? JSON_ARRAY_VAL_BOOL_CTRLM_GLOBAL_MASK_PII_0 : JSON_ARRAY_VAL_BOOL_CTRLM_GLOBAL_MASK_PII_1;
 
@@ -640,6 +738,7 @@ int main(int argc, char *argv[]) {
 #ifdef TELEMETRY_SUPPORT
    // set telemetry duration after config parsing
    g_ctrlm.telemetry->set_duration(g_ctrlm.telemetry_report_interval);
+   g_ctrlm.dispatch_stats_timeout_tag = ctrlm_timeout_create(g_ctrlm.telemetry_report_interval, ctrlm_main_dispatch_stats_timeout, NULL);
 #endif
 
    XLOGD_INFO("load device mac");
@@ -782,10 +881,8 @@ int main(int argc, char *argv[]) {
    XLOGD_INFO("networks init complete");
 
 #if CTRLM_HAL_RF4CE_API_VERSION >= 9
-   // Init was successful, create backups of all NVM files
+   // Init was successful, create backups of all NVM files.  Recovery is reset once the backup has finished.
    ctrlm_backup_data();
-   // Terminate recovery component and reset all values
-   ctrlm_recovery_terminate(true);
 #endif
 
    if(json_obj_root) {
@@ -911,6 +1008,27 @@ std::shared_ptr<void> ctrlm_main_all_network_rcu_status_get() {
    return params;
 }
 
+// Replace one network's entry in the rcu status snapshot. Only the main thread publishes so the copy and swap
+// can't race with another writer. Readers keep whichever snapshot they loaded until they drop it.
+void ctrlm_main_rcu_status_publish(const ctrlm_rcp_ipc_net_status_t &net_status) {
+   if (g_ctrlm.main_thread != g_thread_self ()) {
+      XLOGD_ERROR("not called from ctrlm_main_thread!!!!!");
+      if(!ctrlm_is_production_build()) {
+         g_assert(0);
+      }
+      return;
+   }
+
+   std::shared_ptr<const ctrlm_rcp_ipc_net_status_snapshot_t> current  = std::atomic_load(&g_ctrlm.rcu_status_snapshot);
+   std::shared_ptr<const ctrlm_rcp_ipc_net_status_snapshot_t> snapshot = std::make_shared<const ctrlm_rcp_ipc_net_status_snapshot_t>(++g_ctrlm.rcu_status_version, current.get(), net_status);
+   std::atomic_store(&g_ctrlm.rcu_status_snapshot, snapshot);
+   XLOGD_DEBUG("rcu status version <%llu> network id <%u>", g_ctrlm.rcu_status_version, net_status.get_net_id());
+}
+
+std::shared_ptr<const ctrlm_rcp_ipc_net_status_snapshot_t> ctrlm_main_rcu_status_snapshot_get() {
+   return(std::atomic_load(&g_ctrlm.rcu_status_snapshot));
+}
+
 void ctrlm_utils_sem_wait(){
    sem_wait(&g_ctrlm.ctrlm_utils_sem);
 }
@@ -988,6 +1106,10 @@ gboolean ctrlm_thread_monitor(gpointer user_data) {
       g_ctrlm.thread_monitor_index += g_ctrlm.thread_monitor_timeout_val;
    } else {
       XLOG_RAW("\n");
+      ctrlm_main_queue_stats_log(true);
+      #ifdef CTRLM_THUNDER
+      Thunder::Plugin::ctrlm_thunder_plugin_t::call_stats_log_all(true);
+      #endif
       XLOGD_NO_LF(XLOG_LEVEL_INFO, "."); XLOG_FLUSH();
       g_ctrlm.thread_monitor_index = 0;
    }
@@ -1018,6 +1140,9 @@ gboolean ctrlm_thread_monitor(gpointer user_data) {
 
          if(it->response != CTRLM_THREAD_MONITOR_RESPONSE_ALIVE) {
             XLOGD_AUTOMATION_TELEMETRY("Thread %s is unresponsive", it->name);
+            if(0 == strncmp(it->name, CTRLM_THREAD_NAME_MAIN, sizeof(CTRLM_THREAD_NAME_MAIN))) {
+               ctrlm_main_queue_stats_log(false);
+            }
             #ifdef BREAKPAD_SUPPORT
             if(g_ctrlm.thread_monitor_minidump) {
                XLOGD_FATAL("Thread Monitor Minidump is enabled");
@@ -1145,6 +1270,21 @@ static gboolean ctrlm_unix_signal_terminate(gpointer user_data) {
    return G_SOURCE_CONTINUE;
 }
 
+// SIGUSR1 logs the main thread dispatch statistics and exports the voice session timelines
+static gboolean ctrlm_unix_signal_dispatch_stats(gpointer user_data) {
+   XLOGD_INFO("Received SIGUSR1");
+   ctrlm_main_queue_msg_dispatch_stats_t *msg = (ctrlm_main_queue_msg_dispatch_stats_t *)g_malloc0(sizeof(ctrlm_main_queue_msg_dispatch_stats_t));
+   if(NULL == msg) {
+      XLOGD_ERROR("Out of memory");
+      return(G_SOURCE_CONTINUE);
+   }
+   msg->header.type       = CTRLM_MAIN_QUEUE_MSG_TYPE_DISPATCH_STATS;
+   msg->header.network_id = CTRLM_MAIN_NETWORK_ID_ALL;
+   msg->telemetry         = false;
+   ctrlm_main_queue_msg_push(msg);
+   return(G_SOURCE_CONTINUE);
+}
+
 void ctrlm_signals_register(void) {
    // Use g_unix_signal_add() so callbacks run inside the GLib main loop context
    // rather than from an async signal handler, avoiding undefined behavior from
@@ -1157,6 +1297,10 @@ void ctrlm_signals_register(void) {
    if(0 == g_unix_signal_add(SIGTERM, ctrlm_unix_signal_terminate, GINT_TO_POINTER(SIGTERM))) {
       XLOGD_ERROR("Unable to register for SIGTERM.");
    }
+   XLOGD_INFO("Registering SIGUSR1...");
+   if(0 == g_unix_signal_add(SIGUSR1, ctrlm_unix_signal_dispatch_stats, NULL)) {
+      XLOGD_ERROR("Unable to register for SIGUSR1.");
+   }
    bool interactive = isatty(STDIN_FILENO);
    if(!interactive) {
       XLOGD_INFO("Skipping SIGQUIT registration.");
@@ -2297,12 +2441,151 @@ gboolean ctrlm_is_binding_table_empty(void) {
 
 // Add a message to the control manager's processing queue
 void ctrlm_main_queue_msg_push(gpointer msg) {
-   g_async_queue_push(g_ctrlm.queue, msg);
+   ctrlm_main_queue_msg_push_priority(msg, CTRLM_MAIN_QUEUE_PRIORITY_BACKGROUND);
+}
+
+// Messages from the same network (and so from the same controller) are never reordered. A message is put in the
+// lane that already holds pending messages from its network, whatever priority was requested, so it can only
+// overtake messages from other networks.
+void ctrlm_main_queue_msg_push_priority(gpointer msg, ctrlm_main_queue_priority_t priority) {
+   if((unsigned int)priority >= CTRLM_MAIN_QUEUE_PRIORITY_QTY) {
+      priority = CTRLM_MAIN_QUEUE_PRIORITY_BACKGROUND;
+   }
+   if(g_ctrlm.queue[priority].ring == NULL) {
+      XLOGD_ERROR("main queue not created");
+      ctrlm_queue_msg_destroy(msg);
+      return;
+   }
+   ctrlm_main_queue_entry_t entry;
+   entry.msg    = msg;
+   entry.source = ((ctrlm_main_queue_msg_header_t *)msg)->network_id;
+   ctrlm_timestamp_get_monotonic(&entry.enqueued);
+
+   for(int other = 0; other < CTRLM_MAIN_QUEUE_PRIORITY_QTY; other++) {
+      if(other != priority && g_ctrlm.queue[other].source_pending[entry.source] > 0) {
+         priority = (ctrlm_main_queue_priority_t)other;
+         break;
+      }
+   }
+   ctrlm_main_queue_lane_t *lane = &g_ctrlm.queue[priority];
+   lane->source_pending[entry.source]++; // Counted before publishing so the main thread's decrement can't underflow
+
+   if(!lane->ring->push(entry)) {
+      // The ring is full so the main thread is badly backed up. Spill into the overflow list rather than
+      // blocking, since the producer may be the main thread itself. Ordering is only kept within each list.
+      if(0 == lane->overflow_qty++) {
+         XLOGD_WARN("main queue <%s> full (%zu messages), using overflow list", ctrlm_main_queue_priority_str(priority), lane->ring->capacity());
+      }
+      std::unique_lock<std::mutex> lock(lane->overflow_mutex);
+      lane->overflow.push_back(entry);
+      lane->overflow_pending++;
+   }
+   sem_post(&g_ctrlm.queue_semaphore);
+}
+
+static bool ctrlm_main_queue_lane_pop(ctrlm_main_queue_lane_t *lane, ctrlm_main_queue_entry_t *entry) {
+   if(lane->ring->pop(*entry)) {
+      return(true);
+   }
+   if(lane->overflow_pending == 0) {
+      return(false);
+   }
+   std::unique_lock<std::mutex> lock(lane->overflow_mutex);
+   if(lane->overflow.empty()) {
+      return(false);
+   }
+   *entry = lane->overflow.front();
+   lane->overflow.pop_front();
+   lane->overflow_pending--;
+   return(true);
+}
+
+// Remove the next message from the control manager's processing queue, blocking until one is available.
+// Interactive messages are served first, but after a run of them a waiting background message gets a turn
+// so background work can't be starved by a long burst of key presses.
+static gpointer ctrlm_main_queue_msg_pop(unsigned long *wait_us) {
+   ctrlm_main_queue_entry_t entry;
+
+   while(0 != sem_wait(&g_ctrlm.queue_semaphore)) {
+      if(errno != EINTR) {
+         XLOGD_ERROR("sem_wait failed <%s>", strerror(errno));
+         return(NULL);
+      }
+   }
+   int first = (g_ctrlm.queue_interactive_run >= CTRLM_MAIN_QUEUE_INTERACTIVE_RUN_MAX) ? CTRLM_MAIN_QUEUE_PRIORITY_BACKGROUND : CTRLM_MAIN_QUEUE_PRIORITY_INTERACTIVE;
+
+   // The semaphore is posted after the message is published, but an earlier producer may still be
+   // between claiming its cell and publishing it. In that case yield until it completes.
+   for(;;) {
+      for(int index = 0; index < CTRLM_MAIN_QUEUE_PRIORITY_QTY; index++) {
+         int                      priority = (first + index) % CTRLM_MAIN_QUEUE_PRIORITY_QTY;
+         ctrlm_main_queue_lane_t *lane     = &g_ctrlm.queue[priority];
+
+         if(!ctrlm_main_queue_lane_pop(lane, &entry)) {
+            continue;
+         }
+         lane->source_pending[entry.source]--;
+         g_ctrlm.queue_interactive_run = (priority == CTRLM_MAIN_QUEUE_PRIORITY_INTERACTIVE) ? g_ctrlm.queue_interactive_run + 1 : 0;
+
+         ctrlm_timestamp_t now;
+         ctrlm_timestamp_get_monotonic(&now);
+         unsigned long depth = lane->ring->size() + lane->overflow_pending + 1;
+         *wait_us = (unsigned long)ctrlm_timestamp_subtract_us(entry.enqueued, now);
+
+         lane->msg_qty++;
+         lane->wait_us_total += *wait_us;
+         if(*wait_us > lane->wait_us_max) {
+            lane->wait_us_max = *wait_us;
+         }
+         if(depth > lane->depth_max) {
+            lane->depth_max = depth;
+         }
+         return(entry.msg);
+      }
+      sched_yield();
+   }
+}
+
+// Log the depth and wait time of each priority class. When reset is true the interval statistics start over.
+static void ctrlm_main_queue_stats_log(bool reset) {
+   for(int priority = 0; priority < CTRLM_MAIN_QUEUE_PRIORITY_QTY; priority++) {
+      ctrlm_main_queue_lane_t *lane = &g_ctrlm.queue[priority];
+      if(lane->ring == NULL) {
+         continue;
+      }
+      unsigned long msg_qty       = reset ? lane->msg_qty.exchange(0)       : lane->msg_qty.load();
+      unsigned long depth_max     = reset ? lane->depth_max.exchange(0)     : lane->depth_max.load();
+      unsigned long wait_us_total = reset ? lane->wait_us_total.exchange(0) : lane->wait_us_total.load();
+      unsigned long wait_us_max   = reset ? lane->wait_us_max.exchange(0)   : lane->wait_us_max.load();
+
+      XLOGD_INFO("main queue <%s> depth <%lu> max <%lu> msgs <%lu> wait avg <%lu> max <%lu> us overflow <%lu>", ctrlm_main_queue_priority_str((ctrlm_main_queue_priority_t)priority),
+                 (unsigned long)lane->ring->size() + lane->overflow_pending.load(), depth_max, msg_qty, (msg_qty ? wait_us_total / msg_qty : 0), wait_us_max, lane->overflow_qty.load());
+   }
+}
+
+// Allocate a zeroed message for the main queue. Messages that fit in a preallocated slot avoid the heap.
+// The message must be released with ctrlm_queue_msg_destroy (which the main thread does after dispatch).
+gpointer ctrlm_main_queue_msg_alloc(gsize size) {
+   guint slot;
+   if(size <= CTRLM_MAIN_QUEUE_SLOT_SIZE && g_ctrlm.queue_slots_free != NULL && g_ctrlm.queue_slots_free->pop(slot)) {
+      gpointer msg = &g_ctrlm.queue_slots[slot * CTRLM_MAIN_QUEUE_SLOT_SIZE];
+      errno_t safec_rc = memset_s(msg, CTRLM_MAIN_QUEUE_SLOT_SIZE, 0, size);
+      ERR_CHK(safec_rc);
+      g_ctrlm.queue_slot_alloc_qty++;
+      return(msg);
+   }
+   g_ctrlm.queue_heap_alloc_qty++;
+   return(g_malloc0(size));
 }
 
 void ctrlm_queue_msg_destroy(gpointer msg) {
    if(msg) {
-      g_free(msg);
+      guchar *slot = (guchar *)msg;
+      if(g_ctrlm.queue_slots != NULL && slot >= g_ctrlm.queue_slots && slot < &g_ctrlm.queue_slots[CTRLM_MAIN_QUEUE_SLOT_SIZE * CTRLM_MAIN_QUEUE_SLOT_QTY]) {
+         g_ctrlm.queue_slots_free->push((guint)((slot - g_ctrlm.queue_slots) / CTRLM_MAIN_QUEUE_SLOT_SIZE));
+      } else {
+         g_free(msg);
+      }
    }
 }
 
@@ -2382,6 +2665,171 @@ void ctrlm_main_update_check_update_complete_all(ctrlm_main_queue_msg_update_fil
 
 }
 
+static void ctrlm_main_dispatch_key_get(ctrlm_main_queue_msg_header_t *hdr, ctrlm_main_dispatch_key_t *key) {
+   static_assert(sizeof(((ctrlm_main_queue_msg_handler_t *)0)->msg_handler) <= sizeof(key->handler), "handler key is too small");
+
+   key->type       = hdr->type;
+   key->handler[0] = 0;
+   key->handler[1] = 0;
+
+   if(hdr->type == CTRLM_MAIN_QUEUE_MSG_TYPE_HANDLER) {
+      ctrlm_main_queue_msg_handler_t *dqm = (ctrlm_main_queue_msg_handler_t *)hdr;
+      errno_t safec_rc = memcpy_s(key->handler, sizeof(key->handler), &dqm->msg_handler, sizeof(dqm->msg_handler));
+      ERR_CHK(safec_rc);
+   } else if(hdr->type == CTRLM_MAIN_QUEUE_MSG_TYPE_HANDLER_NEW) {
+      ctrlm_main_queue_msg_handler_new_t *dqm = (ctrlm_main_queue_msg_handler_new_t *)hdr;
+      errno_t safec_rc = memcpy_s(key->handler, sizeof(key->handler), &dqm->msg_handler, sizeof(dqm->msg_handler));
+      ERR_CHK(safec_rc);
+   }
+}
+
+static void ctrlm_main_dispatch_stats_add(const ctrlm_main_dispatch_key_t *key, unsigned long wait_us, const ctrlm_timestamp_t *start) {
+   ctrlm_timestamp_t now;
+   ctrlm_timestamp_get_monotonic(&now);
+
+   ctrlm_main_dispatch_stats_t &stats = g_ctrlm.dispatch_stats[*key];
+   stats.wait.add(wait_us);
+   stats.run.add((unsigned long long)ctrlm_timestamp_subtract_us(*start, now));
+}
+
+// Message types are named directly. A handler's member function pointer holds the function address when
+// the handler is not virtual, so try to resolve it to a symbol. Otherwise report the raw pointer.
+static std::string ctrlm_main_dispatch_key_str(const ctrlm_main_dispatch_key_t &key) {
+   if(key.type != CTRLM_MAIN_QUEUE_MSG_TYPE_HANDLER && key.type != CTRLM_MAIN_QUEUE_MSG_TYPE_HANDLER_NEW) {
+      if(key.type >= CTRLM_MAIN_QUEUE_MSG_TYPE_VENDOR_FIRST && key.type <= CTRLM_MAIN_QUEUE_MSG_TYPE_VENDOR_LAST) {
+         return("VENDOR_" + std::to_string(key.type));
+      }
+      return(ctrlm_main_queue_msg_type_str((ctrlm_main_queue_msg_type_t)key.type));
+   }
+   std::string str = (key.type == CTRLM_MAIN_QUEUE_MSG_TYPE_HANDLER) ? "HANDLER " : "HANDLER_NEW ";
+   Dl_info     info;
+
+   if(0 != dladdr((void *)key.handler[0], &info) && info.dli_sname != NULL) {
+      int   status    = -1;
+      char *demangled = abi::__cxa_demangle(info.dli_sname, NULL, NULL, &status);
+      str += (status == 0 && demangled != NULL) ? demangled : info.dli_sname;
+      free(demangled);
+   } else {
+      char ptr[48];
+      snprintf(ptr, sizeof(ptr), "0x%lx:0x%lx", (unsigned long)key.handler[0], (unsigned long)key.handler[1]);
+      str += ptr;
+   }
+   return(str);
+}
+
+// Logs the queue wait and handler run time histograms for every message type and handler. For telemetry, the
+// entries with the most run time are also reported and the statistics are reset to start a new interval.
+static void ctrlm_main_dispatch_stats_dump(bool telemetry) {
+   std::vector<std::pair<std::string, const ctrlm_main_dispatch_stats_t *> > entries;
+
+   for(auto const &itr : g_ctrlm.dispatch_stats) {
+      if(itr.second.run.count() == 0) {
+         continue;
+      }
+      entries.push_back(std::make_pair(ctrlm_main_dispatch_key_str(itr.first), &itr.second));
+   }
+   std::sort(entries.begin(), entries.end(), [](const std::pair<std::string, const ctrlm_main_dispatch_stats_t *> &a, const std::pair<std::string, const ctrlm_main_dispatch_stats_t *> &b) {
+      return(a.second->run.total() > b.second->run.total());
+   });
+
+   XLOGD_INFO("dispatch statistics for %zu message types and handlers (us, log2 buckets)", entries.size());
+   for(auto const &itr : entries) {
+      const ctrlm_main_dispatch_stats_t *stats = itr.second;
+      XLOGD_INFO("<%s> count <%llu> wait avg <%llu> p99 <%llu> max <%llu> [%s] run avg <%llu> p99 <%llu> max <%llu> [%s]", itr.first.c_str(), stats->run.count(),
+                 stats->wait.average(), stats->wait.percentile(99), stats->wait.max(), stats->wait.buckets_str().c_str(),
+                 stats->run.average(),  stats->run.percentile(99),  stats->run.max(),  stats->run.buckets_str().c_str());
+   }
+
+   if(!telemetry) {
+      return;
+   }
+#ifdef TELEMETRY_SUPPORT
+   if(g_ctrlm.telemetry != NULL && !entries.empty()) {
+      std::string value = "[";
+      for(auto const &itr : entries) {
+         const ctrlm_main_dispatch_stats_t *stats = itr.second;
+         std::string entry = "[" MARKER_MAIN_DISPATCH_STATS_VERSION ",\"" + itr.first + "\"," + std::to_string(stats->run.count()) + "," +
+                             std::to_string(stats->wait.percentile(50)) + "," + std::to_string(stats->wait.percentile(99)) + "," + std::to_string(stats->wait.max()) + "," +
+                             std::to_string(stats->run.percentile(50))  + "," + std::to_string(stats->run.percentile(99))  + "," + std::to_string(stats->run.max()) + "]";
+         if(value.length() + entry.length() + 2 > CTRLM_TELEMETRY_MAX_EVENT_SIZE_BYTES) {
+            break;
+         }
+         if(value.length() > 1) {
+            value += ",";
+         }
+         value += entry;
+      }
+      value += "]";
+      ctrlm_telemetry_event_t<std::string> marker(MARKER_MAIN_DISPATCH_STATS, value);
+      g_ctrlm.telemetry->event(ctrlm_telemetry_report_t::GLOBAL, marker);
+   }
+#endif
+   // Reset rather than clear so the map nodes are reused in the next interval
+   for(auto &itr : g_ctrlm.dispatch_stats) {
+      itr.second.wait.reset();
+      itr.second.run.reset();
+   }
+}
+
+// Logs the end to end key latency of every remote. For telemetry, the latency is also reported and the reported
+// remotes are reset to start a new interval.
+static void ctrlm_main_key_latency_dump(bool telemetry) {
+   std::string value = "[";
+
+   for(auto const &net : g_ctrlm.networks) {
+      for(auto controller : net.second->get_controller_obj_list()) {
+         const ctrlm_histogram_atomic_t &total = controller->key_latency_get(CTRLM_KEY_LATENCY_STAGE_TOTAL);
+         if(total.count() == 0) {
+            continue;
+         }
+         const ctrlm_histogram_atomic_t &input   = controller->key_latency_get(CTRLM_KEY_LATENCY_STAGE_INPUT);
+         const ctrlm_histogram_atomic_t &queue   = controller->key_latency_get(CTRLM_KEY_LATENCY_STAGE_QUEUE);
+         const ctrlm_histogram_atomic_t &process = controller->key_latency_get(CTRLM_KEY_LATENCY_STAGE_PROCESS);
+         XLOGD_INFO("key latency %s <%s> count <%llu> p50 <%llu> p95 <%llu> p99 <%llu> max <%llu> input p99 <%llu> queue p99 <%llu> process p99 <%llu> (us)", controller->controller_type_str_get().c_str(),
+                    controller->ieee_address_get().to_string().c_str(), total.count(), total.percentile(50), total.percentile(95), total.percentile(99), total.max(),
+                    input.percentile(99), queue.percentile(99), process.percentile(99));
+
+         if(!telemetry) {
+            continue;
+         }
+         std::string entry = "[" MARKER_RCU_KEY_LATENCY_VERSION ",\"" + controller->controller_type_str_get() + "\"," + std::to_string(total.count()) + "," +
+                             std::to_string(total.percentile(50)) + "," + std::to_string(total.percentile(95)) + "," + std::to_string(total.percentile(99)) + "," + std::to_string(total.max()) + "," +
+                             std::to_string(input.percentile(99)) + "," + std::to_string(queue.percentile(99)) + "," + std::to_string(process.percentile(99)) + "]";
+         // A controller that doesn't fit in the marker keeps its samples for the next interval
+         if(value.length() + entry.length() + 2 <= CTRLM_TELEMETRY_MAX_EVENT_SIZE_BYTES) {
+            if(value.length() > 1) {
+               value += ",";
+            }
+            value += entry;
+            controller->key_latency_reset();
+         }
+      }
+   }
+   if(!telemetry) {
+      return;
+   }
+   value += "]";
+#ifdef TELEMETRY_SUPPORT
+   if(g_ctrlm.telemetry != NULL && value.length() > 2) {
+      ctrlm_telemetry_event_t<std::string> marker(MARKER_RCU_KEY_LATENCY, value);
+      g_ctrlm.telemetry->event(ctrlm_telemetry_report_t::GLOBAL, marker);
+   }
+#endif
+}
+
+static gboolean ctrlm_main_dispatch_stats_timeout(gpointer user_data) {
+   ctrlm_main_queue_msg_dispatch_stats_t *msg = (ctrlm_main_queue_msg_dispatch_stats_t *)g_malloc0(sizeof(ctrlm_main_queue_msg_dispatch_stats_t));
+   if(NULL == msg) {
+      XLOGD_ERROR("Out of memory");
+      return(TRUE);
+   }
+   msg->header.type       = CTRLM_MAIN_QUEUE_MSG_TYPE_DISPATCH_STATS;
+   msg->header.network_id = CTRLM_MAIN_NETWORK_ID_ALL;
+   msg->telemetry         = true;
+   ctrlm_main_queue_msg_push(msg);
+   return(TRUE);
+}
+
 gpointer ctrlm_main_thread(gpointer param) {
    bool running = true;
    XLOGD_INFO("Started");
@@ -2390,7 +2838,8 @@ gpointer ctrlm_main_thread(gpointer param) {
 
    XLOGD_AUTOMATION_INFO("Enter main loop");
    do {
-      gpointer msg = g_async_queue_pop(g_ctrlm.queue);
+      unsigned long wait_us = 0;
+      gpointer      msg     = ctrlm_main_queue_msg_pop(&wait_us);
 
       if(msg == NULL) {
          XLOGD_ERROR("NULL message received");
@@ -2399,6 +2848,11 @@ gpointer ctrlm_main_thread(gpointer param) {
 
       ctrlm_main_queue_msg_header_t *hdr = (ctrlm_main_queue_msg_header_t *)msg;
       ctrlm_obj_network_t           *obj_net       = NULL;
+      ctrlm_main_dispatch_key_t      dispatch_key;
+      ctrlm_timestamp_t              dispatch_start;
+
+      ctrlm_main_dispatch_key_get(hdr, &dispatch_key);
+      ctrlm_timestamp_get_monotonic(&dispatch_start);
 
       XLOGD_DEBUG("Type <%s> Network Id %u", ctrlm_main_queue_msg_type_str(hdr->type), hdr->network_id);
       if(0 == (hdr->type & CTRLM_MAIN_QUEUE_MSG_TYPE_GLOBAL)) { // Network specific message
@@ -2430,6 +2884,24 @@ gpointer ctrlm_main_thread(gpointer param) {
             *thread_monitor_msg->response = CTRLM_THREAD_MONITOR_RESPONSE_ALIVE;
             break;
          }
+         case CTRLM_MAIN_QUEUE_MSG_TYPE_DISPATCH_STATS: {
+            ctrlm_main_queue_msg_dispatch_stats_t *dqm = (ctrlm_main_queue_msg_dispatch_stats_t *)msg;
+            XLOGD_DEBUG("message type CTRLM_MAIN_QUEUE_MSG_TYPE_DISPATCH_STATS");
+            ctrlm_main_dispatch_stats_dump(dqm->telemetry);
+            ctrlm_main_key_latency_dump(dqm->telemetry);
+            if(!dqm->telemetry && g_ctrlm.voice_session != NULL) {
+               g_ctrlm.voice_session->voice_session_timeline_export(CTRLM_VOICE_TIMELINE_EXPORT_FILE);
+            }
+            break;
+         }
+         #if CTRLM_HAL_RF4CE_API_VERSION >= 9
+         case CTRLM_MAIN_QUEUE_MSG_TYPE_BACKUP_COMPLETE: {
+            ctrlm_main_queue_msg_backup_complete_t *dqm = (ctrlm_main_queue_msg_backup_complete_t *)msg;
+            XLOGD_INFO("message type CTRLM_MAIN_QUEUE_MSG_TYPE_BACKUP_COMPLETE");
+            ctrlm_backup_data_end(dqm->success);
+            break;
+         }
+         #endif
          case CTRLM_MAIN_QUEUE_MSG_TYPE_TERMINATE: {
             XLOGD_INFO("message type CTRLM_MAIN_QUEUE_MSG_TYPE_TERMINATE");
             sem_post(&g_ctrlm.semaphore);
@@ -3179,8 +3651,11 @@ gpointer ctrlm_main_thread(gpointer param) {
             break;
          }
       }
+      ctrlm_main_dispatch_stats_add(&dispatch_key, wait_us, &dispatch_start);
       ctrlm_queue_msg_destroy(msg);
    } while(running);
+   XLOGD_INFO("queue messages: slot <%lu> heap <%lu>", g_ctrlm.queue_slot_alloc_qty.load(), g_ctrlm.queue_heap_alloc_qty.load());
+   ctrlm_main_queue_stats_log(false);
    return(NULL);
 }
 
@@ -5775,31 +6250,75 @@ void ctrlm_crash_recovery_check() {
 }
 
 void ctrlm_backup_data() {
-
-#if ( __GLIBC__ == 2 ) && ( __GLIBC_MINOR__ >= 20 )
-   gint64 t;
-#else
-   GTimeVal t;
+#ifdef CTRLM_NETWORK_HAS_HAL_NVM
+   remove(HAL_NVM_BACKUP_TMP); // Left over from an interrupted backup
 #endif
-   // Back up network NVM files
+
+   // Back up network NVM files.  These are written to a temporary file which only replaces the previous backup once
+   // the ctrlm db backup has completed too.
    for(auto const &itr : g_ctrlm.networks) {
       if(itr.second->type_get() == CTRLM_NETWORK_TYPE_RF4CE) {
          if(FALSE == itr.second->backup_hal_nvm()) {
-            XLOGD_ERROR("Failed to back up RF4CE HAL NVM");
+            XLOGD_ERROR("Failed to back up RF4CE HAL NVM, keeping previous backup");
+#ifdef CTRLM_NETWORK_HAS_HAL_NVM
+            remove(HAL_NVM_BACKUP_TMP);
+#endif
             return;
          }
       }
    }
 
-   // Back up ctrlm db
-   if(FALSE == ctrlm_db_backup()) {
-      ctrlm_file_delete(CTRLM_NVM_BACKUP, true);
+   // Back up ctrlm db.  This is done in the background by the database thread and finished on the main thread.
+   if(false == ctrlm_db_backup(ctrlm_backup_data_db_complete, NULL)) {
+      ctrlm_backup_data_end(false);
+   }
+}
+
+// Called from the database thread.  The result is handed to the main thread which owns the recovery component.
+void ctrlm_backup_data_db_complete(bool success, void *user_data) {
+   ctrlm_main_queue_msg_backup_complete_t *msg = (ctrlm_main_queue_msg_backup_complete_t *)g_malloc0(sizeof(ctrlm_main_queue_msg_backup_complete_t));
+
+   msg->header.type       = CTRLM_MAIN_QUEUE_MSG_TYPE_BACKUP_COMPLETE;
+   msg->header.network_id = CTRLM_MAIN_NETWORK_ID_ALL;
+   msg->success           = success;
+
+   ctrlm_main_queue_msg_push(msg);
+}
+
+// Recovery values are only reset once both backups are in place so that a crash while the backup is being made
+// still counts towards restoring the previous backup.  On failure the previous backups are left untouched.
+void ctrlm_backup_data_end(bool success) {
 #ifdef CTRLM_NETWORK_HAS_HAL_NVM
-      remove(HAL_NVM_BACKUP);
+   if(success && 0 != rename(HAL_NVM_BACKUP_TMP, HAL_NVM_BACKUP) && errno != ENOENT) { // ENOENT: HAL NVM backup was unchanged
+      int errsv = errno;
+      XLOGD_ERROR("Failed to replace HAL NVM backup <%s>", strerror(errsv));
+      success = false;
+   }
+   if(!success) {
+      remove(HAL_NVM_BACKUP_TMP);
+   }
 #endif
+   if(!success) {
+      XLOGD_ERROR("Backup failed, keeping previous backup");
+      return;
+   }
+   if(!ctrlm_backup_data_timestamps_set()) {
+      // Timestamps that do not match cause recovery to refuse the backup, so nothing needs to be removed
+      XLOGD_ERROR("Failed to set backup timestamps");
       return;
    }
-glong tv_sec = 0;
+
+   // Terminate recovery component and reset all values
+   ctrlm_recovery_terminate(true);
+}
+
+bool ctrlm_backup_data_timestamps_set() {
+#if ( __GLIBC__ == 2 ) && ( __GLIBC_MINOR__ >= 20 )
+   gint64 t;
+#else
+   GTimeVal t;
+#endif
+   glong tv_sec = 0;
    // Get timestamps so we know backup data is consistent
 #if ( __GLIBC__ == 2 ) && ( __GLIBC_MINOR__ >= 20 )
    t = g_get_real_time ();
@@ -5810,19 +6329,14 @@ glong tv_sec = 0;
 #endif
 #ifdef CTRLM_NETWORK_HAS_HAL_NVM
    if(FALSE == ctrlm_file_timestamp_set(HAL_NVM_BACKUP, tv_sec)) {
-      ctrlm_file_delete(CTRLM_NVM_BACKUP, true);
-      remove(HAL_NVM_BACKUP);
-      return;
+      return(false);
    }
 #endif
 
    if(FALSE == ctrlm_file_timestamp_set(CTRLM_NVM_BACKUP, tv_sec)) {
-      ctrlm_file_delete(CTRLM_NVM_BACKUP, true);
-#ifdef CTRLM_NETWORK_HAS_HAL_NVM
-      remove(HAL_NVM_BACKUP);
-#endif
-      return;
+      return(false);
    }
+   return(true);
 }
 #endif
 
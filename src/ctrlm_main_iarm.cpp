@@ -687,7 +687,7 @@ IARM_Result_t ctrlm_main_iarm_call_voice_session_begin(void *arg) {
    msg.params->result    = CTRLM_IARM_CALL_RESULT_ERROR;
    msg.semaphore         = &semaphore;
 
-   ctrlm_main_queue_handler_push(CTRLM_HANDLER_NETWORK, (ctrlm_msg_handler_network_t)&ctrlm_obj_network_t::req_process_voice_session_begin, &msg, sizeof(msg), NULL, params->network_id);
+   ctrlm_main_queue_handler_push_priority(CTRLM_MAIN_QUEUE_PRIORITY_INTERACTIVE, CTRLM_HANDLER_NETWORK, (ctrlm_msg_handler_network_t)&ctrlm_obj_network_t::req_process_voice_session_begin, &msg, sizeof(msg), NULL, params->network_id);
 
    // Wait for the result semaphore to be signaled
    sem_wait(&semaphore);
@@ -728,7 +728,7 @@ IARM_Result_t ctrlm_main_iarm_call_voice_session_end(void *arg) {
    msg.params->result    = CTRLM_IARM_CALL_RESULT_ERROR;
    msg.semaphore         = &semaphore;
 
-   ctrlm_main_queue_handler_push(CTRLM_HANDLER_NETWORK, (ctrlm_msg_handler_network_t)&ctrlm_obj_network_t::req_process_voice_session_end, &msg, sizeof(msg), NULL, params->network_id);
+   ctrlm_main_queue_handler_push_priority(CTRLM_MAIN_QUEUE_PRIORITY_INTERACTIVE, CTRLM_HANDLER_NETWORK, (ctrlm_msg_handler_network_t)&ctrlm_obj_network_t::req_process_voice_session_end, &msg, sizeof(msg), NULL, params->network_id);
 
    // Wait for the result semaphore to be signaled
    sem_wait(&semaphore);
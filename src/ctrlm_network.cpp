@@ -733,6 +733,9 @@ void ctrlm_obj_network_t::req_process_get_rcu_status(void *data, int size){
    }
 
    net_status.set_result(result);
+   if(result == CTRLM_IARM_CALL_RESULT_SUCCESS) {
+      ctrlm_main_rcu_status_publish(net_status);
+   }
    dqm->params->set_result(result, network_id_get());
    dqm->params->set_reply(net_status, network_id_get());
 
@@ -1020,10 +1023,14 @@ ctrlm_rf_pair_state_t ctrlm_obj_network_t::get_rf_pair_state() const {
 void ctrlm_obj_network_t::iarm_event_rcu_status(void) {
    XLOGD_DEBUG("Enter...");
 
-   #ifdef CTRLM_THUNDER
    ctrlm_rcp_ipc_net_status_t msg;
    msg.populate_status(*this);
+   msg.set_result(CTRLM_IARM_CALL_RESULT_SUCCESS);
 
+   // Status getters read the published snapshot instead of queueing a request to the main thread
+   ctrlm_main_rcu_status_publish(msg);
+
+   #ifdef CTRLM_THUNDER
    XLOGD_INFO("Broadcasting IARM message %s RCU Status....", name_get());
    XLOGD_DEBUG("%s", msg.to_string());
 
@@ -25,6 +25,7 @@
 #define CTRLM_NVM_BACKUP                  "/opt/ctrlm.back"
 #ifdef CTRLM_NETWORK_HAS_HAL_NVM
 #define HAL_NVM_BACKUP                    "/opt/hal_nvm.back"
+#define HAL_NVM_BACKUP_TMP                HAL_NVM_BACKUP ".tmp" // replaces the backup once the ctrlm DB is backed up too
 #endif
 
 typedef enum {
@@ -0,0 +1,124 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+#ifndef _CTRLM_RING_H_
+#define _CTRLM_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Bounded lock-free ring buffer. Any number of threads may push and pop concurrently.
+// Each cell carries a sequence number that tells producers and consumers whether it is
+// free or holds a published item, so no thread ever takes a lock. The capacity is
+// rounded up to a power of two and fixed at construction.
+template <typename T>
+class ctrlm_ring_t {
+public:
+    explicit ctrlm_ring_t(size_t capacity) {
+        size_t size = 2;
+        while(size < capacity) {
+            size <<= 1;
+        }
+        m_mask  = size - 1;
+        m_cells = new cell_t[size];
+        for(size_t i = 0; i < size; i++) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        m_enqueue_pos.store(0, std::memory_order_relaxed);
+        m_dequeue_pos.store(0, std::memory_order_relaxed);
+    }
+
+    ~ctrlm_ring_t() {
+        delete [] m_cells;
+    }
+
+    ctrlm_ring_t(const ctrlm_ring_t &) = delete;
+    ctrlm_ring_t &operator=(const ctrlm_ring_t &) = delete;
+
+    // Returns false if the ring is full
+    bool push(const T &item) {
+        cell_t *cell;
+        size_t  pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        for(;;) {
+            cell = &m_cells[pos & m_mask];
+            size_t   seq  = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if(diff == 0) {
+                if(m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if(diff < 0) {
+                return(false);
+            } else {
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->item = item;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return(true);
+    }
+
+    // Returns false if the ring is empty or the item at the head has been claimed but not yet published
+    bool pop(T &item) {
+        cell_t *cell;
+        size_t  pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        for(;;) {
+            cell = &m_cells[pos & m_mask];
+            size_t   seq  = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if(diff == 0) {
+                if(m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if(diff < 0) {
+                return(false);
+            } else {
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        item = cell->item;
+        cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return(true);
+    }
+
+    // Approximate number of items in the ring
+    size_t size() const {
+        size_t enqueue_pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        size_t dequeue_pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        return((enqueue_pos > dequeue_pos) ? (enqueue_pos - dequeue_pos) : 0);
+    }
+
+    size_t capacity() const {
+        return(m_mask + 1);
+    }
+
+private:
+    struct cell_t {
+        std::atomic<size_t> sequence;
+        T                   item;
+    };
+
+    cell_t *                        m_cells;
+    size_t                          m_mask;
+    alignas(64) std::atomic<size_t> m_enqueue_pos;
+    alignas(64) std::atomic<size_t> m_dequeue_pos;
+};
+
+#endif
@@ -360,6 +360,8 @@ const char *ctrlm_main_queue_msg_type_str(ctrlm_main_queue_msg_type_t type) {
       case CTRLM_MAIN_QUEUE_MSG_TYPE_MAIN_CONTROL_SERVICE_START_PAIRING_MODE: return("CONTROL_SERVICE_START_PAIRING_MODE");
       case CTRLM_MAIN_QUEUE_MSG_TYPE_MAIN_CONTROL_SERVICE_END_PAIRING_MODE:   return("CONTROL_SERVICE_END_PAIRING_MODE");
       case CTRLM_MAIN_QUEUE_MSG_TYPE_EXPORT_CONTROLLER_LIST:                  return("EXPORT_CONTROLLER_LIST");
+      case CTRLM_MAIN_QUEUE_MSG_TYPE_DISPATCH_STATS:                          return("DISPATCH_STATS");
+      case CTRLM_MAIN_QUEUE_MSG_TYPE_BACKUP_COMPLETE:                         return("BACKUP_COMPLETE");
       default: if (type >= CTRLM_MAIN_QUEUE_MSG_TYPE_VENDOR_FIRST && type <= CTRLM_MAIN_QUEUE_MSG_TYPE_VENDOR_LAST) {
          return("VENDOR SPECIFIC MESSAGE");
       }
@@ -367,6 +369,15 @@ const char *ctrlm_main_queue_msg_type_str(ctrlm_main_queue_msg_type_t type) {
    return(ctrlm_invalid_return(type));
 }
 
+const char *ctrlm_main_queue_priority_str(ctrlm_main_queue_priority_t priority) {
+   switch(priority) {
+      case CTRLM_MAIN_QUEUE_PRIORITY_INTERACTIVE: return("INTERACTIVE");
+      case CTRLM_MAIN_QUEUE_PRIORITY_BACKGROUND:  return("BACKGROUND");
+      case CTRLM_MAIN_QUEUE_PRIORITY_QTY:         break;
+   }
+   return(ctrlm_invalid_return(priority));
+}
+
 const char *ctrlm_controller_status_cmd_result_str(ctrlm_controller_status_cmd_result_t result) {
    switch(result) {
       case CTRLM_CONTROLLER_STATUS_REQUEST_PENDING: return("PENDING");
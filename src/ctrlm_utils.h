@@ -160,6 +160,7 @@ void ctrlm_print_data_hex(const char *prefix, guchar *data, unsigned int length,
 void ctrlm_print_controller_status(const char *prefix, ctrlm_controller_status_t *status);
 
 const char *ctrlm_main_queue_msg_type_str(ctrlm_main_queue_msg_type_t type);
+const char *ctrlm_main_queue_priority_str(ctrlm_main_queue_priority_t priority);
 const char *ctrlm_controller_status_cmd_result_str(ctrlm_controller_status_cmd_result_t result);
 
 uint16_t ctrlm_key_code_to_linux_key(ctrlm_key_code_t code);
@@ -26,6 +26,8 @@
 #include <sstream>
 #include <fstream>
 #include <vector>
+#include <map>
+#include <mutex>
 #include <semaphore.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -57,6 +59,9 @@ using namespace std;
 #define CTRLM_DB_TABLE_NET_BLE_CONTROLLER_LIST    "ble_%02X_controller_list"     // Controller list for an IP network, one per IP network
 #define CTRLM_DB_TABLE_NET_BLE_CONTROLLER_ENTRY   "ble_%02X_controller_%02X"     // IP Controller table, one per controller
 #define CTRLM_DB_TABLE_NET_BLE                    "ble_%02X"
+#define CTRLM_DB_TABLE_NET_RF4CE_CONTROLLER_ATTR  "rf4ce_controller_attr"       // Attributes of all RF4CE controllers, replaces the controller entry tables
+#define CTRLM_DB_TABLE_NET_IP_CONTROLLER_ATTR     "ip_controller_attr"          // Attributes of all IP controllers, replaces the controller entry tables
+#define CTRLM_DB_TABLE_NET_BLE_CONTROLLER_ATTR    "ble_controller_attr"         // Attributes of all BLE controllers, replaces the controller entry tables
 #define CTRLM_DB_TABLE_TARGET_IRDB_STATUS         "target_irdb_status"
 #define CTRLM_DB_IR_REMOTE_USAGE                  "ir_remote_usage"
 #define CTRLM_DB_PAIRING_METRICS                  "pairing_metrics"
@@ -82,9 +87,17 @@ using namespace std;
 #define CONTROLLER_TABLE_NAME_MAX_LEN        (32)
 #define CONTROLLER_KEY_NAME_MAX_LEN          (40)
 
-#define CTRLM_DB_VERSION                           "1"
+#define CTRLM_DB_VERSION                           "2"   // 2 - controller entry tables are consolidated into one attribute table per network type
+#define CTRLM_DB_VERSION_CONTROLLER_ATTR           (2)
 #define CTRLM_DB_DEVICE_UPDATE_SESSION_ID_DEFAULT  (0)
 
+#define CTRLM_DB_TRANSACTION_MSG_QTY_MAX           (256) // Upper bound on queued writes grouped into a single transaction
+#define CTRLM_DB_STATS_REPORT_INTERVAL_SECS        (900)
+#define CTRLM_DB_COALESCE_LATENCY_MS               (2000) // Maximum time a coalesced write is held before being written
+#define CTRLM_DB_BACKUP_PAGES_PER_STEP             (32)    // Pages copied per backup slice, queued messages are handled between slices
+#define CTRLM_DB_OPEN_MARKER_SUFFIX                ".open" // Present while the database is in use, so it is found at boot after an unclean shutdown
+#define CTRLM_DB_INTEGRITY_CHECK_DELAY_SECS        (600)   // Delay before the full integrity check after a boot that only ran the quick check
+
 typedef enum {
    // Network based messages
    CTRLM_DB_QUEUE_MSG_TYPE_WRITE_UINT64       = 0,
@@ -96,7 +109,7 @@ typedef enum {
    CTRLM_DB_QUEUE_MSG_TYPE_CONTROLLER_CREATE  = 6,
    CTRLM_DB_QUEUE_MSG_TYPE_BACKUP             = 7,
    CTRLM_DB_QUEUE_MSG_TYPE_POWER_STATE_CHANGE = 8,
-   CTRLM_DB_QUEUE_MSG_TYPE_WRITE_ATTR         = 9,
+   CTRLM_DB_QUEUE_MSG_TYPE_INTEGRITY_CHECK    = 10,
    CTRLM_DB_QUEUE_MSG_TYPE_TICKLE             = CTRLM_MAIN_QUEUE_MSG_TYPE_TICKLE
 } ctrlm_db_queue_msg_type_t;
 
@@ -126,11 +139,6 @@ typedef struct {
    guint32                     length;
 } ctrlm_db_queue_msg_write_blob_t;
 
-typedef struct {
-   ctrlm_db_queue_msg_header_t header;
-   std::weak_ptr<ctrlm_db_attr_t> attr;
-} ctrlm_db_queue_msg_write_attr_t;
-
 typedef struct {
    ctrlm_db_queue_msg_header_t header;
    char *                      path;
@@ -146,7 +154,8 @@ typedef struct {
 
 typedef struct {
    ctrlm_db_queue_msg_header_t header;
-   bool *                      ret;
+   ctrlm_db_backup_cb_t        cb;
+   void *                      user_data;
 } ctrlm_db_queue_msg_backup_t;
 
 typedef struct {
@@ -154,10 +163,62 @@ typedef struct {
    gboolean                    waking_up;
 } ctrlm_db_queue_msg_power_state_change_t;
 
+typedef struct {
+   unsigned long long         statements;  // write statements executed
+   unsigned long long         commits;     // transactions committed
+   unsigned long long         coalesced;   // writes eliminated because a newer value for the same key was queued
+   ctrlm_timestamp_t          start;
+} ctrlm_db_stats_t;
+
+typedef struct {
+   sqlite3 *                  dest;
+   sqlite3_backup *           handle;
+   ctrlm_db_backup_cb_t       cb;
+   void *                     user_data;
+   unsigned long              steps;
+   ctrlm_timestamp_t          start;
+   std::string                path;     // file the backup replaces once it is complete
+   std::string                path_tmp; // file the backup is copied into
+} ctrlm_db_backup_t;
+
+typedef std::pair<std::string, ctrlm_db_stmt_type_t> ctrlm_db_stmt_key_t;
+
+// A cached statement and the lock held by the thread using it.  The statement is finalized when the last reference is
+// dropped so a purge doesn't have to wait for statements that are in use.
+struct ctrlm_db_stmt_entry_t {
+   sqlite3_stmt *             stmt;
+   std::mutex                 mutex;
+
+   ctrlm_db_stmt_entry_t(sqlite3_stmt *p_stmt) : stmt(p_stmt) {}
+   ~ctrlm_db_stmt_entry_t() { sqlite3_finalize(stmt); }
+};
+typedef std::shared_ptr<ctrlm_db_stmt_entry_t> ctrlm_db_stmt_entry_ptr_t;
+typedef std::pair<std::string, std::string>          ctrlm_db_value_key_t;    // lower case table, key
+typedef ctrlm_db_value_key_t                         ctrlm_db_coalesce_key_t; // lower case table, key
+
 typedef struct {
    sqlite3 *                  handle;
    gboolean                   created_default_db;
 
+   std::mutex                                              stmt_mutex;   // protects the cache and stats, not the statements
+   std::map<ctrlm_db_stmt_key_t, ctrlm_db_stmt_entry_ptr_t> stmt_cache;
+   bool                       transaction_active;
+   guint32                    transaction_msg_qty;
+   ctrlm_db_stats_t           stats;
+
+   std::mutex                                  coalesce_mutex;
+   std::map<ctrlm_db_coalesce_key_t, gpointer> coalesce_pending;
+   std::map<ctrlm_db_coalesce_key_t, gpointer> coalesce_flushing; // being written by the db thread, still visible to readers
+   ctrlm_timestamp_t                           coalesce_oldest;   // monotonic
+
+   ctrlm_db_backup_t          backup;
+
+   std::mutex                                      value_cache_mutex;
+   std::map<ctrlm_db_value_key_t, sqlite3_value *> value_cache;
+   bool                                            value_cache_valid;  // all tables are cached so a key that isn't found is not in the database
+   unsigned long long                              value_cache_hits;
+   unsigned long long                              value_cache_misses;
+
    GThread *                  main_thread;
    GAsyncQueue *              queue;
    sem_t                      semaphore;
@@ -171,6 +232,10 @@ typedef struct {
    vector<ctrlm_network_id_t> ble_network_list;
 
    bool                       voice_is_valid;
+
+   std::string                open_marker;
+   guint                      integrity_check_tag;
+   bool                       integrity_check_full_next_boot;
 } ctrlm_db_global_t;
 
 typedef struct {
@@ -181,6 +246,20 @@ typedef struct {
 ctrlm_db_global_t      g_ctrlm_db;
 ctrlm_db_global_data_t g_ctrlm_db_global;
 
+// Statements acquired by this thread, so release can find the entry without taking the cache lock
+static thread_local std::map<sqlite3_stmt *, ctrlm_db_stmt_entry_ptr_t> g_ctrlm_db_stmt_held;
+
+#define CTRLM_DB_CONTROLLER_ATTR_TABLE_QTY (3)
+
+static const struct {
+   const char *prefix;     // prefix of the controller entry table names
+   const char *attr_table;
+} g_ctrlm_db_controller_attr_tables[CTRLM_DB_CONTROLLER_ATTR_TABLE_QTY] = {
+   { "rf4ce_", CTRLM_DB_TABLE_NET_RF4CE_CONTROLLER_ATTR },
+   { "ip_",    CTRLM_DB_TABLE_NET_IP_CONTROLLER_ATTR    },
+   { "ble_",   CTRLM_DB_TABLE_NET_BLE_CONTROLLER_ATTR   },
+};
+
 static bool     ctrlm_db_open(const char *db_path);
 static void     ctrlm_db_close();
 static bool     ctrlm_db_is_initialized();
@@ -188,11 +267,33 @@ static void     ctrlm_db_default();
 static void     ctrlm_db_default_networks();
 static void     ctrlm_db_print();
 static int      ctrlm_db_integrity_check_result(void *param, int argc, char **argv, char **column);
-static bool     ctrlm_db_verify_integrity();
+static bool     ctrlm_db_verify_integrity(bool full);
+static gboolean ctrlm_db_integrity_check_timeout(gpointer user_data);
 static bool     ctrlm_db_vacuum();
+static void     ctrlm_db_backup_begin(ctrlm_db_backup_cb_t cb, void *user_data);
+static void     ctrlm_db_backup_step();
+static void     ctrlm_db_backup_end(bool success);
 static void     ctrlm_db_cache();
 static gpointer ctrlm_db_thread(gpointer param);
 static void     ctrlm_db_queue_msg_destroy(gpointer msg);
+static bool     ctrlm_db_queue_msg_is_write(ctrlm_db_queue_msg_type_t type);
+static void     ctrlm_db_queue_msg_write(gpointer msg);
+
+static bool     ctrlm_db_coalesce_add(gpointer msg);
+static void     ctrlm_db_coalesce_flush();
+static bool     ctrlm_db_coalesce_read(const char *table, const char *key, int *value_int, sqlite_uint64 *value_int64, guchar **value_str, guint32 *value_len, int *retval);
+static bool     ctrlm_db_coalesce_contains(const char *table, const char *key);
+static void     ctrlm_db_coalesce_remove(const char *table, const char *key, bool pattern);
+static unsigned long long ctrlm_db_coalesce_elapsed_ms();
+static bool     ctrlm_db_coalesce_read_msg(gpointer msg, int *value_int, sqlite_uint64 *value_int64, guchar **value_str, guint32 *value_len, int *retval);
+static int      ctrlm_db_coalesce_bind_msg(gpointer msg, sqlite3_stmt *p_stmt, int index);
+static gpointer ctrlm_db_coalesce_find(const char *table, const char *key);
+
+static ctrlm_db_stmt_entry_ptr_t ctrlm_db_stmt_prepare(const char *table, ctrlm_db_stmt_type_t type, bool attr);
+static void     ctrlm_db_stmt_cache_purge(const char *table);
+static void     ctrlm_db_transaction_begin();
+static void     ctrlm_db_transaction_commit();
+static void     ctrlm_db_stats_report(bool force);
 
 static const char *ctrlm_db_errmsg(int rc);
 
@@ -226,6 +327,15 @@ static int  ctrlm_db_select_keys(const char *table, vector<char *> *keys_str, ve
 
 static void ctrlm_db_controller_destroy(ctrlm_network_id_t network_id, ctrlm_controller_id_t controller_id);
 static void ctrlm_db_controller_create(ctrlm_network_id_t network_id, ctrlm_controller_id_t controller_id);
+static bool ctrlm_db_controller_attr_table(const char *table, const char **attr_table, ctrlm_network_id_t *network_id, ctrlm_controller_id_t *controller_id);
+static void ctrlm_db_controller_attr_table_create(const char *attr_table);
+static int  ctrlm_db_table_list_result(void *param, int argc, char **argv, char **column);
+static bool ctrlm_db_controller_attr_migrate();
+static ctrlm_db_value_key_t ctrlm_db_value_cache_key(const char *table, const char *key);
+static void ctrlm_db_value_cache_fill();
+static void ctrlm_db_value_cache_clear();
+static void ctrlm_db_value_cache_remove(const char *table, const char *key, bool pattern=false);
+static void ctrlm_db_value_cache_remove_table(const char *table);
 
 // Read/write functions that will get exposed to outside world
 static void ctrlm_db_read_globals(ctrlm_db_global_data_t *db);
@@ -242,7 +352,7 @@ static void ctrlm_db_ble_global_table_name(ctrlm_network_id_t network_id, char *
 static void ctrlm_db_ble_controller_list_table_name(ctrlm_network_id_t network_id, char *table);
 static void ctrlm_db_ble_controller_entry_table_name(ctrlm_network_id_t network_id, ctrlm_controller_id_t controller_id, char *table);
 static void ctrlm_db_ble_network_create(ctrlm_network_id_t network_id);
-static void ctrlm_db_delete_legacy_entries(void);
+static bool ctrlm_db_delete_legacy_entries(void);
 
 bool ctrlm_db_open(const char *db_path) {
    int rc;
@@ -274,13 +384,38 @@ bool ctrlm_db_open(const char *db_path) {
 
 void ctrlm_db_close() {
    if(g_ctrlm_db.handle != NULL) {
-      sqlite3_close(g_ctrlm_db.handle);
+      // A backup in progress holds a reference to the source connection
+      if(g_ctrlm_db.backup.handle != NULL) {
+         XLOGD_WARN("database closed during backup");
+         ctrlm_db_backup_end(false);
+      }
+      // Cached statements must be finalized before the handle can be closed.  A statement still in use by another thread
+      // is finalized when it is released, close_v2 defers freeing the connection until then.
+      ctrlm_db_stmt_cache_purge(NULL);
+      sqlite3_close_v2(g_ctrlm_db.handle);
       g_ctrlm_db.handle = NULL;
    }
 }
 
 gboolean ctrlm_db_init(const char *db_path) {
-   g_ctrlm_db.created_default_db = false;
+   ctrlm_timestamp_t init_start;
+   ctrlm_timestamp_get_monotonic(&init_start);
+
+   g_ctrlm_db.backup.dest      = NULL;
+   g_ctrlm_db.backup.handle    = NULL;
+   g_ctrlm_db.backup.cb        = NULL;
+   g_ctrlm_db.backup.user_data = NULL;
+
+   g_ctrlm_db.created_default_db  = false;
+   g_ctrlm_db.transaction_active  = false;
+   g_ctrlm_db.transaction_msg_qty = 0;
+   g_ctrlm_db.stats.statements    = 0;
+   g_ctrlm_db.stats.commits       = 0;
+   g_ctrlm_db.stats.coalesced     = 0;
+   ctrlm_timestamp_get(&g_ctrlm_db.stats.start);
+   g_ctrlm_db.value_cache_valid   = false;
+   g_ctrlm_db.value_cache_hits    = 0;
+   g_ctrlm_db.value_cache_misses  = 0;
    g_ctrlm_db.deepsleep_close_db = true; // Default to true.  This can be overridden by vendor layer config as required in the future.
 
    if(g_ctrlm_db.deepsleep_close_db) {
@@ -289,30 +424,59 @@ gboolean ctrlm_db_init(const char *db_path) {
       sem_init(&g_ctrlm_db.ds_signal, 0, 0);
    }
 
+   // The marker is left behind if the process doesn't terminate cleanly
+   g_ctrlm_db.open_marker                    = std::string(db_path) + CTRLM_DB_OPEN_MARKER_SUFFIX;
+   g_ctrlm_db.integrity_check_tag            = 0;
+   g_ctrlm_db.integrity_check_full_next_boot = false;
+   bool unclean_shutdown = ctrlm_file_exists(g_ctrlm_db.open_marker.c_str());
+
    // check for presence of database file and if not present, create it
    if(false == ctrlm_db_open(db_path)) {
        return(FALSE);
    }
    ctrlm_db_cache();
 
-   // Verify the integrity of the database
-   if(!ctrlm_db_verify_integrity()) {
+   // Verify the integrity of the database.  The full check reads every page so it is only done at boot after an unclean
+   // shutdown, otherwise the quick check is used and the full check is run later from the database thread.
+   bool recache = false;
+   if(!ctrlm_db_verify_integrity(unclean_shutdown)) {
       XLOGD_TELEMETRY("Database is corrupt. Try to recover...");
-      if (ctrlm_db_vacuum() && ctrlm_db_verify_integrity()) {
+      if (ctrlm_db_vacuum() && ctrlm_db_verify_integrity(true)) {
          XLOGD_ERROR("Database recovery succeeded....");
+         recache = true;
       } else {
          XLOGD_ERROR("Database recovery failed....");
          sqlite3_close(g_ctrlm_db.handle);
          sqlite3_shutdown();
       return(FALSE);
       }
+   } else if(!unclean_shutdown) {
+      g_ctrlm_db.integrity_check_tag = ctrlm_timeout_create(CTRLM_DB_INTEGRITY_CHECK_DELAY_SECS * 1000, ctrlm_db_integrity_check_timeout, NULL);
    }
 
-   ctrlm_db_delete_legacy_entries();
-   ctrlm_db_cache();
+   if(ctrlm_db_delete_legacy_entries()) {
+      recache = true;
+   }
+   if(recache) {
+      ctrlm_db_cache();
+   }
+
+   if(g_ctrlm_db_global.version < CTRLM_DB_VERSION_CONTROLLER_ATTR) {
+      XLOGD_INFO("migrate database from version %u", g_ctrlm_db_global.version);
+      if(ctrlm_db_controller_attr_migrate()) {
+         ctrlm_db_read_globals(&g_ctrlm_db_global);
+      }
+   }
+
+   // From here on reads are served from memory and the database thread keeps the cache up to date as it writes
+   ctrlm_db_value_cache_fill();
 
    ctrlm_db_print();
 
+   if(!g_file_set_contents(g_ctrlm_db.open_marker.c_str(), "", 0, NULL)) {
+      XLOGD_WARN("unable to create marker <%s>", g_ctrlm_db.open_marker.c_str());
+   }
+
    // Launch a thread to handle DB writes asynchronously
    // Create an asynchronous queue to receive incoming messages from the networks
    g_ctrlm_db.queue = g_async_queue_new_full(ctrlm_db_queue_msg_destroy);
@@ -326,12 +490,18 @@ gboolean ctrlm_db_init(const char *db_path) {
    XLOGD_INFO("Waiting for database thread initialization...");
    sem_wait(&g_ctrlm_db.semaphore);
 
+   ctrlm_timestamp_t init_end;
+   ctrlm_timestamp_get_monotonic(&init_end);
+   XLOGD_INFO("database init took <%lld> ms with %s", ctrlm_timestamp_subtract_ms(init_start, init_end), unclean_shutdown ? "integrity_check after unclean shutdown" : "quick_check");
+
    return(TRUE);
 }
 
 void ctrlm_db_terminate(void) {
    XLOGD_INFO("clean up");
 
+   ctrlm_timeout_destroy(&g_ctrlm_db.integrity_check_tag);
+
    if(g_ctrlm_db.main_thread != NULL) {
 
       ctrlm_db_queue_msg_header_t *msg = (ctrlm_db_queue_msg_header_t *)g_malloc(sizeof(ctrlm_db_queue_msg_header_t));
@@ -366,6 +536,12 @@ void ctrlm_db_terminate(void) {
 
    ctrlm_db_close();
    sqlite3_shutdown();
+   ctrlm_db_value_cache_clear();
+
+   // Keep the marker if the background check failed so the next boot runs the full check
+   if(!g_ctrlm_db.integrity_check_full_next_boot && !g_ctrlm_db.open_marker.empty()) {
+      ctrlm_file_delete(g_ctrlm_db.open_marker.c_str(), false);
+   }
 }
 
 void ctrlm_db_queue_msg_push(gpointer msg) {
@@ -383,19 +559,145 @@ void ctrlm_db_queue_msg_destroy(gpointer msg) {
    }
 }
 
-bool ctrlm_db_backup() {
-   bool ret                         = FALSE;
+// Messages which only modify the database and can be grouped into a single transaction
+bool ctrlm_db_queue_msg_is_write(ctrlm_db_queue_msg_type_t type) {
+   switch(type) {
+      case CTRLM_DB_QUEUE_MSG_TYPE_WRITE_UINT64:
+      case CTRLM_DB_QUEUE_MSG_TYPE_WRITE_STRING:
+      case CTRLM_DB_QUEUE_MSG_TYPE_WRITE_BLOB:
+      case CTRLM_DB_QUEUE_MSG_TYPE_CONTROLLER_DESTROY:
+      case CTRLM_DB_QUEUE_MSG_TYPE_CONTROLLER_CREATE: {
+         return(true);
+      }
+      default: {
+         break;
+      }
+   }
+   return(false);
+}
+
+// The backup is copied by the database thread a slice at a time, the callback is invoked from that thread when it ends
+bool ctrlm_db_backup(ctrlm_db_backup_cb_t cb, void *user_data) {
    ctrlm_db_queue_msg_backup_t *msg = (ctrlm_db_queue_msg_backup_t *)g_malloc(sizeof(ctrlm_db_queue_msg_backup_t));
    if(msg == NULL) {
       XLOGD_ERROR("Out of memory");
-      return ret;
+      return(false);
    }
    msg->header.type = CTRLM_DB_QUEUE_MSG_TYPE_BACKUP;
-   msg->ret         = &ret;
+   msg->cb          = cb;
+   msg->user_data   = user_data;
    ctrlm_db_queue_msg_push((gpointer)msg);
-   sem_wait(&g_ctrlm_db.semaphore);
-   return ret;
-} 
+   return(true);
+}
+
+void ctrlm_db_backup_begin(ctrlm_db_backup_cb_t cb, void *user_data) {
+   if(g_ctrlm_db.backup.handle != NULL) {
+      XLOGD_WARN("backup already in progress");
+      if(cb) {
+         (*cb)(false, user_data);
+      }
+      return;
+   }
+   if(g_ctrlm_db.handle == NULL) {
+      XLOGD_ERROR("database is closed");
+      if(cb) {
+         (*cb)(false, user_data);
+      }
+      return;
+   }
+   g_ctrlm_db.backup.cb        = cb;
+   g_ctrlm_db.backup.user_data = user_data;
+   g_ctrlm_db.backup.steps     = 0;
+   ctrlm_timestamp_get_monotonic(&g_ctrlm_db.backup.start);
+
+   if(false == ctrlm_utils_move_file_to_secure_nvm(CTRLM_NVM_BACKUP)) {
+      XLOGD_ERROR("Failed to move file <%s> to secure area!!!!!!!!!!!!!!!!!!!", CTRLM_NVM_BACKUP);
+      ctrlm_db_backup_end(false);
+      return;
+   }
+   // Copy into a temporary file next to the real backup (following the link to the secure area) and rename it over the
+   // previous backup when complete, so the previous backup stays usable for recovery until then.
+   if(!ctrlm_file_get_symlink_target(CTRLM_NVM_BACKUP, g_ctrlm_db.backup.path)) {
+      g_ctrlm_db.backup.path = CTRLM_NVM_BACKUP;
+   }
+   g_ctrlm_db.backup.path_tmp = g_ctrlm_db.backup.path + ".tmp";
+   unlink(g_ctrlm_db.backup.path_tmp.c_str());
+
+   int rc = sqlite3_open(g_ctrlm_db.backup.path_tmp.c_str(), &g_ctrlm_db.backup.dest);
+   if(rc != SQLITE_OK) {
+      XLOGD_ERROR("unable to open backup <%s> rc <%d> <%s>", g_ctrlm_db.backup.path_tmp.c_str(), rc, ctrlm_db_errmsg(rc));
+      ctrlm_db_backup_end(false);
+      return;
+   }
+   g_ctrlm_db.backup.handle = sqlite3_backup_init(g_ctrlm_db.backup.dest, "main", g_ctrlm_db.handle, "main");
+   if(g_ctrlm_db.backup.handle == NULL) {
+      XLOGD_ERROR("unable to start backup <%s>", sqlite3_errmsg(g_ctrlm_db.backup.dest));
+      ctrlm_db_backup_end(false);
+      return;
+   }
+   XLOGD_INFO("backup started");
+}
+
+// Copy one slice of the backup.  Writes on this connection between slices are applied to the backup as well so it
+// continues where it left off rather than restarting.
+void ctrlm_db_backup_step() {
+   int rc = sqlite3_backup_step(g_ctrlm_db.backup.handle, CTRLM_DB_BACKUP_PAGES_PER_STEP);
+   g_ctrlm_db.backup.steps++;
+
+   if(rc == SQLITE_DONE) {
+      ctrlm_db_backup_end(true);
+   } else if(rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED) { // retry busy/locked on the next slice
+      XLOGD_DEBUG("backup progress <%d/%d> pages", sqlite3_backup_pagecount(g_ctrlm_db.backup.handle) - sqlite3_backup_remaining(g_ctrlm_db.backup.handle), sqlite3_backup_pagecount(g_ctrlm_db.backup.handle));
+   } else {
+      XLOGD_ERROR("backup step failed rc <%d> <%s>", rc, ctrlm_db_errmsg(rc));
+      ctrlm_db_backup_end(false);
+   }
+}
+
+void ctrlm_db_backup_end(bool success) {
+   int pages = 0;
+   if(g_ctrlm_db.backup.handle != NULL) {
+      pages = sqlite3_backup_pagecount(g_ctrlm_db.backup.handle);
+      if(SQLITE_OK != sqlite3_backup_finish(g_ctrlm_db.backup.handle) && success) {
+         XLOGD_ERROR("backup finish failed <%s>", sqlite3_errmsg(g_ctrlm_db.backup.dest));
+         success = false;
+      }
+      g_ctrlm_db.backup.handle = NULL;
+   }
+   if(g_ctrlm_db.backup.dest != NULL) {
+      if(SQLITE_OK != sqlite3_close(g_ctrlm_db.backup.dest) && success) {
+         XLOGD_ERROR("backup close failed");
+         success = false;
+      }
+      g_ctrlm_db.backup.dest = NULL;
+   }
+   if(!g_ctrlm_db.backup.path_tmp.empty()) {
+      if(success && rename(g_ctrlm_db.backup.path_tmp.c_str(), g_ctrlm_db.backup.path.c_str()) != 0) {
+         int errsv = errno;
+         XLOGD_ERROR("unable to rename <%s> to <%s> <%s>", g_ctrlm_db.backup.path_tmp.c_str(), g_ctrlm_db.backup.path.c_str(), strerror(errsv));
+         success = false;
+      }
+      if(!success) {
+         unlink(g_ctrlm_db.backup.path_tmp.c_str());
+      }
+      g_ctrlm_db.backup.path_tmp.clear();
+   }
+
+   ctrlm_timestamp_t end;
+   ctrlm_timestamp_get_monotonic(&end);
+   if(success) {
+      XLOGD_INFO("ctrlm DB backed up successfully: <%d> pages in <%lu> steps, <%lld> ms", pages, g_ctrlm_db.backup.steps, ctrlm_timestamp_subtract_ms(g_ctrlm_db.backup.start, end));
+   } else {
+      XLOGD_ERROR("Failed to back up ctrlm DB after <%lld> ms", ctrlm_timestamp_subtract_ms(g_ctrlm_db.backup.start, end));
+   }
+
+   ctrlm_db_backup_cb_t cb = g_ctrlm_db.backup.cb;
+   g_ctrlm_db.backup.cb    = NULL;
+   if(cb) {
+      (*cb)(success, g_ctrlm_db.backup.user_data);
+   }
+}
+
 
 void ctrlm_db_power_state_change(gboolean waking_up) {
    if(g_ctrlm_db.deepsleep_close_db) {
@@ -424,7 +726,9 @@ void ctrlm_db_power_state_change_(gboolean waking_up) {
 
    if(waking_up == true ) {
       XLOGD_INFO("Opening DB due to coming out of DEEP_SLEEP");
-      ctrlm_db_open(g_ctrlm_db.path);
+      if(ctrlm_db_open(g_ctrlm_db.path) && !g_ctrlm_db.value_cache_valid) {
+         ctrlm_db_value_cache_fill();
+      }
    } else {
       XLOGD_INFO("Closing DB due to DEEP_SLEEP");
       ctrlm_db_close();
@@ -441,13 +745,59 @@ gpointer ctrlm_db_thread(gpointer param) {
 
    XLOGD_INFO("Enter main loop");
    do {
-      gpointer msg = g_async_queue_pop(g_ctrlm_db.queue);
+      gpointer msg = NULL;
+      bool coalesce_pending;
+      {
+         std::unique_lock<std::mutex> lock(g_ctrlm_db.coalesce_mutex);
+         coalesce_pending = !g_ctrlm_db.coalesce_pending.empty();
+      }
+      if(g_ctrlm_db.backup.handle != NULL) { // Copy a slice of the backup whenever the queue is empty
+         msg = g_async_queue_try_pop(g_ctrlm_db.queue);
+         if(msg == NULL) {
+            if(coalesce_pending && ctrlm_db_coalesce_elapsed_ms() >= CTRLM_DB_COALESCE_LATENCY_MS) {
+               ctrlm_db_coalesce_flush();
+            }
+            ctrlm_db_backup_step();
+            continue;
+         }
+      } else if(!coalesce_pending) {
+         msg = g_async_queue_pop(g_ctrlm_db.queue);
+      } else { // Wait no longer than the latency bound of the oldest coalesced write
+         unsigned long long elapsed = ctrlm_db_coalesce_elapsed_ms();
+         if(elapsed < CTRLM_DB_COALESCE_LATENCY_MS) {
+            msg = g_async_queue_timeout_pop(g_ctrlm_db.queue, (CTRLM_DB_COALESCE_LATENCY_MS - elapsed) * 1000);
+         }
+         if(msg == NULL) {
+            ctrlm_db_coalesce_flush();
+            ctrlm_db_stats_report(false);
+            continue;
+         }
+      }
       if(msg == NULL) {
          XLOGD_ERROR("NULL message received");
          continue;
       }
 
       ctrlm_db_queue_msg_header_t *header = (ctrlm_db_queue_msg_header_t *)msg;
+
+      // Hold value writes so that repeated writes to the same key collapse into one
+      if(ctrlm_db_coalesce_add(msg)) {
+         continue;
+      }
+      if(header->type != CTRLM_DB_QUEUE_MSG_TYPE_TICKLE && header->type != CTRLM_DB_QUEUE_MSG_TYPE_WRITE_FILE) {
+         // Controller create/destroy must be ordered after the held writes and everything else needs them on disk
+         ctrlm_db_coalesce_flush();
+      }
+
+      // Group consecutive writes into one transaction.  Anything else (backup, power state change, terminate) needs the
+      // pending writes on disk before it is handled.
+      if(ctrlm_db_queue_msg_is_write(header->type)) {
+         ctrlm_db_transaction_begin();
+         g_ctrlm_db.transaction_msg_qty++;
+      } else if(header->type != CTRLM_DB_QUEUE_MSG_TYPE_TICKLE && header->type != CTRLM_DB_QUEUE_MSG_TYPE_WRITE_FILE) {
+         ctrlm_db_transaction_commit();
+      }
+
       switch(header->type) {
          case CTRLM_DB_QUEUE_MSG_TYPE_TERMINATE: {
             XLOGD_INFO("TERMINATE");
@@ -461,32 +811,10 @@ gpointer ctrlm_db_thread(gpointer param) {
             *thread_monitor_msg->response = CTRLM_THREAD_MONITOR_RESPONSE_ALIVE;
             break;
          }
-         case CTRLM_DB_QUEUE_MSG_TYPE_WRITE_UINT64: {
-            ctrlm_db_queue_msg_write_uint64_t *uint64 = (ctrlm_db_queue_msg_write_uint64_t *)msg;
-            XLOGD_DEBUG("WRITE UINT64 %s:%s:0x%016llX", uint64->table, uint64->key, uint64->value);
-            ctrlm_db_write_uint64_(uint64->table, uint64->key, uint64->value);
-            break;
-         }
-         case CTRLM_DB_QUEUE_MSG_TYPE_WRITE_STRING: {
-            ctrlm_db_queue_msg_write_string_t *string = (ctrlm_db_queue_msg_write_string_t *)msg;
-            XLOGD_DEBUG("WRITE STRING %s:%s:%s", string->table, string->key, string->value);
-            ctrlm_db_write_str_(string->table, string->key, string->value);
-            break;
-         }
+         case CTRLM_DB_QUEUE_MSG_TYPE_WRITE_UINT64:
+         case CTRLM_DB_QUEUE_MSG_TYPE_WRITE_STRING:
          case CTRLM_DB_QUEUE_MSG_TYPE_WRITE_BLOB: {
-            ctrlm_db_queue_msg_write_blob_t *blob = (ctrlm_db_queue_msg_write_blob_t *)msg;
-            XLOGD_DEBUG("WRITE BLOB %s:%s:%u", blob->table, blob->key, blob->length);
-            ctrlm_print_data_hex(__FUNCTION__, blob->value, blob->length, 16);
-            ctrlm_db_write_blob_(blob->table, blob->key, blob->value, blob->length);
-            break;
-         }
-        case CTRLM_DB_QUEUE_MSG_TYPE_WRITE_ATTR: {
-            ctrlm_db_queue_msg_write_attr_t *attr = (ctrlm_db_queue_msg_write_attr_t *)msg;
-            XLOGD_DEBUG("WRITE ATTR");
-            if (auto shared_attr_ptr = attr->attr.lock()) {
-               shared_attr_ptr->write_db(g_ctrlm_db.handle);
-            }
-            attr->attr.reset(); delete attr; msg = NULL;
+            ctrlm_db_queue_msg_write(msg);
             break;
          }
          case CTRLM_DB_QUEUE_MSG_TYPE_WRITE_FILE: {
@@ -511,19 +839,24 @@ gpointer ctrlm_db_thread(gpointer param) {
          case CTRLM_DB_QUEUE_MSG_TYPE_BACKUP: {
             ctrlm_db_queue_msg_backup_t *backup = (ctrlm_db_queue_msg_backup_t *)msg;
             XLOGD_DEBUG("BACKUP DATABASE");
-            if (false == ctrlm_utils_move_file_to_secure_nvm(CTRLM_NVM_BACKUP)) {
-               XLOGD_ERROR("Failed to move file <%s> to secure area!!!!!!!!!!!!!!!!!!!", CTRLM_NVM_BACKUP);
-               *(backup->ret) = FALSE;
-            } else {
-               if(FALSE == ctrlm_file_copy(sqlite3_db_filename(g_ctrlm_db.handle, "main"), CTRLM_NVM_BACKUP, TRUE, TRUE)) {
-                  XLOGD_ERROR("Failed to back up ctrlm DB");
-                  *(backup->ret) = FALSE;
-               } else {
-                  XLOGD_INFO("ctrlm DB backed up successfully");
-                  *(backup->ret) = TRUE;
-               }
+            ctrlm_db_backup_begin(backup->cb, backup->user_data);
+            break;
+         }
+         case CTRLM_DB_QUEUE_MSG_TYPE_INTEGRITY_CHECK: {
+            XLOGD_INFO("INTEGRITY CHECK");
+            if(g_ctrlm_db.handle == NULL) {
+               XLOGD_WARN("database is closed");
+               break;
             }
-            sem_post(&g_ctrlm_db.semaphore);
+            ctrlm_timestamp_t start;
+            ctrlm_timestamp_t end;
+            ctrlm_timestamp_get_monotonic(&start);
+            if(!ctrlm_db_verify_integrity(true)) {
+               XLOGD_TELEMETRY("Database is corrupt. Recovery will be attempted on next boot.");
+               g_ctrlm_db.integrity_check_full_next_boot = true;
+            }
+            ctrlm_timestamp_get_monotonic(&end);
+            XLOGD_INFO("integrity_check took <%lld> ms", ctrlm_timestamp_subtract_ms(start, end));
             break;
          }
          case CTRLM_DB_QUEUE_MSG_TYPE_POWER_STATE_CHANGE: {
@@ -541,11 +874,459 @@ gpointer ctrlm_db_thread(gpointer param) {
       }
       ctrlm_db_queue_msg_destroy(msg);
 
-      if(ds_sem_wait == true) {
-         sem_wait(&g_ctrlm_db.ds_signal);
+      // Commit once the queue has been drained
+      if(g_ctrlm_db.transaction_active && (g_async_queue_length(g_ctrlm_db.queue) <= 0 || g_ctrlm_db.transaction_msg_qty >= CTRLM_DB_TRANSACTION_MSG_QTY_MAX)) {
+         ctrlm_db_transaction_commit();
+      }
+      ctrlm_db_stats_report(!running);
+
+      if(ds_sem_wait == true) {
+         sem_wait(&g_ctrlm_db.ds_signal);
+      }
+   } while(running);
+   return(NULL);
+}
+
+void ctrlm_db_queue_msg_write(gpointer msg) {
+   ctrlm_db_queue_msg_header_t *header = (ctrlm_db_queue_msg_header_t *)msg;
+   switch(header->type) {
+      case CTRLM_DB_QUEUE_MSG_TYPE_WRITE_UINT64: {
+         ctrlm_db_queue_msg_write_uint64_t *uint64 = (ctrlm_db_queue_msg_write_uint64_t *)msg;
+         XLOGD_DEBUG("WRITE UINT64 %s:%s:0x%016llX", uint64->table, uint64->key, uint64->value);
+         ctrlm_db_write_uint64_(uint64->table, uint64->key, uint64->value);
+         break;
+      }
+      case CTRLM_DB_QUEUE_MSG_TYPE_WRITE_STRING: {
+         ctrlm_db_queue_msg_write_string_t *string = (ctrlm_db_queue_msg_write_string_t *)msg;
+         XLOGD_DEBUG("WRITE STRING %s:%s:%s", string->table, string->key, string->value);
+         ctrlm_db_write_str_(string->table, string->key, string->value);
+         break;
+      }
+      case CTRLM_DB_QUEUE_MSG_TYPE_WRITE_BLOB: {
+         ctrlm_db_queue_msg_write_blob_t *blob = (ctrlm_db_queue_msg_write_blob_t *)msg;
+         XLOGD_DEBUG("WRITE BLOB %s:%s:%u", blob->table, blob->key, blob->length);
+         ctrlm_print_data_hex(__FUNCTION__, blob->value, blob->length, 16);
+         ctrlm_db_write_blob_(blob->table, blob->key, blob->value, blob->length);
+         break;
+      }
+      default: {
+         break;
+      }
+   }
+}
+
+// Takes ownership of the message if it is a value write, replacing any older write to the same table and key
+bool ctrlm_db_coalesce_add(gpointer msg) {
+   ctrlm_db_queue_msg_header_t *header = (ctrlm_db_queue_msg_header_t *)msg;
+   ctrlm_db_coalesce_key_t key;
+
+   switch(header->type) {
+      case CTRLM_DB_QUEUE_MSG_TYPE_WRITE_UINT64: {
+         ctrlm_db_queue_msg_write_uint64_t *uint64 = (ctrlm_db_queue_msg_write_uint64_t *)msg;
+         key = ctrlm_db_value_cache_key(uint64->table, uint64->key);
+         break;
+      }
+      case CTRLM_DB_QUEUE_MSG_TYPE_WRITE_STRING: {
+         ctrlm_db_queue_msg_write_string_t *string = (ctrlm_db_queue_msg_write_string_t *)msg;
+         key = ctrlm_db_value_cache_key(string->table, string->key);
+         break;
+      }
+      case CTRLM_DB_QUEUE_MSG_TYPE_WRITE_BLOB: {
+         ctrlm_db_queue_msg_write_blob_t *blob = (ctrlm_db_queue_msg_write_blob_t *)msg;
+         key = ctrlm_db_value_cache_key(blob->table, blob->key);
+         break;
+      }
+      default: {
+         return(false);
+      }
+   }
+
+   std::unique_lock<std::mutex> lock(g_ctrlm_db.coalesce_mutex);
+   if(g_ctrlm_db.coalesce_pending.empty()) {
+      ctrlm_timestamp_get_monotonic(&g_ctrlm_db.coalesce_oldest);
+   }
+   auto it = g_ctrlm_db.coalesce_pending.find(key);
+   if(it != g_ctrlm_db.coalesce_pending.end()) {
+      XLOGD_DEBUG("replace pending write %s:%s", key.first.c_str(), key.second.c_str());
+      ctrlm_db_queue_msg_destroy(it->second);
+      it->second = msg;
+      g_ctrlm_db.stats.coalesced++;
+   } else {
+      g_ctrlm_db.coalesce_pending[key] = msg;
+   }
+   return(true);
+}
+
+unsigned long long ctrlm_db_coalesce_elapsed_ms() {
+   ctrlm_timestamp_t now;
+   ctrlm_timestamp_get_monotonic(&now);
+   std::unique_lock<std::mutex> lock(g_ctrlm_db.coalesce_mutex);
+   signed long long elapsed = ctrlm_timestamp_subtract_ms(g_ctrlm_db.coalesce_oldest, now);
+   return(elapsed > 0 ? (unsigned long long)elapsed : 0);
+}
+
+// The held writes move to the flushing map so that readers keep seeing them without waiting on the SQL
+void ctrlm_db_coalesce_flush() {
+   {
+      std::unique_lock<std::mutex> lock(g_ctrlm_db.coalesce_mutex);
+      if(g_ctrlm_db.coalesce_pending.empty()) {
+         return;
+      }
+      XLOGD_DEBUG("flush %u writes", (guint32)g_ctrlm_db.coalesce_pending.size());
+      g_ctrlm_db.coalesce_flushing.swap(g_ctrlm_db.coalesce_pending);
+   }
+
+   ctrlm_db_transaction_begin();
+   for(auto &it : g_ctrlm_db.coalesce_flushing) {
+      ctrlm_db_queue_msg_write(it.second);
+      g_ctrlm_db.transaction_msg_qty++;
+   }
+   ctrlm_db_transaction_commit();
+
+   std::unique_lock<std::mutex> lock(g_ctrlm_db.coalesce_mutex);
+   for(auto &it : g_ctrlm_db.coalesce_flushing) {
+      ctrlm_db_queue_msg_destroy(it.second);
+   }
+   g_ctrlm_db.coalesce_flushing.clear();
+}
+
+// Returns the held write for the table and key or NULL.  Called with the coalesce mutex held.
+gpointer ctrlm_db_coalesce_find(const char *table, const char *key) {
+   ctrlm_db_coalesce_key_t coalesce_key = ctrlm_db_value_cache_key(table, key);
+   auto it = g_ctrlm_db.coalesce_pending.find(coalesce_key);
+   if(it != g_ctrlm_db.coalesce_pending.end()) {
+      return(it->second);
+   }
+   it = g_ctrlm_db.coalesce_flushing.find(coalesce_key);
+   if(it != g_ctrlm_db.coalesce_flushing.end()) {
+      return(it->second);
+   }
+   return(NULL);
+}
+
+// Readers on other threads must see writes that are being held, otherwise they would read a stale value from the DB.
+// Every held write carries its value so the read never touches the DB.
+bool ctrlm_db_coalesce_read(const char *table, const char *key, int *value_int, sqlite_uint64 *value_int64, guchar **value_str, guint32 *value_len, int *retval) {
+   std::unique_lock<std::mutex> lock(g_ctrlm_db.coalesce_mutex);
+   gpointer msg = ctrlm_db_coalesce_find(table, key);
+   if(msg == NULL) {
+      return(false);
+   }
+   return(ctrlm_db_coalesce_read_msg(msg, value_int, value_int64, value_str, value_len, retval));
+}
+
+// Hands the value of a held write to read the way the value column stores it, as the value cache does
+bool ctrlm_db_value_pending(const char *table, const char *key, std::function<void(ctrlm_db_value_t value)> read) {
+   if(table == NULL || key == NULL) {
+      return(false);
+   }
+   std::unique_lock<std::mutex> lock(g_ctrlm_db.coalesce_mutex);
+   gpointer msg = ctrlm_db_coalesce_find(table, key);
+   if(msg == NULL) {
+      return(false);
+   }
+   sqlite3_stmt *p_stmt = (sqlite3_stmt *)ctrlm_db_stmt_acquire("", CTRLM_DB_STMT_TYPE_STORED_VALUE);
+   if(p_stmt == NULL) {
+      return(false);
+   }
+   bool ret = false;
+   int rc = ctrlm_db_coalesce_bind_msg(msg, p_stmt, 1);
+   if(rc != SQLITE_OK) {
+      XLOGD_ERROR("Unable to bind value! rc <%d> <%s>", rc, ctrlm_db_errmsg(rc));
+   } else if((rc = sqlite3_step(p_stmt)) != SQLITE_ROW) {
+      XLOGD_ERROR("Unable to step! rc <%d> <%s>", rc, ctrlm_db_errmsg(rc));
+   } else {
+      read((ctrlm_db_value_t)sqlite3_column_value(p_stmt, 0));
+      ret = true;
+   }
+   ctrlm_db_stmt_release(p_stmt);
+   return(ret);
+}
+
+// Binds the value of a held write the same way ctrlm_db_insert_or_update binds it.  Called with the coalesce mutex held.
+int ctrlm_db_coalesce_bind_msg(gpointer msg, sqlite3_stmt *p_stmt, int index) {
+   ctrlm_db_queue_msg_header_t *header = (ctrlm_db_queue_msg_header_t *)msg;
+   switch(header->type) {
+      case CTRLM_DB_QUEUE_MSG_TYPE_WRITE_UINT64: {
+         ctrlm_db_queue_msg_write_uint64_t *uint64 = (ctrlm_db_queue_msg_write_uint64_t *)msg;
+         return(sqlite3_bind_int64(p_stmt, index, (sqlite3_int64)uint64->value));
+      }
+      case CTRLM_DB_QUEUE_MSG_TYPE_WRITE_STRING: {
+         ctrlm_db_queue_msg_write_string_t *string = (ctrlm_db_queue_msg_write_string_t *)msg;
+         return(sqlite3_bind_text(p_stmt, index, (const char *)string->value, -1, SQLITE_STATIC));
+      }
+      case CTRLM_DB_QUEUE_MSG_TYPE_WRITE_BLOB: {
+         ctrlm_db_queue_msg_write_blob_t *blob = (ctrlm_db_queue_msg_write_blob_t *)msg;
+         if(blob->length == 0) {
+            return(sqlite3_bind_text(p_stmt, index, (const char *)blob->value, -1, SQLITE_STATIC));
+         }
+         return(sqlite3_bind_blob(p_stmt, index, blob->value, blob->length, SQLITE_STATIC));
+      }
+      default: {
+         break;
+      }
+   }
+   return(SQLITE_MISUSE);
+}
+
+// Copies the value of a held write.  Called with the coalesce mutex held.
+bool ctrlm_db_coalesce_read_msg(gpointer msg, int *value_int, sqlite_uint64 *value_int64, guchar **value_str, guint32 *value_len, int *retval) {
+   ctrlm_db_queue_msg_header_t *header = (ctrlm_db_queue_msg_header_t *)msg;
+
+   if(header->type == CTRLM_DB_QUEUE_MSG_TYPE_WRITE_UINT64 && (value_int != NULL || value_int64 != NULL)) {
+      ctrlm_db_queue_msg_write_uint64_t *uint64 = (ctrlm_db_queue_msg_write_uint64_t *)msg;
+      if(value_int != NULL) {
+         *value_int = (int)uint64->value;
+      } else {
+         *value_int64 = uint64->value;
+      }
+      *retval = 0;
+      return(true);
+   }
+   if(header->type == CTRLM_DB_QUEUE_MSG_TYPE_WRITE_BLOB && value_str != NULL && value_len != NULL) {
+      ctrlm_db_queue_msg_write_blob_t *blob = (ctrlm_db_queue_msg_write_blob_t *)msg;
+      *value_str = NULL;
+      *value_len = 0;
+      *retval    = -1;
+      if(blob->length > 0) {
+         *value_str = (guchar *)g_malloc(blob->length);
+         if(*value_str == NULL) {
+            XLOGD_ERROR("out of memory! %u bytes requested", blob->length);
+         } else {
+            errno_t safec_rc = memcpy_s(*value_str, blob->length, blob->value, blob->length);
+            ERR_CHK(safec_rc);
+            *value_len = blob->length;
+            *retval    = 0;
+         }
+      }
+      return(true);
+   }
+   if(header->type == CTRLM_DB_QUEUE_MSG_TYPE_WRITE_STRING && value_str != NULL && value_len == NULL) {
+      ctrlm_db_queue_msg_write_string_t *string = (ctrlm_db_queue_msg_write_string_t *)msg;
+      *value_str = (guchar *)g_strdup((const gchar *)string->value);
+      *retval    = (*value_str != NULL) ? 0 : -1;
+      return(true);
+   }
+   // Type mismatch.  Let the caller read the value from the DB.
+   return(false);
+}
+
+bool ctrlm_db_coalesce_contains(const char *table, const char *key) {
+   std::unique_lock<std::mutex> lock(g_ctrlm_db.coalesce_mutex);
+   return(ctrlm_db_coalesce_find(table, key) != NULL);
+}
+
+// Drop held writes so they don't recreate deleted keys when flushed.  A pattern matches keys the same way as the DELETE.
+void ctrlm_db_coalesce_remove(const char *table, const char *key, bool pattern) {
+   ctrlm_db_coalesce_key_t coalesce_key = ctrlm_db_value_cache_key(table, key);
+   std::unique_lock<std::mutex> lock(g_ctrlm_db.coalesce_mutex);
+   if(!pattern) {
+      auto it = g_ctrlm_db.coalesce_pending.find(coalesce_key);
+      if(it != g_ctrlm_db.coalesce_pending.end()) {
+         ctrlm_db_queue_msg_destroy(it->second);
+         g_ctrlm_db.coalesce_pending.erase(it);
+      }
+      return;
+   }
+   for(auto it = g_ctrlm_db.coalesce_pending.begin(); it != g_ctrlm_db.coalesce_pending.end();) {
+      if(it->first.first == coalesce_key.first && sqlite3_strlike(key, it->first.second.c_str(), 0) == 0) {
+         XLOGD_DEBUG("drop pending write %s:%s", it->first.first.c_str(), it->first.second.c_str());
+         ctrlm_db_queue_msg_destroy(it->second);
+         it = g_ctrlm_db.coalesce_pending.erase(it);
+      } else {
+         it++;
+      }
+   }
+}
+
+ctrlm_db_stmt_t ctrlm_db_stmt_acquire(const char *table, ctrlm_db_stmt_type_t type) {
+   if(table == NULL || type >= CTRLM_DB_STMT_TYPE_INVALID) {
+      XLOGD_WARN("invalid parameters!");
+      return(NULL);
+   }
+
+   // Controller entry tables are rows of their network type's attribute table.  One statement serves every controller in
+   // the attribute table, the ids are bound after the key and value.
+   const char *          attr_table    = NULL;
+   ctrlm_network_id_t    network_id    = 0;
+   ctrlm_controller_id_t controller_id = 0;
+   bool attr = ctrlm_db_controller_attr_table(table, &attr_table, &network_id, &controller_id);
+
+   ctrlm_db_stmt_entry_ptr_t entry;
+   std::unique_lock<std::mutex> lock(g_ctrlm_db.stmt_mutex);
+
+   if(g_ctrlm_db.handle == NULL) {
+      XLOGD_ERROR("database is not open");
+      return(NULL);
+   }
+
+   ctrlm_db_stmt_key_t key(attr ? attr_table : table, type);
+   auto it = g_ctrlm_db.stmt_cache.find(key);
+   if(it != g_ctrlm_db.stmt_cache.end()) {
+      entry = it->second;
+   } else {
+      entry = ctrlm_db_stmt_prepare(key.first.c_str(), type, attr);
+      if(entry == nullptr) {
+         return(NULL);
+      }
+      g_ctrlm_db.stmt_cache[key] = entry;
+   }
+   lock.unlock();
+
+   // A prepared statement can only be used by one thread at a time, its lock is held until it is released
+   entry->mutex.lock();
+   g_ctrlm_db_stmt_held[entry->stmt] = entry;
+
+   if(attr) {
+      int rc = sqlite3_bind_int(entry->stmt, CTRLM_DB_STMT_PARAM_NETWORK_ID, network_id);
+      if(rc == SQLITE_OK) {
+         rc = sqlite3_bind_int(entry->stmt, CTRLM_DB_STMT_PARAM_CONTROLLER_ID, controller_id);
+      }
+      if(rc != SQLITE_OK) {
+         XLOGD_ERROR("Unable to bind controller <%s> rc <%d> <%s>", table, rc, ctrlm_db_errmsg(rc));
+         ctrlm_db_stmt_release(entry->stmt);
+         return(NULL);
+      }
+   }
+
+   return(entry->stmt);
+}
+
+// Called with the cache lock held.  Parameters are numbered so the key and value are bound the same way for both layouts.
+ctrlm_db_stmt_entry_ptr_t ctrlm_db_stmt_prepare(const char *table, ctrlm_db_stmt_type_t type, bool attr) {
+   stringstream sql;
+   if(type == CTRLM_DB_STMT_TYPE_STORED_VALUE) { // every value column has TEXT affinity, numbers are stored as text
+      sql << "SELECT CASE WHEN typeof(?1) IN ('integer','real') THEN CAST(?1 AS TEXT) ELSE ?1 END;";
+   } else if(attr) {
+      const char *where = " WHERE network_id=?3 AND controller_id=?4";
+      switch(type) {
+         case CTRLM_DB_STMT_TYPE_INSERT_OR_REPLACE: sql << "INSERT OR REPLACE INTO " << table << "(network_id,controller_id,key,value) VALUES (?3,?4,?1,?2);"; break;
+         case CTRLM_DB_STMT_TYPE_SELECT_VALUE:      sql << "SELECT value FROM " << table << where << " AND key=?1;"; break;
+         case CTRLM_DB_STMT_TYPE_SELECT_KEY:        sql << "SELECT key FROM " << table << where << " AND key=?1;"; break;
+         case CTRLM_DB_STMT_TYPE_SELECT_KEYS:       sql << "SELECT key FROM " << table << where << ";"; break;
+         default: break;
+      }
+   } else {
+      switch(type) {
+         case CTRLM_DB_STMT_TYPE_INSERT_OR_REPLACE: sql << "INSERT OR REPLACE INTO " << table << "(key,value) VALUES (?1,?2);"; break;
+         case CTRLM_DB_STMT_TYPE_SELECT_VALUE:      sql << "SELECT value FROM " << table << " WHERE key=?1;"; break;
+         case CTRLM_DB_STMT_TYPE_SELECT_KEY:        sql << "SELECT key FROM " << table << " WHERE key=?1;"; break;
+         case CTRLM_DB_STMT_TYPE_SELECT_KEYS:       sql << "SELECT key FROM " << table << ";"; break;
+         default: break;
+      }
+   }
+
+   sqlite3_stmt *p_stmt = NULL;
+   int rc = sqlite3_prepare_v2(g_ctrlm_db.handle, sql.str().c_str(), -1, &p_stmt, NULL);
+   if(rc != SQLITE_OK || p_stmt == NULL) {
+      XLOGD_TELEMETRY("Unable to prepare sql statement <%s> rc <%d> <%s>!", sql.str().c_str(), rc, ctrlm_db_errmsg(rc));
+      sqlite3_finalize(p_stmt);
+      return(nullptr);
+   }
+   XLOGD_DEBUG("cached <%s>", sql.str().c_str());
+
+   return(std::make_shared<ctrlm_db_stmt_entry_t>(p_stmt));
+}
+
+void ctrlm_db_stmt_release(ctrlm_db_stmt_t stmt) {
+   if(stmt == NULL) { // nothing was acquired
+      return;
+   }
+   sqlite3_stmt *p_stmt = (sqlite3_stmt *)stmt;
+   auto it = g_ctrlm_db_stmt_held.find(p_stmt);
+   if(it == g_ctrlm_db_stmt_held.end()) {
+      XLOGD_ERROR("statement was not acquired by this thread");
+      return;
+   }
+   if(!sqlite3_stmt_readonly(p_stmt)) {
+      std::unique_lock<std::mutex> lock(g_ctrlm_db.stmt_mutex);
+      g_ctrlm_db.stats.statements++;
+   }
+   sqlite3_reset(p_stmt);
+   sqlite3_clear_bindings(p_stmt);
+   it->second->mutex.unlock();
+   g_ctrlm_db_stmt_held.erase(it); // finalizes the statement if it was purged while in use
+}
+
+// Drop the cached statements for a table (or all tables if NULL).  Statements in use are finalized when released.
+void ctrlm_db_stmt_cache_purge(const char *table) {
+   std::unique_lock<std::mutex> lock(g_ctrlm_db.stmt_mutex);
+   for(auto it = g_ctrlm_db.stmt_cache.begin(); it != g_ctrlm_db.stmt_cache.end();) {
+      if(table == NULL || it->first.first == table) {
+         it = g_ctrlm_db.stmt_cache.erase(it);
+      } else {
+         it++;
+      }
+   }
+}
+
+void ctrlm_db_transaction_begin() {
+   if(g_ctrlm_db.transaction_active || g_ctrlm_db.handle == NULL) {
+      return;
+   }
+   char *err_msg = NULL;
+   int rc = sqlite3_exec(g_ctrlm_db.handle, "BEGIN;", NULL, NULL, &err_msg);
+   if(rc != SQLITE_OK) {
+      XLOGD_ERROR("SQL error: errmsg <%s> rc <%d> <%s>", (err_msg ? err_msg : ""), rc, ctrlm_db_errmsg(rc));
+      if(err_msg) {
+         sqlite3_free(err_msg);
+      }
+      return;
+   }
+   g_ctrlm_db.transaction_active  = true;
+   g_ctrlm_db.transaction_msg_qty = 0;
+}
+
+void ctrlm_db_transaction_commit() {
+   if(!g_ctrlm_db.transaction_active) {
+      return;
+   }
+   g_ctrlm_db.transaction_active = false;
+
+   if(g_ctrlm_db.handle == NULL) {
+      XLOGD_ERROR("database is not open");
+      return;
+   }
+   if(sqlite3_get_autocommit(g_ctrlm_db.handle)) { // sqlite rolls back automatically on some errors (ie. disk full)
+      XLOGD_TELEMETRY("transaction of %u writes was rolled back", g_ctrlm_db.transaction_msg_qty);
+      ctrlm_db_value_cache_fill(); // drop the cached values of the writes that were rolled back
+      return;
+   }
+
+   char *err_msg = NULL;
+   int rc = sqlite3_exec(g_ctrlm_db.handle, "COMMIT;", NULL, NULL, &err_msg);
+   if(rc != SQLITE_OK) {
+      XLOGD_TELEMETRY("SQL error: errmsg <%s> rc <%d> <%s>", (err_msg ? err_msg : ""), rc, ctrlm_db_errmsg(rc));
+      if(err_msg) {
+         sqlite3_free(err_msg);
       }
-   } while(running);
-   return(NULL);
+      sqlite3_exec(g_ctrlm_db.handle, "ROLLBACK;", NULL, NULL, NULL);
+      ctrlm_db_value_cache_fill();
+      return;
+   }
+   g_ctrlm_db.stats.commits++;
+   XLOGD_DEBUG("committed %u writes", g_ctrlm_db.transaction_msg_qty);
+}
+
+void ctrlm_db_stats_report(bool force) {
+   unsigned long long elapsed = ctrlm_timestamp_since_ms(g_ctrlm_db.stats.start);
+   if(elapsed == 0 || (!force && elapsed < (CTRLM_DB_STATS_REPORT_INTERVAL_SECS * 1000))) {
+      return;
+   }
+   std::unique_lock<std::mutex> lock(g_ctrlm_db.stmt_mutex);
+   if(g_ctrlm_db.stats.statements > 0 || g_ctrlm_db.stats.commits > 0) {
+      XLOGD_INFO("statements <%llu> (%.2f/sec) commits <%llu> (%.2f/sec) coalesced <%llu> in %llu secs", g_ctrlm_db.stats.statements, (g_ctrlm_db.stats.statements * 1000.0) / elapsed, g_ctrlm_db.stats.commits, (g_ctrlm_db.stats.commits * 1000.0) / elapsed, g_ctrlm_db.stats.coalesced, elapsed / 1000);
+   }
+   g_ctrlm_db.stats.statements = 0;
+   g_ctrlm_db.stats.commits    = 0;
+   g_ctrlm_db.stats.coalesced  = 0;
+   ctrlm_timestamp_get(&g_ctrlm_db.stats.start);
+   lock.unlock();
+
+   unsigned long long hits   = 0;
+   unsigned long long misses = 0;
+   ctrlm_db_value_cache_stats(&hits, &misses);
+   XLOGD_INFO("value cache %s hits <%llu> misses <%llu> (%.1f%% hit)", g_ctrlm_db.value_cache_valid ? "valid" : "INVALID", hits, misses, (hits + misses) ? (hits * 100.0) / (hits + misses) : 0.0);
 }
 
 bool ctrlm_db_table_exists(const char *table) {
@@ -787,48 +1568,35 @@ bool ctrlm_db_key_exists(const char *table, const char *key) {
       return(-1);
    }
 
-   sqlite3_stmt *p_stmt = NULL;
-   int rc;
-   errno_t safec_rc = -1;
-   int ind = -1;
-   stringstream sql;
-   sql << "SELECT key FROM " << table << ";";
+   if(ctrlm_db_coalesce_contains(table, key)) {
+      return(true);
+   }
 
-   rc = sqlite3_prepare(g_ctrlm_db.handle, sql.str().c_str(), -1, &p_stmt, 0);
-   if(rc != SQLITE_OK){
-      XLOGD_TELEMETRY("Unable to prepare sql statement <%s> rc <%d> <%s>!", sql.str().c_str(), rc, ctrlm_db_errmsg(rc));
+   ctrlm_db_value_t value = NULL;
+   if(ctrlm_db_value_acquire(table, key, &value)) {
+      ctrlm_db_value_release();
+      return(value != NULL);
+   }
+
+   sqlite3_stmt *p_stmt = (sqlite3_stmt *)ctrlm_db_stmt_acquire(table, CTRLM_DB_STMT_TYPE_SELECT_KEY);
+   if(p_stmt == NULL) {
       return(false);
    }
 
    bool found = false;
-   do {
+   int rc = sqlite3_bind_text(p_stmt, 1, key, -1, SQLITE_STATIC);
+   if(rc != SQLITE_OK) {
+      XLOGD_ERROR("Unable to bind key! rc <%d> <%s>", rc, ctrlm_db_errmsg(rc));
+   } else {
       rc = sqlite3_step(p_stmt);
-
-      if(rc == SQLITE_ROW){
-         const unsigned char *col_name = sqlite3_column_text(p_stmt, 0);
-
-         if(col_name == NULL) {
-            XLOGD_ERROR("NULL column name");
-            continue;
-         }
-         XLOGD_DEBUG("key <%s>", col_name);
-
-         safec_rc = strcmp_s(key, strlen(key), (const char *)col_name, &ind);
-         ERR_CHK(safec_rc);
-         if((safec_rc == EOK) && (!ind)) {
-            found = true;
-            break;
-         }
+      if(rc == SQLITE_ROW) {
+         found = true;
       } else if(rc != SQLITE_DONE) {
-         XLOGD_ERROR("Unable to step! <%s> rc <%d> <%s>", sql.str().c_str(), rc, ctrlm_db_errmsg(rc));
+         XLOGD_ERROR("Unable to step! <%s> rc <%d> <%s>", sqlite3_sql(p_stmt), rc, ctrlm_db_errmsg(rc));
       }
-   } while(rc == SQLITE_ROW);
-
-   rc = sqlite3_finalize(p_stmt);
-   if(rc != SQLITE_OK){
-      XLOGD_ERROR("Unable to finalize! <%s> rc <%d> <%s>", sql.str().c_str(), rc, ctrlm_db_errmsg(rc));
-      return(false);
    }
+
+   ctrlm_db_stmt_release(p_stmt);
    return(found);
 }
 
@@ -950,14 +1718,9 @@ void ctrlm_db_write_blob_(const char *table, const char *key, const guchar *valu
 
 // Insert or update a key/value pair in the database
 int ctrlm_db_insert_or_update(const char *table, const char *key, const int *value_int, const sqlite3_int64 *value_int64, const guchar *value_str, guint32 blob_length) {
-   sqlite3_stmt *p_stmt = NULL;
    int rc;
-   stringstream sql;
 
-   if(table != NULL && key != NULL) {
-      sql << "INSERT OR REPLACE INTO " << table << "(key,value) VALUES (?,?);";   //CID:80608 - Reverse_inull
-   }
-   else {
+   if(table == NULL || key == NULL) {
       XLOGD_ERROR("Invalid table or key");
       return(-1);
    }
@@ -966,16 +1729,15 @@ int ctrlm_db_insert_or_update(const char *table, const char *key, const int *val
       return(-1);
    }
 
-   rc = sqlite3_prepare(g_ctrlm_db.handle, sql.str().c_str(), -1, &p_stmt, 0);
-   if(rc != SQLITE_OK){
-      XLOGD_TELEMETRY("Unable to prepare sql statement <%s> rc <%d> <%s>!", sql.str().c_str(), rc, ctrlm_db_errmsg(rc));
+   sqlite3_stmt *p_stmt = (sqlite3_stmt *)ctrlm_db_stmt_acquire(table, CTRLM_DB_STMT_TYPE_INSERT_OR_REPLACE);
+   if(p_stmt == NULL) {
       return(-1);
    }
 
    rc = sqlite3_bind_text(p_stmt, 1, key, -1, SQLITE_STATIC); // key name is the first variable
    if(rc != SQLITE_OK){
       XLOGD_ERROR("Unable to bind first parameter! rc <%d> <%s>", rc, ctrlm_db_errmsg(rc));
-      sqlite3_finalize(p_stmt);
+      ctrlm_db_stmt_release(p_stmt);
       return(-1);
    }
 
@@ -991,22 +1753,29 @@ int ctrlm_db_insert_or_update(const char *table, const char *key, const int *val
 
    if(rc != SQLITE_OK){
       XLOGD_ERROR("Unable to bind second parameter! rc <%d> <%s>", rc, ctrlm_db_errmsg(rc));
-      sqlite3_finalize(p_stmt);
+      ctrlm_db_stmt_release(p_stmt);
       return(-1);
    }
 
    rc = sqlite3_step(p_stmt);
-   if(rc == SQLITE_ROW){
-      XLOGD_ERROR("Unable to step! <%s> rc <%d> <%s>", sql.str().c_str(), rc, ctrlm_db_errmsg(rc));
-      sqlite3_finalize(p_stmt);
+   if(rc != SQLITE_DONE){
+      XLOGD_ERROR("Unable to step! <%s> rc <%d> <%s>", sqlite3_sql(p_stmt), rc, ctrlm_db_errmsg(rc));
+      ctrlm_db_stmt_release(p_stmt);
       return(-1);
    }
 
-   rc = sqlite3_finalize(p_stmt);
-   if(rc != SQLITE_OK){
-      XLOGD_ERROR("Unable to finalize! <%s> rc <%d> <%s>", sql.str().c_str(), rc, ctrlm_db_errmsg(rc));
-      return(-1);
-   }
+   ctrlm_db_stmt_release(p_stmt);
+   ctrlm_db_value_cache_update(table, key, [&](ctrlm_db_stmt_t stmt, int index) {
+      sqlite3_stmt *p_value_stmt = (sqlite3_stmt *)stmt;
+      if(value_int != NULL) {
+         return(sqlite3_bind_int(p_value_stmt, index, *value_int));
+      } else if(value_int64 != NULL) {
+         return(sqlite3_bind_int64(p_value_stmt, index, *value_int64));
+      } else if(blob_length != 0) {
+         return(sqlite3_bind_blob(p_value_stmt, index, value_str, blob_length, SQLITE_STATIC));
+      }
+      return(sqlite3_bind_text(p_value_stmt, index, (const char*)value_str, -1, SQLITE_STATIC));
+   });
    return(0);
 }
 
@@ -1147,22 +1916,17 @@ int ctrlm_db_select_keys(const char *table, vector<char *> *keys_str, vector<ctr
       return(-1);
    }
 
-   string sql = "SELECT key FROM ";
-   sql.append(table);
-   sql.append(";");
-
-   sqlite3_stmt *p_stmt = NULL;
-   int rc =  sqlite3_prepare_v2(g_ctrlm_db.handle, sql.c_str(), sql.length(), &p_stmt, NULL);
-   if(rc != SQLITE_OK) {
-      XLOGD_TELEMETRY("Unable to prepare sql statement <%s> rc <%d> <%s>!", sql.c_str(), rc, ctrlm_db_errmsg(rc));
+   sqlite3_stmt *p_stmt = (sqlite3_stmt *)ctrlm_db_stmt_acquire(table, CTRLM_DB_STMT_TYPE_SELECT_KEYS);
+   if(p_stmt == NULL) {
       return(-1);
    }
 
+   int rc;
    do {
       rc = sqlite3_step(p_stmt);
       if(rc != SQLITE_ROW && rc != SQLITE_DONE) {
          XLOGD_TELEMETRY("SQL step error: rc <%d> <%s>", rc, ctrlm_db_errmsg(rc));
-         sqlite3_finalize(p_stmt);
+         ctrlm_db_stmt_release(p_stmt);
          return(-1);
       }
       if(rc == SQLITE_ROW) {
@@ -1190,10 +1954,7 @@ int ctrlm_db_select_keys(const char *table, vector<char *> *keys_str, vector<ctr
       }
    } while(rc == SQLITE_ROW); // more rows available
 
-   rc = sqlite3_finalize(p_stmt);
-   if(rc != SQLITE_OK) {
-      XLOGD_INFO("SQL finalize error: <%s> rc <%d> <%s>", sql.c_str(), rc, ctrlm_db_errmsg(rc));
-   }
+   ctrlm_db_stmt_release(p_stmt);
 
    return(retval);
 }
@@ -1211,37 +1972,54 @@ int ctrlm_db_select(const char *table, const char *key, int *value_int, sqlite_u
       return(retval);
    }
 
-   string sql = "SELECT value FROM ";
-   sql.append(table);
-   sql.append(" WHERE key='");
-   sql.append(key);
-   sql.append("';");
+   if(ctrlm_db_coalesce_read(table, key, value_int, value_int64, value_str, value_len, &retval)) {
+      return(retval);
+   }
 
-   sqlite3_stmt *p_stmt = NULL;
-   int rc =  sqlite3_prepare_v2(g_ctrlm_db.handle, sql.c_str(), sql.length(), &p_stmt, NULL);
-   if(rc != SQLITE_OK) {
-      XLOGD_TELEMETRY("Unable to prepare sql statement <%s> rc <%d> <%s>!", sql.c_str(), rc, ctrlm_db_errmsg(rc));
+   sqlite3_value *value  = NULL;
+   sqlite3_stmt  *p_stmt = NULL;
+   sqlite3_mutex *mutex  = NULL;
+   bool           cached = ctrlm_db_value_acquire(table, key, (ctrlm_db_value_t *)&value);
+   if(cached && value == NULL) { // not in the database
+      ctrlm_db_value_release();
       return(retval);
    }
+   if(!cached) {
+      p_stmt = (sqlite3_stmt *)ctrlm_db_stmt_acquire(table, CTRLM_DB_STMT_TYPE_SELECT_VALUE);
+      if(p_stmt == NULL) {
+         return(retval);
+      }
 
-   rc = sqlite3_step(p_stmt);
-   if(rc != SQLITE_ROW) {
-      if(rc != SQLITE_DONE) {  // log an error if the return code is not DONE
-         XLOGD_TELEMETRY("SQL step error: <%s> rc <%d> <%s>", sql.c_str(), rc, ctrlm_db_errmsg(rc));
+      int rc = sqlite3_bind_text(p_stmt, 1, key, -1, SQLITE_STATIC);
+      if(rc != SQLITE_OK) {
+         XLOGD_ERROR("Unable to bind key! rc <%d> <%s>", rc, ctrlm_db_errmsg(rc));
+         ctrlm_db_stmt_release(p_stmt);
+         return(retval);
       }
-      sqlite3_finalize(p_stmt);
-      return(retval);
+
+      rc = sqlite3_step(p_stmt);
+      if(rc != SQLITE_ROW) {
+         if(rc != SQLITE_DONE) {  // log an error if the return code is not DONE
+            XLOGD_TELEMETRY("SQL step error: <%s> <%s> rc <%d> <%s>", sqlite3_sql(p_stmt), key, rc, ctrlm_db_errmsg(rc));
+         }
+         ctrlm_db_stmt_release(p_stmt);
+         return(retval);
+      }
+      // A column value is only protected while the connection's mutex is held (this is what the sqlite3_column_* accessors do)
+      value = sqlite3_column_value(p_stmt, 0);
+      mutex = sqlite3_db_mutex(g_ctrlm_db.handle);
+      sqlite3_mutex_enter(mutex);
    }
 
    if(value_int != NULL) { // Integer value
-      *value_int = sqlite3_column_int(p_stmt, 0);
+      *value_int = sqlite3_value_int(value);
       retval = 0;
    } else if(value_int64 != NULL) {
-      *value_int64 = sqlite3_column_int64(p_stmt, 0);
+      *value_int64 = sqlite3_value_int64(value);
       retval = 0;
    } else if(value_len != NULL) { // Blob value
-      const unsigned char *blob = (unsigned char *)sqlite3_column_blob(p_stmt, 0);
-      int byte_qty = sqlite3_column_bytes(p_stmt, 0);
+      const unsigned char *blob = (unsigned char *)sqlite3_value_blob(value);
+      int byte_qty = sqlite3_value_bytes(value);
       if(blob == NULL || byte_qty <= 0) {
          //XLOGD_ERROR("zero length blob!");
          *value_str = NULL;
@@ -1258,8 +2036,8 @@ int ctrlm_db_select(const char *table, const char *key, int *value_int, sqlite_u
          }
       }
    } else { // Text value
-      const unsigned char *text = sqlite3_column_text(p_stmt, 0);
-      int byte_qty = sqlite3_column_bytes(p_stmt, 0);
+      const unsigned char *text = sqlite3_value_text(value);
+      int byte_qty = sqlite3_value_bytes(value);
 
       if(text == NULL || byte_qty <= 0) {
          //XLOGD_ERROR("invalid string length %d. <%s>", byte_qty, sql.c_str());
@@ -1277,16 +2055,18 @@ int ctrlm_db_select(const char *table, const char *key, int *value_int, sqlite_u
       }
    }
 
-   rc = sqlite3_step(p_stmt);
+   if(cached) {
+      ctrlm_db_value_release();
+      return(retval);
+   }
+   sqlite3_mutex_leave(mutex);
+
+   int rc = sqlite3_step(p_stmt);
    if(rc == SQLITE_ROW) { // more rows available
       XLOGD_WARN("SQL step more rows available! Something is wrong...");
    }
 
-
-   rc = sqlite3_finalize(p_stmt);
-   if(rc != SQLITE_OK) {
-      XLOGD_INFO("SQL finalize error: <%s> rc <%d> <%s>", sql.c_str(), rc, ctrlm_db_errmsg(rc));
-   }
+   ctrlm_db_stmt_release(p_stmt);
 
    return(retval);
 }
@@ -1299,19 +2079,25 @@ int ctrlm_db_delete(const char *table, const char *key, bool pattern) {
       return(-1);
    }
 
-   string sql = "DELETE FROM ";
-   sql.append(table);
+   ctrlm_db_coalesce_remove(table, key, pattern);
+   ctrlm_db_value_cache_remove(table, key, pattern);
+
+   const char *          attr_table;
+   ctrlm_network_id_t    network_id;
+   ctrlm_controller_id_t controller_id;
+   stringstream sql;
+   if(ctrlm_db_controller_attr_table(table, &attr_table, &network_id, &controller_id)) {
+      sql << "DELETE FROM " << attr_table << " WHERE network_id=" << (int)network_id << " AND controller_id=" << (int)controller_id << " AND ";
+   } else {
+      sql << "DELETE FROM " << table << " WHERE ";
+   }
    if(!pattern) {
-      sql.append(" WHERE key='");
-      sql.append(key);
-      sql.append("';");
+      sql << "key='" << key << "';";
    } else {
-      sql.append(" WHERE key LIKE '");
-      sql.append(key);
-      sql.append("';");
+      sql << "key LIKE '" << key << "';";
    }
 
-   int rc = sqlite3_exec(g_ctrlm_db.handle, sql.c_str(), NULL, NULL, &err_msg);
+   int rc = sqlite3_exec(g_ctrlm_db.handle, sql.str().c_str(), NULL, NULL, &err_msg);
    if(rc != SQLITE_OK) {
       XLOGD_INFO("SQL error: errmsg <%s> rc <%d> <%s>", (err_msg ? err_msg : ""), rc, ctrlm_db_errmsg(rc));
       if(err_msg) {
@@ -1612,6 +2398,9 @@ void ctrlm_db_rf4ce_network_create(ctrlm_network_id_t network_id) {
       sqlite3_free(err_msg);
       return;
    }
+
+   // Create the rf4ce controller attribute table (shared by all RF4CE networks)
+   ctrlm_db_controller_attr_table_create(CTRLM_DB_TABLE_NET_RF4CE_CONTROLLER_ATTR);
 }
 
 void ctrlm_db_rf4ce_controller_create(ctrlm_network_id_t network_id, ctrlm_controller_id_t controller_id) {
@@ -1659,13 +2448,15 @@ int ctrlm_db_integrity_check_result(void *param, int argc, char **argv, char **c
    return 0;
 }
 
-bool ctrlm_db_verify_integrity() {
+bool ctrlm_db_verify_integrity(bool full) {
    char *err_msg = NULL;
    bool db_error = false;
-   // Execute pragma integrity_check
-   int rc = sqlite3_exec(g_ctrlm_db.handle, "PRAGMA integrity_check;", ctrlm_db_integrity_check_result, &db_error, &err_msg);
+   // Execute pragma integrity_check or quick_check, which skips the index content checks and is much faster
+   const char *pragma = full ? "integrity_check" : "quick_check";
+   string sql = string("PRAGMA ") + pragma + ";";
+   int rc = sqlite3_exec(g_ctrlm_db.handle, sql.c_str(), ctrlm_db_integrity_check_result, &db_error, &err_msg);
    if(rc != SQLITE_OK || db_error) {
-      XLOGD_TELEMETRY("integrity_check failed %s", (err_msg ? err_msg : ""));
+      XLOGD_TELEMETRY("%s failed %s", pragma, (err_msg ? err_msg : ""));
       if(err_msg) {
          sqlite3_free(err_msg);
       }
@@ -1674,6 +2465,19 @@ bool ctrlm_db_verify_integrity() {
    return(TRUE);
 }
 
+gboolean ctrlm_db_integrity_check_timeout(gpointer user_data) {
+   g_ctrlm_db.integrity_check_tag = 0;
+
+   ctrlm_db_queue_msg_header_t *msg = (ctrlm_db_queue_msg_header_t *)g_malloc(sizeof(ctrlm_db_queue_msg_header_t));
+   if(msg == NULL) {
+      XLOGD_ERROR("Out of memory");
+      return(FALSE);
+   }
+   msg->type = CTRLM_DB_QUEUE_MSG_TYPE_INTEGRITY_CHECK;
+   ctrlm_db_queue_msg_push((gpointer)msg);
+   return(FALSE);
+}
+
 bool ctrlm_db_vacuum() {
    int rc = sqlite3_exec(g_ctrlm_db.handle, "VACUUM;", NULL, NULL, NULL);
    if(rc != SQLITE_OK) {
@@ -2200,10 +3004,19 @@ void ctrlm_db_controller_destroy(ctrlm_network_id_t network_id, ctrlm_controller
       }
    }
 
-   // Delete the controller's table
+   // Delete the controller's attributes
+   const char *          attr_table = NULL;
+   ctrlm_network_id_t    attr_network_id;
+   ctrlm_controller_id_t attr_controller_id;
+   if(!ctrlm_db_controller_attr_table(table_name_controller_entry, &attr_table, &attr_network_id, &attr_controller_id)) {
+      XLOGD_ERROR("invalid controller table <%s>", table_name_controller_entry);
+      return;
+   }
+   ctrlm_db_value_cache_remove_table(table_name_controller_entry);
+
    stringstream sql;
    char *err_msg = NULL;
-   sql << "DROP TABLE IF EXISTS " << table_name_controller_entry << ";";
+   sql << "DELETE FROM " << attr_table << " WHERE network_id=" << (int)network_id << " AND controller_id=" << (int)controller_id << ";";
    rc = sqlite3_exec(g_ctrlm_db.handle, sql.str().c_str(), NULL, NULL, &err_msg);
    if(rc != SQLITE_OK) {
       XLOGD_INFO("SQL error: errmsg <%s> rc <%d> <%s>", (err_msg ? err_msg : ""), rc, ctrlm_db_errmsg(rc));
@@ -2255,19 +3068,338 @@ void ctrlm_db_controller_create(ctrlm_network_id_t network_id, ctrlm_controller_
       // Add an entry to the controller list
       ctrlm_db_write_str(table_name_controller_list, key, (guchar *)table_name_controller_entry);
    }
+   // The controller's attributes are stored in the network type's attribute table which is created with the network
+}
+
+// Maps a controller entry table name (ie. rf4ce_00_controller_01, in either case) to the attribute table for its network type
+bool ctrlm_db_controller_attr_table(const char *table, const char **attr_table, ctrlm_network_id_t *network_id, ctrlm_controller_id_t *controller_id) {
+   if(table == NULL) {
+      return(false);
+   }
+   for(unsigned int index = 0; index < CTRLM_DB_CONTROLLER_ATTR_TABLE_QTY; index++) {
+      const char *prefix     = g_ctrlm_db_controller_attr_tables[index].prefix;
+      size_t      prefix_len = strlen(prefix);
+      if(strncasecmp(table, prefix, prefix_len) != 0) {
+         continue;
+      }
+      unsigned int net_id  = 0;
+      unsigned int ctrl_id = 0;
+      int          length  = 0;
+      if(sscanf(&table[prefix_len], "%2x_controller_%2x%n", &net_id, &ctrl_id, &length) != 2 || table[prefix_len + length] != '\0') {
+         return(false);
+      }
+      *attr_table    = g_ctrlm_db_controller_attr_tables[index].attr_table;
+      *network_id    = (ctrlm_network_id_t)net_id;
+      *controller_id = (ctrlm_controller_id_t)ctrl_id;
+      return(true);
+   }
+   return(false);
+}
 
-   // Create the controller's table
+void ctrlm_db_controller_attr_table_create(const char *attr_table) {
    char *err_msg = NULL;
    stringstream sql;
-   sql << "CREATE TABLE IF NOT EXISTS " << table_name_controller_entry << "(key TEXT PRIMARY KEY, value TEXT);";
+   // The primary key is the index used by every lookup, so the table doesn't need a rowid
+   sql << "CREATE TABLE IF NOT EXISTS " << attr_table << "(network_id INTEGER, controller_id INTEGER, key TEXT, value TEXT, PRIMARY KEY(network_id, controller_id, key)) WITHOUT ROWID;";
    int rc = sqlite3_exec(g_ctrlm_db.handle, sql.str().c_str(), NULL, NULL, &err_msg);
    if(rc != SQLITE_OK) {
       XLOGD_INFO("SQL error: errmsg <%s> rc <%d> <%s>", (err_msg ? err_msg : ""), rc, ctrlm_db_errmsg(rc));
       if(err_msg) {
          sqlite3_free(err_msg);
       }
+   }
+}
+
+int ctrlm_db_table_list_result(void *param, int argc, char **argv, char **column) {
+   vector<string> *tables = (vector<string> *)param;
+   if(argc > 0 && argv[0] != NULL) {
+      tables->push_back(argv[0]);
+   }
+   return(0);
+}
+
+// Moves the rows of each controller entry table into its network type's attribute table and drops the old table
+bool ctrlm_db_controller_attr_migrate() {
+   vector<string> tables;
+   char *err_msg = NULL;
+   int rc = sqlite3_exec(g_ctrlm_db.handle, "SELECT name FROM sqlite_master WHERE type='table' AND name LIKE '%\\_controller\\_%' ESCAPE '\\';", ctrlm_db_table_list_result, &tables, &err_msg);
+   if(rc != SQLITE_OK) {
+      XLOGD_TELEMETRY("SQL error: errmsg <%s> rc <%d> <%s>", (err_msg ? err_msg : ""), rc, ctrlm_db_errmsg(rc));
+      if(err_msg) {
+         sqlite3_free(err_msg);
+      }
+      return(false);
+   }
+
+   ctrlm_db_controller_attr_table_create(CTRLM_DB_TABLE_NET_RF4CE_CONTROLLER_ATTR);
+   ctrlm_db_controller_attr_table_create(CTRLM_DB_TABLE_NET_IP_CONTROLLER_ATTR);
+   ctrlm_db_controller_attr_table_create(CTRLM_DB_TABLE_NET_BLE_CONTROLLER_ATTR);
+
+   // The tables are moved in a single transaction so an interrupted migration is repeated from the start on the next boot
+   ctrlm_db_transaction_begin();
+   unsigned long table_qty = 0;
+   for(vector<string>::iterator it = tables.begin(); it != tables.end(); it++) {
+      const char *          attr_table;
+      ctrlm_network_id_t    network_id;
+      ctrlm_controller_id_t controller_id;
+      if(!ctrlm_db_controller_attr_table(it->c_str(), &attr_table, &network_id, &controller_id)) {
+         continue;
+      }
+      stringstream sql;
+      sql << "INSERT OR REPLACE INTO " << attr_table << "(network_id,controller_id,key,value) SELECT " << (int)network_id << "," << (int)controller_id << ",key,value FROM " << *it << ";";
+      sql << "DROP TABLE " << *it << ";";
+      rc = sqlite3_exec(g_ctrlm_db.handle, sql.str().c_str(), NULL, NULL, &err_msg);
+      if(rc != SQLITE_OK) {
+         XLOGD_TELEMETRY("unable to migrate <%s> errmsg <%s> rc <%d> <%s>", it->c_str(), (err_msg ? err_msg : ""), rc, ctrlm_db_errmsg(rc));
+         if(err_msg) {
+            sqlite3_free(err_msg);
+         }
+         if(g_ctrlm_db.transaction_active) {
+            g_ctrlm_db.transaction_active = false;
+            sqlite3_exec(g_ctrlm_db.handle, "ROLLBACK;", NULL, NULL, NULL);
+         }
+         return(false);
+      }
+      table_qty++;
+   }
+
+   // Written in the same transaction so the version only changes if all the tables were moved
+   if(ctrlm_db_insert_or_update(CTRLM_DB_TABLE_CTRLMGR, CTRLM_DB_CTRLMGR_KEY_VERSION, NULL, NULL, (const guchar *)CTRLM_DB_VERSION, 0)) {
+      XLOGD_ERROR("error unable to update version");
+   }
+   g_ctrlm_db.transaction_msg_qty = table_qty;
+   ctrlm_db_transaction_commit();
+
+   // Statements prepared against the dropped tables are no longer valid
+   ctrlm_db_stmt_cache_purge(NULL);
+
+   XLOGD_INFO("migrated %lu controller tables", table_qty);
+   if(table_qty > 0 && !ctrlm_db_vacuum()) { // release the pages of the dropped tables
+      XLOGD_ERROR("unable to vacuum the database");
+   }
+   return(true);
+}
+
+ctrlm_db_value_key_t ctrlm_db_value_cache_key(const char *table, const char *key) {
+   string table_lower(table);
+   for(string::iterator it = table_lower.begin(); it != table_lower.end(); it++) { // table names are not case sensitive
+      *it = tolower(*it);
+   }
+   return(ctrlm_db_value_key_t(table_lower, key));
+}
+
+// Reads every key/value of every table into the value cache.  Rows of the controller attribute tables are cached under
+// their controller entry table name since that is the name used to read them.  This is the only bulk read of the
+// attribute tables, one query per network type, so loading the controllers doesn't query the database per attribute.
+void ctrlm_db_value_cache_fill() {
+   ctrlm_timestamp_t start;
+   ctrlm_timestamp_get_monotonic(&start);
+
+   ctrlm_db_value_cache_clear();
+
+   vector<string> tables;
+   char *err_msg = NULL;
+   int rc = sqlite3_exec(g_ctrlm_db.handle, "SELECT name FROM sqlite_master WHERE type='table' AND name NOT LIKE 'sqlite\\_%' ESCAPE '\\';", ctrlm_db_table_list_result, &tables, &err_msg);
+   if(rc != SQLITE_OK) {
+      XLOGD_TELEMETRY("SQL error: errmsg <%s> rc <%d> <%s>", (err_msg ? err_msg : ""), rc, ctrlm_db_errmsg(rc));
+      if(err_msg) {
+         sqlite3_free(err_msg);
+      }
+      return;
+   }
+
+   std::map<ctrlm_db_value_key_t, sqlite3_value *> cache;
+   bool result = true;
+   for(vector<string>::iterator it = tables.begin(); it != tables.end() && result; it++) {
+      const char *prefix = NULL;
+      for(unsigned int index = 0; index < CTRLM_DB_CONTROLLER_ATTR_TABLE_QTY; index++) {
+         if(*it == g_ctrlm_db_controller_attr_tables[index].attr_table) {
+            prefix = g_ctrlm_db_controller_attr_tables[index].prefix;
+            break;
+         }
+      }
+      stringstream sql;
+      if(prefix != NULL) {
+         sql << "SELECT key,value,network_id,controller_id FROM " << *it << ";";
+      } else {
+         sql << "SELECT key,value FROM " << *it << ";";
+      }
+
+      sqlite3_stmt *p_stmt = NULL;
+      rc = sqlite3_prepare_v2(g_ctrlm_db.handle, sql.str().c_str(), -1, &p_stmt, NULL);
+      if(rc != SQLITE_OK) { // not a key/value table so it is never read by key
+         XLOGD_WARN("table <%s> not cached rc <%d> <%s>", it->c_str(), rc, ctrlm_db_errmsg(rc));
+         sqlite3_finalize(p_stmt);
+         continue;
+      }
+      while((rc = sqlite3_step(p_stmt)) == SQLITE_ROW) {
+         const char *key = (const char *)sqlite3_column_text(p_stmt, 0);
+         if(key == NULL) {
+            continue;
+         }
+         string table = *it;
+         if(prefix != NULL) {
+            char table_name[CONTROLLER_TABLE_NAME_MAX_LEN];
+            errno_t safec_rc = sprintf_s(table_name, sizeof(table_name), "%s%02x_controller_%02x", prefix, sqlite3_column_int(p_stmt, 2), sqlite3_column_int(p_stmt, 3));
+            if(safec_rc < EOK) {
+               ERR_CHK(safec_rc);
+            }
+            table = table_name;
+         }
+         sqlite3_value *value = sqlite3_value_dup(sqlite3_column_value(p_stmt, 1));
+         if(value == NULL) {
+            XLOGD_ERROR("out of memory");
+            result = false;
+            break;
+         }
+         ctrlm_db_value_key_t value_key = ctrlm_db_value_cache_key(table.c_str(), key);
+         auto it_value = cache.find(value_key);
+         if(it_value != cache.end()) {
+            sqlite3_value_free(it_value->second);
+         }
+         cache[value_key] = value;
+      }
+      if(rc != SQLITE_DONE && result) {
+         XLOGD_TELEMETRY("SQL step error: <%s> rc <%d> <%s>", sql.str().c_str(), rc, ctrlm_db_errmsg(rc));
+         result = false;
+      }
+      sqlite3_finalize(p_stmt);
+   }
+
+   if(!result) { // reads go to the database
+      for(auto it = cache.begin(); it != cache.end(); it++) {
+         sqlite3_value_free(it->second);
+      }
+      return;
+   }
+
+   unsigned long value_qty = cache.size();
+   std::unique_lock<std::mutex> lock(g_ctrlm_db.value_cache_mutex);
+   g_ctrlm_db.value_cache.swap(cache);
+   g_ctrlm_db.value_cache_valid = true;
+   lock.unlock();
+
+   ctrlm_timestamp_t end;
+   ctrlm_timestamp_get_monotonic(&end);
+   XLOGD_INFO("cached %lu values from %lu tables in %lld us", value_qty, (unsigned long)tables.size(), ctrlm_timestamp_subtract_us(start, end));
+}
+
+void ctrlm_db_value_cache_clear() {
+   std::unique_lock<std::mutex> lock(g_ctrlm_db.value_cache_mutex);
+   for(auto it = g_ctrlm_db.value_cache.begin(); it != g_ctrlm_db.value_cache.end(); it++) {
+      sqlite3_value_free(it->second);
+   }
+   g_ctrlm_db.value_cache.clear();
+   g_ctrlm_db.value_cache_valid = false;
+}
+
+bool ctrlm_db_value_acquire(const char *table, const char *key, ctrlm_db_value_t *value) {
+   if(table == NULL || key == NULL || value == NULL) {
+      return(false);
+   }
+   // The lock is held until the value is released so it can't be replaced while it is being read
+   g_ctrlm_db.value_cache_mutex.lock();
+   if(!g_ctrlm_db.value_cache_valid) {
+      g_ctrlm_db.value_cache_misses++;
+      g_ctrlm_db.value_cache_mutex.unlock();
+      return(false);
+   }
+   auto it = g_ctrlm_db.value_cache.find(ctrlm_db_value_cache_key(table, key));
+   if(it == g_ctrlm_db.value_cache.end()) {
+      g_ctrlm_db.value_cache_misses++;
+      *value = NULL;
+   } else {
+      g_ctrlm_db.value_cache_hits++;
+      *value = it->second;
+   }
+   return(true);
+}
+
+void ctrlm_db_value_release() {
+   g_ctrlm_db.value_cache_mutex.unlock();
+}
+
+// Called after a write with the binding used for the value.  The cached value is converted the way the value column stores
+// it, so the table isn't read back.
+void ctrlm_db_value_cache_update(const char *table, const char *key, std::function<int(ctrlm_db_stmt_t stmt, int index)> bind) {
+   if(table == NULL || key == NULL || !g_ctrlm_db.value_cache_valid) {
+      return;
+   }
+   sqlite3_stmt *p_stmt = (sqlite3_stmt *)ctrlm_db_stmt_acquire("", CTRLM_DB_STMT_TYPE_STORED_VALUE);
+   if(p_stmt == NULL) {
+      ctrlm_db_value_cache_clear();
+      return;
+   }
+   int rc = bind(p_stmt, 1);
+   if(rc == SQLITE_OK) {
+      rc = sqlite3_step(p_stmt);
+   }
+
+   std::unique_lock<std::mutex> lock(g_ctrlm_db.value_cache_mutex);
+   ctrlm_db_value_key_t value_key = ctrlm_db_value_cache_key(table, key);
+   auto it = g_ctrlm_db.value_cache.find(value_key);
+   if(it != g_ctrlm_db.value_cache.end()) {
+      sqlite3_value_free(it->second);
+      g_ctrlm_db.value_cache.erase(it);
+   }
+   if(rc == SQLITE_ROW) {
+      sqlite3_value *value = sqlite3_value_dup(sqlite3_column_value(p_stmt, 0));
+      if(value != NULL) {
+         g_ctrlm_db.value_cache[value_key] = value;
+      } else {
+         rc = SQLITE_NOMEM;
+      }
+   }
+   if(rc != SQLITE_ROW && rc != SQLITE_DONE) { // the cache can't be trusted, reads go to the database
+      XLOGD_TELEMETRY("unable to cache <%s, %s> rc <%d> <%s>", table, key, rc, ctrlm_db_errmsg(rc));
+      for(it = g_ctrlm_db.value_cache.begin(); it != g_ctrlm_db.value_cache.end(); it++) {
+         sqlite3_value_free(it->second);
+      }
+      g_ctrlm_db.value_cache.clear();
+      g_ctrlm_db.value_cache_valid = false;
+   }
+   lock.unlock();
+   ctrlm_db_stmt_release(p_stmt);
+}
+
+void ctrlm_db_value_cache_remove(const char *table, const char *key, bool pattern) {
+   std::unique_lock<std::mutex> lock(g_ctrlm_db.value_cache_mutex);
+   if(!pattern) {
+      auto it = g_ctrlm_db.value_cache.find(ctrlm_db_value_cache_key(table, key));
+      if(it != g_ctrlm_db.value_cache.end()) {
+         sqlite3_value_free(it->second);
+         g_ctrlm_db.value_cache.erase(it);
+      }
       return;
    }
+   string table_lower = ctrlm_db_value_cache_key(table, "").first;
+   for(auto it = g_ctrlm_db.value_cache.lower_bound(ctrlm_db_value_key_t(table_lower, "")); it != g_ctrlm_db.value_cache.end() && it->first.first == table_lower;) {
+      if(sqlite3_strlike(key, it->first.second.c_str(), 0) == 0) {
+         sqlite3_value_free(it->second);
+         it = g_ctrlm_db.value_cache.erase(it);
+      } else {
+         it++;
+      }
+   }
+}
+
+void ctrlm_db_value_cache_remove_table(const char *table) {
+   std::unique_lock<std::mutex> lock(g_ctrlm_db.value_cache_mutex);
+   string table_lower = ctrlm_db_value_cache_key(table, "").first;
+   for(auto it = g_ctrlm_db.value_cache.lower_bound(ctrlm_db_value_key_t(table_lower, "")); it != g_ctrlm_db.value_cache.end() && it->first.first == table_lower;) {
+      sqlite3_value_free(it->second);
+      it = g_ctrlm_db.value_cache.erase(it);
+   }
+}
+
+void ctrlm_db_value_cache_stats(unsigned long long *hits, unsigned long long *misses) {
+   std::unique_lock<std::mutex> lock(g_ctrlm_db.value_cache_mutex);
+   if(hits != NULL) {
+      *hits = g_ctrlm_db.value_cache_hits;
+   }
+   if(misses != NULL) {
+      *misses = g_ctrlm_db.value_cache_misses;
+   }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -2312,6 +3444,9 @@ void ctrlm_db_ip_network_create(ctrlm_network_id_t network_id) {
       sqlite3_free(err_msg);
       return;
    }
+
+   // Create the ip controller attribute table (shared by all IP networks)
+   ctrlm_db_controller_attr_table_create(CTRLM_DB_TABLE_NET_IP_CONTROLLER_ATTR);
 }
 
 void ctrlm_db_ip_controller_create(ctrlm_network_id_t network_id, ctrlm_controller_id_t controller_id) {
@@ -2508,6 +3643,9 @@ void ctrlm_db_ble_network_create(ctrlm_network_id_t network_id) {
       sqlite3_free(err_msg);
       return;
    }
+
+   // Create the ble controller attribute table (shared by all BLE networks)
+   ctrlm_db_controller_attr_table_create(CTRLM_DB_TABLE_NET_BLE_CONTROLLER_ATTR);
 }
 
 void ctrlm_db_ble_controller_create(ctrlm_network_id_t network_id, ctrlm_controller_id_t controller_id) {
@@ -2585,7 +3723,7 @@ bool ctrlm_db_voice_valid() {
    return(g_ctrlm_db.voice_is_valid);
 }
 
-void ctrlm_db_delete_legacy_entries(void) {
+bool ctrlm_db_delete_legacy_entries(void) {
    #define VOICE_KEY_QTY (5)
 
    const char *voice_keys[VOICE_KEY_QTY] = { "sat_enable", "url_ptt", "url_ff", "url_mic_tap", "init_blob" };
@@ -2622,6 +3760,7 @@ void ctrlm_db_delete_legacy_entries(void) {
          XLOGD_ERROR("unable to vacuum the database");
       }
    }
+   return(key_found);
 }
 
 void ctrlm_db_voice_read_guide_language(std::string &lang) {
@@ -2717,16 +3856,28 @@ void ctrlm_db_voice_write_par_voice_status(bool status) {
    ctrlm_db_write_uint64(CTRLM_DB_TABLE_VOICE, "par_voice_status", (guint64) (status ? 1 : 0));
 }
 
+// The attribute's current value is queued as value writes, so a held write doesn't depend on the attribute outliving it
 void ctrlm_db_attr_write(std::weak_ptr<ctrlm_db_attr_t> attr) {
-   ctrlm_db_queue_msg_write_attr_t *msg = new (std::nothrow) ctrlm_db_queue_msg_write_attr_t();
-   if (msg == NULL) {
-      XLOGD_ERROR("Out of memory");
-      return;
+   if(auto shared_attr_ptr = attr.lock()) {
+      shared_attr_ptr->write_db(ctrlm_db_ctx_queue());
    }
-   msg->header.type = CTRLM_DB_QUEUE_MSG_TYPE_WRITE_ATTR;
-   msg->attr.swap(attr);
+}
 
-   ctrlm_db_queue_msg_push((gpointer)msg);
+ctrlm_db_ctx_t ctrlm_db_ctx_queue() {
+   static char ctx_queue;
+   return((ctrlm_db_ctx_t)&ctx_queue);
+}
+
+void ctrlm_db_queue_uint64(const char *table, const char *key, uint64_t value) {
+   ctrlm_db_write_uint64(table, key, (sqlite_uint64)value);
+}
+
+void ctrlm_db_queue_blob(const char *table, const char *key, const guchar *value, guint32 length) {
+   if(length == 0) { // bound as an empty string, the same as the attribute would write it
+      ctrlm_db_write_str(table, key, (const guchar *)"");
+   } else {
+      ctrlm_db_write_blob(table, key, value, length);
+   }
 }
 
 bool ctrlm_db_attr_read(ctrlm_db_attr_t *attr) {
@@ -26,7 +26,25 @@
 #include <ctrlm_ipc.h>
 #include <ctrlm_ipc_rcu.h>
 #include "ctrlm_db_attr.h"
+#include "ctrlm_db_types.h"
 #include <memory>
+#include <functional>
+
+typedef enum {
+   CTRLM_DB_STMT_TYPE_INSERT_OR_REPLACE = 0,
+   CTRLM_DB_STMT_TYPE_SELECT_VALUE      = 1,
+   CTRLM_DB_STMT_TYPE_SELECT_KEY        = 2,
+   CTRLM_DB_STMT_TYPE_SELECT_KEYS       = 3,
+   CTRLM_DB_STMT_TYPE_STORED_VALUE      = 4, // not tied to a table, returns parameter 1 as the value column would store it
+   CTRLM_DB_STMT_TYPE_INVALID           = 5
+} ctrlm_db_stmt_type_t;
+
+// Statements take the key as parameter 1 and the value as parameter 2.  Controller entries in an attribute table also take
+// their ids, which are bound on acquire.
+#define CTRLM_DB_STMT_PARAM_NETWORK_ID    (3)
+#define CTRLM_DB_STMT_PARAM_CONTROLLER_ID (4)
+
+typedef void (*ctrlm_db_backup_cb_t)(bool success, void *user_data);
 
 #ifdef __cplusplus
 extern "C"
@@ -38,7 +56,7 @@ gboolean ctrlm_db_created_default(void);
 void     ctrlm_db_terminate(void);
 void     ctrlm_db_queue_msg_push(gpointer msg);
 void     ctrlm_db_queue_msg_push_front(gpointer msg);
-bool     ctrlm_db_backup();
+bool     ctrlm_db_backup(ctrlm_db_backup_cb_t cb, void *user_data);
 void     ctrlm_db_power_state_change(gboolean waking_up);
 
 void ctrlm_db_ir_controller_create(std::string &table);
@@ -193,5 +211,26 @@ void ctrlm_db_voice_write_par_voice_status(bool status);
 
 void ctrlm_db_attr_write(std::weak_ptr<ctrlm_db_attr_t> attr);
 bool ctrlm_db_attr_read(ctrlm_db_attr_t *attr);
+// Context passed to write_db to queue a copy of the value for the database thread rather than write it
+ctrlm_db_ctx_t ctrlm_db_ctx_queue();
+void ctrlm_db_queue_uint64(const char *table, const char *key, uint64_t value);
+void ctrlm_db_queue_blob(const char *table, const char *key, const guchar *value, guint32 length);
+
+// Prepared statements are cached per table and type.  A statement returned by acquire is reserved for the
+// calling thread and MUST be handed back with release, which resets it for reuse.  Returns NULL on failure.
+ctrlm_db_stmt_t ctrlm_db_stmt_acquire(const char *table, ctrlm_db_stmt_type_t type);
+void            ctrlm_db_stmt_release(ctrlm_db_stmt_t stmt);
+
+// Every key/value in the database is cached in memory at init and the database thread updates the cache as it writes, so
+// reads don't run a query.  Acquire returns false if the cache can't answer (not filled yet or out of sync) and the value
+// must be read from the database.  Otherwise the cache is locked until release is called and the value is NULL if the
+// key is not in the database.
+bool ctrlm_db_value_acquire(const char *table, const char *key, ctrlm_db_value_t *value);
+void ctrlm_db_value_release();
+void ctrlm_db_value_cache_update(const char *table, const char *key, std::function<int(ctrlm_db_stmt_t stmt, int index)> bind);
+// Writes are held briefly so repeated writes to a key collapse into one.  Returns true if a write is held for the key
+// and passes its value to read, it must be read before pending returns.
+bool ctrlm_db_value_pending(const char *table, const char *key, std::function<void(ctrlm_db_value_t value)> read);
+void ctrlm_db_value_cache_stats(unsigned long long *hits, unsigned long long *misses);
 
 #endif
@@ -18,6 +18,7 @@
 */
 #include <iostream>
 #include "ctrlm_db_types.h"
+#include "ctrlm_database.h"
 #include <sqlite3.h>
 #include <cstring>
 #include "ctrlm_log.h"
@@ -36,23 +37,38 @@ bool ctrlm_db_obj_t::read_db(ctrlm_db_ctx_t ctx) {
     bool ret = false;
     sqlite3 *handle = (sqlite3 *)ctx;
     XLOGD_DEBUG("reading blob %s from table %s", this->key.c_str(), this->table.c_str());
+    if(ctrlm_db_value_pending(this->table.c_str(), this->key.c_str(), [this, &ret](ctrlm_db_value_t value) {
+        ret = this->extract_value(value);
+    })) {
+        return(ret);
+    }
+    ctrlm_db_value_t value = NULL;
+    if(ctrlm_db_value_acquire(this->table.c_str(), this->key.c_str(), &value)) {
+        if(value) {
+            ret = this->extract_value(value);
+        } else {
+            XLOGD_WARN("no row found for <%s, %s>", this->table.c_str(), this->key.c_str());
+        }
+        ctrlm_db_value_release();
+        return(ret);
+    }
     if(handle) {
-        sqlite3_stmt *stmt = NULL;
-        std::string query = "SELECT value FROM " + this->table + " WHERE key='" + this->key + "';";
-        int rc = sqlite3_prepare(handle, query.c_str(), query.length(), &stmt, NULL);
-        if(rc == SQLITE_OK && stmt) {
-            rc = sqlite3_step(stmt);
-            if(rc == SQLITE_ROW) {
-                ret = this->extract_data(stmt);
+        sqlite3_stmt *stmt = (sqlite3_stmt *)ctrlm_db_stmt_acquire(this->table.c_str(), CTRLM_DB_STMT_TYPE_SELECT_VALUE);
+        if(stmt) {
+            int rc = sqlite3_bind_text(stmt, 1, this->key.c_str(), -1, SQLITE_STATIC);
+            if(rc == SQLITE_OK) {
+                rc = sqlite3_step(stmt);
+                if(rc == SQLITE_ROW) {
+                    ret = this->extract_data(stmt);
+                } else {
+                    XLOGD_WARN("no row found for <%s, %s>", this->table.c_str(), this->key.c_str());
+                }
             } else {
-                XLOGD_WARN("no row found for <%s, %s>", this->table.c_str(), this->key.c_str());
+                XLOGD_ERROR("failed to SQL bind <%d, %s>", rc, sqlite3_errmsg(handle));
             }
+            ctrlm_db_stmt_release(stmt);
         } else {
-            XLOGD_ERROR("failed to prepare SQL statement <%d, %s>", rc, sqlite3_errmsg(handle));
-        }
-        rc = sqlite3_finalize(stmt);
-        if(rc != SQLITE_OK) {
-            XLOGD_ERROR("failed to finalize SQL statement <%d, %s>", rc, sqlite3_errmsg(handle));
+            XLOGD_ERROR("failed to prepare SQL statement <%s>", sqlite3_errmsg(handle));
         }
     } else {
         XLOGD_ERROR("database handle is NULL");
@@ -64,12 +80,14 @@ bool ctrlm_db_obj_t::write_db(ctrlm_db_ctx_t ctx) {
     bool ret = false;
     sqlite3 *handle = (sqlite3 *)ctx;
     XLOGD_DEBUG("writing blob %s to table %s", this->key.c_str(), this->table.c_str());
+    if(ctx == ctrlm_db_ctx_queue()) {
+        this->queue_data();
+        return(true);
+    }
     if(handle) {
-        sqlite3_stmt *stmt = NULL;
-        std::string query = "INSERT OR REPLACE INTO " + this->table + "(key,value) VALUES (?,?);";
-        int rc = sqlite3_prepare(handle, query.c_str(), -1, &stmt, NULL);
-        if(rc == SQLITE_OK && stmt) {
-            rc  = sqlite3_bind_text(stmt, 1, this->key.c_str(), -1, SQLITE_STATIC);
+        sqlite3_stmt *stmt = (sqlite3_stmt *)ctrlm_db_stmt_acquire(this->table.c_str(), CTRLM_DB_STMT_TYPE_INSERT_OR_REPLACE);
+        if(stmt) {
+            int rc  = sqlite3_bind_text(stmt, 1, this->key.c_str(), -1, SQLITE_STATIC);
             rc |= this->bind_data(stmt, 2);
             if(rc == SQLITE_OK) {
                 rc = sqlite3_step(stmt);
@@ -83,12 +101,14 @@ bool ctrlm_db_obj_t::write_db(ctrlm_db_ctx_t ctx) {
             } else {
                 XLOGD_ERROR("failed to SQL bind <%d, %s>", rc, sqlite3_errmsg(handle));
             }
+            ctrlm_db_stmt_release(stmt);
+            if(ret) {
+                ctrlm_db_value_cache_update(this->table.c_str(), this->key.c_str(), [this](ctrlm_db_stmt_t value_stmt, int index) {
+                    return(this->bind_data(value_stmt, index));
+                });
+            }
         } else {
-            XLOGD_ERROR("failed to prepare SQL statement <%d, %s>", rc, sqlite3_errmsg(handle));
-        }
-        rc = sqlite3_finalize(stmt);
-        if(rc != SQLITE_OK) {
-            XLOGD_ERROR("failed to finalize SQL statement <%d, %s>", rc, sqlite3_errmsg(handle));
+            XLOGD_ERROR("failed to prepare SQL statement <%s>", sqlite3_errmsg(handle));
         }
     } else {
         XLOGD_ERROR("database handle is NULL");
@@ -178,6 +198,16 @@ bool ctrlm_db_blob_t::extract_data(ctrlm_db_stmt_t stmt) {
     const char *sql_data = (char *)sqlite3_column_blob((sqlite3_stmt*)stmt, 0);
     return(this->from_buffer((char *)sql_data, col_len));
 }
+
+bool ctrlm_db_blob_t::extract_value(ctrlm_db_value_t value) {
+    size_t val_len = sqlite3_value_bytes((sqlite3_value*)value);
+    const char *sql_data = (char *)sqlite3_value_blob((sqlite3_value*)value);
+    return(this->from_buffer((char *)sql_data, val_len));
+}
+
+void ctrlm_db_blob_t::queue_data() {
+    ctrlm_db_queue_blob(this->table.c_str(), this->key.c_str(), (const guchar *)this->blob.data(), this->blob.size());
+}
 // end ctrlm_db_blob_t
 
 // ctrlm_db_uint64_t
@@ -210,4 +240,13 @@ bool ctrlm_db_uint64_t::extract_data(ctrlm_db_stmt_t stmt) {
     this->set_uint64(sqlite3_column_int64((sqlite3_stmt*)stmt, 0));
     return(true);
 }
+
+bool ctrlm_db_uint64_t::extract_value(ctrlm_db_value_t value) {
+    this->set_uint64(sqlite3_value_int64((sqlite3_value*)value));
+    return(true);
+}
+
+void ctrlm_db_uint64_t::queue_data() {
+    ctrlm_db_queue_uint64(this->table.c_str(), this->key.c_str(), this->get_uint64());
+}
 // end ctrlm_db_uint64_t
@@ -23,6 +23,7 @@
 #include "ctrlm_db_attr.h"
 
 typedef void* ctrlm_db_stmt_t;
+typedef void* ctrlm_db_value_t;
 
 /**
  * @brief ControlMgr Database Object
@@ -68,6 +69,16 @@ public:
      * @return True if the data was extracted, else False
      */
     virtual bool extract_data(ctrlm_db_stmt_t stmt) = 0;
+    /**
+     * Interface for class extensions to implement extracting the data from a DB value
+     * @param value The DB value to extract the data from
+     * @return True if the data was extracted, else False
+     */
+    virtual bool extract_value(ctrlm_db_value_t value) = 0;
+    /**
+     * Interface for class extensions to implement queueing a copy of the data to be written by the DB thread
+     */
+    virtual void queue_data() = 0;
 
 protected:
     std::string key;
@@ -146,6 +157,16 @@ public:
      * @see ctrlm_db_obj_t::extract_data(ctrlm_db_stmt_t stmt)
      */
     virtual bool extract_data(ctrlm_db_stmt_t stmt);
+    /**
+     * Implementation for extracting the data from a DB value
+     * @see ctrlm_db_obj_t::extract_value(ctrlm_db_value_t value)
+     */
+    virtual bool extract_value(ctrlm_db_value_t value);
+    /**
+     * Implementation for queueing a copy of the data to be written by the DB thread
+     * @see ctrlm_db_obj_t::queue_data()
+     */
+    virtual void queue_data();
 
 private:
     std::vector<char> blob;
@@ -200,6 +221,16 @@ public:
      * @see ctrlm_db_obj_t::extract_data(ctrlm_db_stmt_t stmt)
      */
     virtual bool extract_data(ctrlm_db_stmt_t stmt);
+    /**
+     * Implementation for extracting the data from a DB value
+     * @see ctrlm_db_obj_t::extract_value(ctrlm_db_value_t value)
+     */
+    virtual bool extract_value(ctrlm_db_value_t value);
+    /**
+     * Implementation for queueing a copy of the data to be written by the DB thread
+     * @see ctrlm_db_obj_t::queue_data()
+     */
+    virtual void queue_data();
 
 private:
     uint64_t data;
@@ -37,7 +37,7 @@ bool ctrlm_input_event_writer::init(std::string uinput_name, uint32_t vendor, ui
     }
 
     XLOGD_INFO("Initializing a user input device for %s...", uinput_name.c_str());
-    int fd = open("/dev/uinput", O_WRONLY|O_SYNC);
+    int fd = open("/dev/uinput", O_WRONLY|O_CLOEXEC);
     if (fd == -1) {
         int errsv = errno;
         XLOGD_ERROR("Open failed with errno %d (%s)", errsv, std::strerror(errsv));
@@ -48,9 +48,9 @@ bool ctrlm_input_event_writer::init(std::string uinput_name, uint32_t vendor, ui
     ioctl(fd, UI_SET_EVBIT, EV_SYN);
     ioctl(fd, UI_SET_EVBIT, EV_MSC);
     ioctl(fd, UI_SET_MSCBIT, MSC_SCAN);
-    for (auto const &entry : ctrlm_key_to_linux_map) {
-        if (entry.second.key_code != KEY_RESERVED) {
-            ioctl(fd, UI_SET_KEYBIT, entry.second.key_code);
+    for (auto const &entry : ctrlm_key_to_linux_entries) {
+        if (entry.values.key_code != KEY_RESERVED) {
+            ioctl(fd, UI_SET_KEYBIT, entry.values.key_code);
         }
     }
 
@@ -105,37 +105,32 @@ void ctrlm_input_event_writer::shutdown(void) {
 }
 
 bool ctrlm_input_event_writer::write_event_internal(uint32_t scan_code, uint16_t key_code, key_stroke stroke) {
-    int errsv = 0;
-    struct input_event event = {};
-    gettimeofday(&event.time, NULL);
-
-    event.type  = EV_MSC;
-    event.code  = MSC_SCAN;
-    event.value = scan_code;
-
-    if (write(fd_, &event, sizeof(event)) != sizeof(event)) {
-        errsv = errno;
-        XLOGD_ERROR("Write failed with errno %d (%s)", errsv, std::strerror(errsv));
-        return false;
-    }
-
-    event.type  = EV_KEY;
-    event.code  = key_code;
-    event.value = static_cast<uint8_t>(stroke);
-
-    if (write(fd_, &event, sizeof(event)) != sizeof(event)) {
-        errsv = errno;
-        XLOGD_ERROR("Write failed with errno %d (%s)", errsv, std::strerror(errsv));
-        return false;
-    }
-
-    event.type  = EV_SYN;
-    event.code  = SYN_REPORT;
-    event.value = 0;
-
-    if (write(fd_, &event, sizeof(event)) != sizeof(event)) {
-        errsv = errno;
-        XLOGD_ERROR("Write failed with errno %d (%s)", errsv, std::strerror(errsv));
+    // The whole report is submitted with a single write so the key costs one syscall
+    struct input_event events[3] = {};
+    gettimeofday(&events[0].time, NULL);
+
+    events[0].type  = EV_MSC;
+    events[0].code  = MSC_SCAN;
+    events[0].value = scan_code;
+
+    events[1].time  = events[0].time;
+    events[1].type  = EV_KEY;
+    events[1].code  = key_code;
+    events[1].value = static_cast<uint8_t>(stroke);
+
+    events[2].time  = events[0].time;
+    events[2].type  = EV_SYN;
+    events[2].code  = SYN_REPORT;
+    events[2].value = 0;
+
+    ssize_t rc = write(fd_, events, sizeof(events));
+    if (rc != sizeof(events)) {
+        int errsv = errno;
+        if (rc < 0) {
+            XLOGD_ERROR("Write failed with errno %d (%s)", errsv, std::strerror(errsv));
+        } else {
+            XLOGD_ERROR("Short write <%zd> of <%zu> bytes", rc, sizeof(events));
+        }
         return false;
     }
 
@@ -148,24 +143,24 @@ uint16_t ctrlm_input_event_writer::write_event(ctrlm_key_code_t code, ctrlm_key_
         return KEY_RESERVED;
     }
 
-    if (ctrlm_key_to_linux_map.find(code) == ctrlm_key_to_linux_map.end()) {
+    const linux_ui_code_values_t &param = ctrlm_key_to_linux_table.at(code);
+    if (!param.mapped) {
         XLOGD_ERROR("Code <%d, %s> not found in mapping", code, ctrlm_key_code_str(code));
         return KEY_RESERVED;
     }
 
-    if (ev_key_value_map.find(status) == ev_key_value_map.end()) {
+    auto stroke = ev_key_value_map.find(status);
+    if (stroke == ev_key_value_map.end()) {
         XLOGD_ERROR("Key status <%d> not found in mapping", status);
         return KEY_RESERVED;
     }
 
-    linux_ui_code_values_t param = ctrlm_key_to_linux_map.at(code);
-
     if (param.key_code == KEY_RESERVED) {
         XLOGD_WARN("Code <%d, %s> is currently not mapped - skipping", code, ctrlm_key_code_str(code));
         return param.key_code;
     }
 
-    if (!write_event_internal(param.scan_code, param.key_code, ev_key_value_map.at(status))) {
+    if (!write_event_internal(param.scan_code, param.key_code, stroke->second)) {
         return KEY_RESERVED;
     }
 
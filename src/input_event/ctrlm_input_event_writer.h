@@ -33,18 +33,21 @@ public:
     uint16_t key_code  = KEY_RESERVED;
     uint32_t scan_code = 0x0;
     uint16_t modifier  = KEY_RESERVED;
+    bool     mapped    = false; // false for codes which are not in the mapping at all
 
-    linux_ui_code_values_t() = default;
-    ~linux_ui_code_values_t() = default;
+    constexpr linux_ui_code_values_t() = default;
 
-    linux_ui_code_values_t(uint16_t key, uint32_t scan, uint16_t mod) {
-        key_code  = key;
-        scan_code = scan;
-        modifier  = mod;
+    constexpr linux_ui_code_values_t(uint16_t key, uint32_t scan, uint16_t mod) :
+        key_code(key), scan_code(scan), modifier(mod), mapped(true) {
     }
 };
 
-const std::map<ctrlm_key_code_t, linux_ui_code_values_t> ctrlm_key_to_linux_map =
+typedef struct {
+    ctrlm_key_code_t       code;
+    linux_ui_code_values_t values;
+} ctrlm_key_to_linux_entry_t;
+
+constexpr ctrlm_key_to_linux_entry_t ctrlm_key_to_linux_entries[] =
 {
     {CTRLM_KEY_CODE_OK,           linux_ui_code_values_t(KEY_ENTER,        0x0,  KEY_RESERVED)},
     {CTRLM_KEY_CODE_UP_ARROW,     linux_ui_code_values_t(KEY_UP,           0x0,  KEY_RESERVED)},
@@ -89,6 +92,28 @@ const std::map<ctrlm_key_code_t, linux_ui_code_values_t> ctrlm_key_to_linux_map
     {CTRLM_KEY_CODE_PUSH_TO_TALK, linux_ui_code_values_t(KEY_F8,           0x0,  KEY_RESERVED)}
 };
 
+// Direct index table built at compile time from ctrlm_key_to_linux_entries, so translating a key is a single array load
+class ctrlm_key_to_linux_table_t {
+public:
+    static constexpr unsigned int CODE_QTY = 0x100;
+
+    template <size_t N>
+    constexpr ctrlm_key_to_linux_table_t(const ctrlm_key_to_linux_entry_t (&entries)[N]) : values_() {
+        for (size_t i = 0; i < N; i++) {
+            values_[entries[i].code] = entries[i].values;
+        }
+    }
+
+    constexpr const linux_ui_code_values_t &at(ctrlm_key_code_t code) const {
+        return (static_cast<unsigned int>(code) < CODE_QTY) ? values_[code] : values_[CTRLM_KEY_CODE_INVALID];
+    }
+
+private:
+    linux_ui_code_values_t values_[CODE_QTY];
+};
+
+constexpr ctrlm_key_to_linux_table_t ctrlm_key_to_linux_table(ctrlm_key_to_linux_entries);
+
 enum class key_stroke {
     UP     = 0,
     DOWN   = 1,
@@ -104,12 +129,11 @@ const std::map<ctrlm_key_status_t, key_stroke> ev_key_value_map =
 };
 
 class ctrlm_input_event_writer {
-private:
+protected:
     bool initialized_       = false;
     int  fd_                = -1;
     std::string sysfs_name_ = "";
 
-protected:
     bool write_event_internal(uint32_t scan_code, uint16_t key_code, key_stroke stroke);
 
 public:
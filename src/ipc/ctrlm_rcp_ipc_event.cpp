@@ -45,6 +45,12 @@ ctrlm_rcp_ipc_controller_status_t::ctrlm_rcp_ipc_controller_status_t(const ctrlm
     wakeup_custom_list_(controller.get_wakeup_custom_list()),
     upgrade_session_id_(controller.get_upgrade_session_uuid())
 {
+    const ctrlm_histogram_atomic_t &key_latency = controller.key_latency_get(CTRLM_KEY_LATENCY_STAGE_TOTAL);
+    key_latency_count_ = key_latency.count();
+    key_latency_p50_   = key_latency.percentile(50);
+    key_latency_p95_   = key_latency.percentile(95);
+    key_latency_p99_   = key_latency.percentile(99);
+    key_latency_max_   = key_latency.max();
 }
 
 ctrlm_rcp_ipc_controller_status_t::~ctrlm_rcp_ipc_controller_status_t()
@@ -78,6 +84,15 @@ json_t *ctrlm_rcp_ipc_controller_status_t::to_json() const
 
     err |= json_object_set_new_nocheck(remote_data, WAKEUP_CONFIG,   json_string(config_str.c_str()));
 
+    // End to end key latency from the remote's input event to uinput/IARM emission
+    json_t *key_latency = json_object();
+    err |= json_object_set_new_nocheck(key_latency, KEY_LATENCY_COUNT, json_integer(key_latency_count_));
+    err |= json_object_set_new_nocheck(key_latency, KEY_LATENCY_P50,   json_integer(key_latency_p50_));
+    err |= json_object_set_new_nocheck(key_latency, KEY_LATENCY_P95,   json_integer(key_latency_p95_));
+    err |= json_object_set_new_nocheck(key_latency, KEY_LATENCY_P99,   json_integer(key_latency_p99_));
+    err |= json_object_set_new_nocheck(key_latency, KEY_LATENCY_MAX,   json_integer(key_latency_max_));
+    err |= json_object_set_new_nocheck(remote_data, KEY_LATENCY, key_latency);
+
     if (wakeup_config_ == CTRLM_RCU_WAKEUP_CONFIG_CUSTOM) {
         json_t *wakeup_custom_array = json_array();
 
@@ -157,6 +172,40 @@ char *ctrlm_rcp_ipc_net_status_t::to_string() const
     return json_dumps(to_json(), JSON_ENCODE_ANY);
 }
 
+ctrlm_rcp_ipc_net_status_snapshot_t::ctrlm_rcp_ipc_net_status_snapshot_t(unsigned long long version, const ctrlm_rcp_ipc_net_status_snapshot_t *previous, const ctrlm_rcp_ipc_net_status_t &net_status)
+    : version_(version)
+{
+    if (previous != nullptr) {
+        status_map_ = previous->status_map_;
+        published_  = previous->published_;
+    }
+    status_map_[net_status.get_net_id()] = net_status;
+    published_[net_status.get_net_id()]  = std::chrono::steady_clock::now();
+}
+
+// Successful when any network's reply was, like a reply for CTRLM_MAIN_NETWORK_ID_ALL
+bool ctrlm_rcp_ipc_net_status_snapshot_t::get_result() const
+{
+    for (const auto &it : status_map_) {
+        if (it.second.get_result()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Expired when any network's entry is older than max_age
+bool ctrlm_rcp_ipc_net_status_snapshot_t::is_expired(std::chrono::milliseconds max_age) const
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    for (const auto &it : published_) {
+        if (now - it.second > max_age) {
+            return true;
+        }
+    }
+    return false;
+}
+
 ctrlm_rcp_ipc_upgrade_status_t::~ctrlm_rcp_ipc_upgrade_status_t()
 {
 }
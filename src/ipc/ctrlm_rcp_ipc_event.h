@@ -22,6 +22,7 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <chrono>
 #include "ctrlm_ipc.h"
 #include "ctrlm_attr_general.h"
 #include "jansson.h"
@@ -61,6 +62,12 @@ namespace rcp_net_status_json_keys
     constexpr char const* UPGRADE_STATE        = "upgradeState";
     constexpr char const* UPGRADE_SESSION_ID   = "upgradeSessionId";
     constexpr char const* ERROR_STRING         = "errorString";
+    constexpr char const* KEY_LATENCY          = "keyLatencyUs";
+    constexpr char const* KEY_LATENCY_COUNT    = "count";
+    constexpr char const* KEY_LATENCY_P50      = "p50";
+    constexpr char const* KEY_LATENCY_P95      = "p95";
+    constexpr char const* KEY_LATENCY_P99      = "p99";
+    constexpr char const* KEY_LATENCY_MAX      = "max";
 }
 
 class ctrlm_virtual_json_t
@@ -101,6 +108,11 @@ private:
     ctrlm_rcu_wakeup_config_t wakeup_config_      = CTRLM_RCU_WAKEUP_CONFIG_INVALID;
     std::vector<uint16_t>     wakeup_custom_list_;
     std::string               upgrade_session_id_ = "";
+    unsigned long long        key_latency_count_  = 0;
+    unsigned long long        key_latency_p50_    = 0;
+    unsigned long long        key_latency_p95_    = 0;
+    unsigned long long        key_latency_p99_    = 0;
+    unsigned long long        key_latency_max_    = 0;
 };
 
 class ctrlm_rcp_ipc_net_status_t : public ctrlm_virtual_json_t
@@ -136,6 +148,24 @@ private:
     std::vector<ctrlm_rcp_ipc_controller_status_t> controller_status_list_;
 };
 
+// Immutable status of every network. The main thread publishes a new snapshot with a higher version whenever a
+// network reports a status change, so readers on other threads never have to wait for the main queue.
+class ctrlm_rcp_ipc_net_status_snapshot_t
+{
+public:
+    ctrlm_rcp_ipc_net_status_snapshot_t(unsigned long long version, const ctrlm_rcp_ipc_net_status_snapshot_t *previous, const ctrlm_rcp_ipc_net_status_t &net_status);
+
+    unsigned long long get_version() const { return version_; }
+    const std::map<ctrlm_network_id_t, ctrlm_rcp_ipc_net_status_t> &get_status_map() const { return status_map_; }
+    bool get_result() const;
+    bool is_expired(std::chrono::milliseconds max_age) const;
+
+private:
+    unsigned long long                                                      version_;
+    std::map<ctrlm_network_id_t, ctrlm_rcp_ipc_net_status_t>                status_map_;
+    std::map<ctrlm_network_id_t, std::chrono::steady_clock::time_point>     published_;
+};
+
 class ctrlm_rcp_ipc_upgrade_status_t : public ctrlm_virtual_json_t
 {
 public:
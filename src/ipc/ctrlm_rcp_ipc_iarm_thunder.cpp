@@ -30,6 +30,12 @@ using namespace rcp_net_status_json_keys;
 std::mutex                                     ctrlm_rcp_ipc_iarm_thunder_t::instance_mutex_;
 std::atomic_bool                               ctrlm_rcp_ipc_iarm_thunder_t::atomic_running_{false};
 bool                                           ctrlm_rcp_ipc_iarm_thunder_t::thunder_device_update_enabled_ = true;
+std::mutex                                     ctrlm_rcp_ipc_iarm_thunder_t::status_json_mutex_;
+unsigned long long                             ctrlm_rcp_ipc_iarm_thunder_t::status_json_version_ = 0;
+std::string                                    ctrlm_rcp_ipc_iarm_thunder_t::status_json_;
+
+// Not every controller attribute change is reported as a status event, so a snapshot older than this is rebuilt
+#define RCU_STATUS_SNAPSHOT_MAX_AGE (std::chrono::milliseconds(5000))
 
 static ctrlm_rcp_ipc_iarm_thunder_t *instance_ = nullptr;
 
@@ -152,15 +158,23 @@ bool ctrlm_rcp_ipc_iarm_thunder_t::on_status(const ctrlm_rcp_ipc_net_status_t &n
         return(false);
     }
 
-    std::shared_ptr<void> ptr = ctrlm_main_all_network_rcu_status_get();
-    if (ptr == nullptr) {
-        XLOGD_ERROR("Failed to get RCU status from main thread");
-        return false;
-    }
-    std::shared_ptr<ctrlm_network_all_ipc_reply_wrapper_t<ctrlm_rcp_ipc_net_status_t>> params =
-        std::static_pointer_cast<ctrlm_network_all_ipc_reply_wrapper_t<ctrlm_rcp_ipc_net_status_t>>(ptr);
+    // The reporting network has just published its status so the snapshot can be used unless another network's entry is stale
+    std::map<ctrlm_network_id_t, ctrlm_rcp_ipc_net_status_t> status_map;
+    std::shared_ptr<const ctrlm_rcp_ipc_net_status_snapshot_t> snapshot = ctrlm_main_rcu_status_snapshot_get();
+
+    if (snapshot != nullptr && !snapshot->is_expired(RCU_STATUS_SNAPSHOT_MAX_AGE)) {
+        status_map = snapshot->get_status_map();
+    } else {
+        std::shared_ptr<void> ptr = ctrlm_main_all_network_rcu_status_get();
+        if (ptr == nullptr) {
+            XLOGD_ERROR("Failed to get RCU status from main thread");
+            return false;
+        }
+        std::shared_ptr<ctrlm_network_all_ipc_reply_wrapper_t<ctrlm_rcp_ipc_net_status_t>> params =
+            std::static_pointer_cast<ctrlm_network_all_ipc_reply_wrapper_t<ctrlm_rcp_ipc_net_status_t>>(ptr);
 
-    const std::map<ctrlm_network_id_t, ctrlm_rcp_ipc_net_status_t> status_map = params->get_reply();
+        status_map = params->get_reply();
+    }
 
     json_t *status = build_rcu_status_json(status_map, net_status.get_ir_prog_state(), net_status.get_rf_pair_state(), net_status.get_type());
     if (status == nullptr) {
@@ -179,34 +193,38 @@ bool ctrlm_rcp_ipc_iarm_thunder_t::on_status(const ctrlm_rcp_ipc_net_status_t &n
 }
 
 
-IARM_Result_t ctrlm_rcp_ipc_iarm_thunder_t::get_net_status(void *arg)
+// Render the rcu status reply for a snapshot. The rendering is kept until a newer snapshot is published.
+bool ctrlm_rcp_ipc_iarm_thunder_t::rcu_status_json_get(const std::shared_ptr<const ctrlm_rcp_ipc_net_status_snapshot_t> &snapshot, std::string &json)
 {
-    XLOGD_INFO("");
+    unsigned long long version = (snapshot != nullptr) ? snapshot->get_version() : 0;
 
-    if (!is_running(atomic_running_)) {
-        XLOGD_ERROR("IARM Call received when IARM component in stopped/terminated state");
-        return(IARM_RESULT_INVALID_STATE);
+    std::lock_guard<std::mutex> lock(status_json_mutex_);
+    if (version != 0 && version == status_json_version_) {
+        json = status_json_;
+        return true;
     }
 
-    ctrlm_main_iarm_call_json_t *call_data = static_cast<ctrlm_main_iarm_call_json_t *>(arg);
-
-    if (!call_data || call_data->api_revision != CTRLM_MAIN_IARM_BUS_API_REVISION) {
-        XLOGD_ERROR("NULL parameter");
-        return(IARM_RESULT_INVALID_PARAM);
+    std::map<ctrlm_network_id_t, ctrlm_rcp_ipc_net_status_t> status_map;
+    bool result = false;
+    if (snapshot != nullptr) {
+        status_map = snapshot->get_status_map();
+        result     = snapshot->get_result();
     }
 
-    std::shared_ptr<ctrlm_network_all_ipc_reply_wrapper_t<ctrlm_rcp_ipc_net_status_t>> params = std::make_shared<ctrlm_network_all_ipc_reply_wrapper_t<ctrlm_rcp_ipc_net_status_t>>();
-    params->set_net_id(CTRLM_MAIN_NETWORK_ID_ALL);
-
-    sync_send_netw_handler_to_main_queue_new<ctrlm_network_all_ipc_reply_wrapper_t<ctrlm_rcp_ipc_net_status_t>,
-                                             ctrlm_main_queue_msg_get_rcu_status_t>
-                                             (params,
-                                             (ctrlm_msg_handler_network_t)&ctrlm_obj_network_t::req_process_get_rcu_status);
+    if (!rcu_status_json_build(status_map, result, json)) {
+        return false;
+    }
 
+    if (version != 0) {
+        status_json_version_ = version;
+        status_json_         = json;
+    }
+    return true;
+}
 
-    std::map<ctrlm_network_id_t, ctrlm_rcp_ipc_net_status_t> status_map = params->get_reply();
-    
-    
+// Render an rcu status reply. SUCCESS carries the result of the network replies the status was built from.
+bool ctrlm_rcp_ipc_iarm_thunder_t::rcu_status_json_build(const std::map<ctrlm_network_id_t, ctrlm_rcp_ipc_net_status_t> &status_map, bool result, std::string &json)
+{
     ctrlm_network_type_t  type = CTRLM_NETWORK_TYPE_INVALID;
     ctrlm_ir_state_t      ir_prog_state = CTRLM_IR_STATE_UNKNOWN;
     ctrlm_rf_pair_state_t rf_pair_state = CTRLM_RF_PAIR_STATE_UNKNOWN;
@@ -224,20 +242,76 @@ IARM_Result_t ctrlm_rcp_ipc_iarm_thunder_t::get_net_status(void *arg)
 
     json_t *status = build_rcu_status_json(status_map, ir_prog_state, rf_pair_state, type);
     if (status == nullptr) {
-        return(IARM_RESULT_INVALID_STATE);
+        return false;
     }
 
     json_t *ret = json_object();
 
     int err = 0;
     err |= json_object_set_new_nocheck(ret, STATUS, status);
-    err |= json_object_set_new_nocheck(ret, SUCCESS, json_boolean(params->get_result()));
+    err |= json_object_set_new_nocheck(ret, SUCCESS, json_boolean(result));
 
-    if (err || !ctrlm_json_to_iarm_call_data_result(ret, call_data)) {
+    char *ret_str = err ? NULL : json_dumps(ret, JSON_COMPACT);
+    json_decref(ret);
+    if (ret_str == NULL) {
         XLOGD_ERROR("JSON object set error");
-        json_decref(ret);
+        return false;
+    }
+    json = ret_str;
+    free(ret_str);
+    return true;
+}
+
+IARM_Result_t ctrlm_rcp_ipc_iarm_thunder_t::get_net_status(void *arg)
+{
+    XLOGD_INFO("");
+
+    if (!is_running(atomic_running_)) {
+        XLOGD_ERROR("IARM Call received when IARM component in stopped/terminated state");
+        return(IARM_RESULT_INVALID_STATE);
+    }
+
+    ctrlm_main_iarm_call_json_t *call_data = static_cast<ctrlm_main_iarm_call_json_t *>(arg);
+
+    if (!call_data || call_data->api_revision != CTRLM_MAIN_IARM_BUS_API_REVISION) {
+        XLOGD_ERROR("NULL parameter");
+        return(IARM_RESULT_INVALID_PARAM);
+    }
+
+    std::string json;
+    std::shared_ptr<const ctrlm_rcp_ipc_net_status_snapshot_t> snapshot = ctrlm_main_rcu_status_snapshot_get();
+
+    if (snapshot == nullptr || snapshot->is_expired(RCU_STATUS_SNAPSHOT_MAX_AGE)) {
+        // Have the networks publish their current status from the main thread
+        std::shared_ptr<ctrlm_network_all_ipc_reply_wrapper_t<ctrlm_rcp_ipc_net_status_t>> params = std::make_shared<ctrlm_network_all_ipc_reply_wrapper_t<ctrlm_rcp_ipc_net_status_t>>();
+        params->set_net_id(CTRLM_MAIN_NETWORK_ID_ALL);
+
+        sync_send_netw_handler_to_main_queue_new<ctrlm_network_all_ipc_reply_wrapper_t<ctrlm_rcp_ipc_net_status_t>,
+                                                 ctrlm_main_queue_msg_get_rcu_status_t>
+                                                 (params,
+                                                 (ctrlm_msg_handler_network_t)&ctrlm_obj_network_t::req_process_get_rcu_status);
+
+        // The expired snapshot is not a fallback. A failed or timed out refresh is reported with the replies received.
+        if (!params->get_result()) {
+            XLOGD_ERROR("Failed to refresh RCU status");
+            if (!rcu_status_json_build(params->get_reply(), false, json)) {
+                return(IARM_RESULT_INVALID_STATE);
+            }
+        } else {
+            snapshot = ctrlm_main_rcu_status_snapshot_get();
+        }
+    }
+
+    if (json.empty() && !rcu_status_json_get(snapshot, json)) {
+        return(IARM_RESULT_INVALID_STATE);
+    }
+
+    if (json.length() >= sizeof(call_data->result)) {
+        XLOGD_ERROR("JSON payload larger than iarm response");
         return(IARM_RESULT_INVALID_STATE);
     }
+    errno_t safec_rc = strcpy_s(call_data->result, sizeof(call_data->result), json.c_str());
+    ERR_CHK(safec_rc);
 
     return(IARM_RESULT_SUCCESS);
 }
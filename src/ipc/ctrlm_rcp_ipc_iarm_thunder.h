@@ -62,6 +62,9 @@ private:
     static std::mutex                                    instance_mutex_;
     static std::atomic_bool                              atomic_running_;
     static bool                                          thunder_device_update_enabled_;
+    static std::mutex                                    status_json_mutex_;
+    static unsigned long long                            status_json_version_;
+    static std::string                                   status_json_;
 
     void configure(void);
 
@@ -100,6 +103,8 @@ protected:
                                   ctrlm_ir_state_t      ir_prog_state,
                                   ctrlm_rf_pair_state_t rf_pair_state,
                                   ctrlm_network_type_t  type);
+    static bool    rcu_status_json_get(const std::shared_ptr<const ctrlm_rcp_ipc_net_status_snapshot_t> &snapshot, std::string &json);
+    static bool    rcu_status_json_build(const std::map<ctrlm_network_id_t, ctrlm_rcp_ipc_net_status_t> &status_map, bool result, std::string &json);
 
     template <typename T1, typename T2>
     static void sync_send_netw_handler_to_main_queue(T1 params, ctrlm_msg_handler_network_t handler)
@@ -40,11 +40,14 @@
 #include "ctrlm_thunder_plugin_cec_sink.h"
 #endif
 
+#include <algorithm>
 #include <chrono>
 #include <dlfcn.h>
 #include <iomanip>
 #include <memory>
+#include <set>
 #include <sstream>
+#include <unordered_map>
 
 using namespace std;
 
@@ -73,6 +76,78 @@ public:
     ctrlm_irdb_autolookup_result_t result = CTRLM_IRDB_AUTOLOOKUP_RESULT_UNKNOWN;
 };
 
+class ctrlm_irdb_autolookup_task_t {
+public:
+    ctrlm_irdb_autolookup_task_t(int p, ctrlm_irdb_autolookup_source_t s, ctrlm_irdb_autolookup_result_t r = CTRLM_IRDB_AUTOLOOKUP_RESULT_UNKNOWN): port(p), source(s), result(r) {}
+    int port = -1;
+    ctrlm_irdb_autolookup_source_t source = CTRLM_IRDB_AUTOLOOKUP_SOURCE_UNKNOWN;
+    ctrlm_irdb_autolookup_result_t result = CTRLM_IRDB_AUTOLOOKUP_RESULT_UNKNOWN; // Set up front when there is nothing to look up
+    std::vector<uint8_t> data;                                                    // EDID or infoframe
+    std::string osd;                                                              // CEC only
+    unsigned int vendor_id = 0;
+    unsigned int logical_address = 0;
+    std::string key;
+    bool memoized = false;
+    bool success = false;
+    ctrlm_irdb_dev_type_t type = CTRLM_IRDB_DEV_TYPE_INVALID;
+    ctrlm_irdb_autolookup_ranked_list_t ir_codes;
+};
+
+typedef struct {
+    ctrlm_irdb_dev_type_t               type;
+    ctrlm_irdb_autolookup_ranked_list_t ir_codes;
+} ctrlm_irdb_autolookup_memo_t;
+
+// Sorted copy of a manufacturer or model list. Prefix queries are a binary search over the case folded names.
+class ctrlm_irdb_prefix_index_t {
+public:
+    ctrlm_irdb_prefix_index_t(const std::vector<std::string> &names) {
+        entries.reserve(names.size());
+        for(const auto &name : names) {
+            entries.emplace_back(name_fold(name), name);
+        }
+        std::sort(entries.begin(), entries.end());
+        entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+    }
+
+    // Appends up to limit matches (0 for no limit) starting at offset and returns the total number of matches
+    size_t find(const std::string &prefix, size_t offset, size_t limit, std::vector<std::string> &names) const {
+        std::string folded = name_fold(prefix);
+        auto first = std::lower_bound(entries.begin(), entries.end(), folded, [](const entry_t &entry, const std::string &value) { return(entry.first < value); });
+        auto last  = std::partition_point(first, entries.end(), [&folded](const entry_t &entry) { return(entry.first.compare(0, folded.size(), folded) == 0); });
+        size_t total = last - first;
+        if(offset < total) {
+            size_t count = (limit == 0 || limit > total - offset) ? (total - offset) : limit;
+            names.reserve(names.size() + count);
+            for(auto itr = first + offset; itr != first + offset + count; ++itr) {
+                names.push_back(itr->second);
+            }
+        }
+        return(total);
+    }
+
+    static std::string name_fold(const std::string &name) {
+        std::string folded(name);
+        std::transform(folded.begin(), folded.end(), folded.begin(), [](unsigned char c) { return(std::tolower(c)); });
+        return(folded);
+    }
+
+private:
+    typedef std::pair<std::string, std::string> entry_t; // case folded name, name
+    std::vector<entry_t> entries;
+};
+
+#define CTRLM_IRDB_AUTOLOOKUP_THREAD_QTY_MAX (4)
+#define CTRLM_IRDB_AUTOLOOKUP_MEMO_QTY_MAX   (32)
+#define CTRLM_IRDB_MODEL_INDEX_QTY_MAX       (16)
+
+static std::string ctrlm_irdb_autolookup_key(const ctrlm_irdb_autolookup_task_t &task);
+static std::string ctrlm_irdb_autolookup_source_str(const ctrlm_irdb_autolookup_task_t &task);
+static void        ctrlm_irdb_autolookup_task_run(gpointer data, gpointer user_data);
+static void        ctrlm_irdb_autolookup_tasks_run(std::vector<ctrlm_irdb_autolookup_task_t *> &tasks);
+static size_t      ctrlm_irdb_list_page(std::vector<std::string> &names, size_t offset, size_t limit);
+static void        ctrlm_irdb_lists_clear();
+
 static ctrlm_irdb_interface_t *_instance = NULL;
 
 ctrlm_irdb_interface_t* ctrlm_irdb_interface_t::get_instance(bool platform_tv) {
@@ -105,6 +180,8 @@ typedef struct {
     bool (*pluginGetCodesByEdid)(ctrlm_irdb_autolookup_ranked_list_t &codes, ctrlm_irdb_dev_type_t &type, unsigned char *edid, unsigned int edid_len) = NULL;
     bool (*pluginGetCodesByCec)(ctrlm_irdb_autolookup_ranked_list_t &codes, ctrlm_irdb_dev_type_t &type, const std::string &osd, unsigned int vendor_id, unsigned int logical_address) = NULL;
     bool (*pluginGetCodesByInfoframe)(ctrlm_irdb_autolookup_ranked_list_t &codes, ctrlm_irdb_dev_type_t &type, unsigned char *infoframe, unsigned int infoframe_len) = NULL;
+    bool (*pluginAutolookupConcurrent)() = NULL;
+    bool autolookup_concurrent = false; // Plugin allows the autolookup calls to be made from several threads at once
 
     ctrlm_ipc_iarm_t                                                    *irdb_ipc;
     #ifdef CTRLM_THUNDER
@@ -117,6 +194,11 @@ typedef struct {
     Thunder::AVInput::ctrlm_thunder_plugin_av_input_t                   *av_input;
     #endif
    #endif
+    std::unordered_map<std::string, ctrlm_irdb_autolookup_memo_t>    autolookup_memo; // Autolookup results by source data, protected by m_mutex
+    std::map<ctrlm_irdb_dev_type_t, ctrlm_irdb_prefix_index_t>       manufacturer_index; // Loaded on first use, protected by m_mutex
+    std::map<std::pair<ctrlm_irdb_dev_type_t, std::string>, ctrlm_irdb_prefix_index_t> model_index;
+    std::set<ctrlm_irdb_dev_type_t>                                  manufacturer_unindexed; // Full list failed to load, queries go to the plugin
+    std::set<std::pair<ctrlm_irdb_dev_type_t, std::string>>          model_unindexed;
 } ctrlm_irdb_global_t;
 
 ctrlm_irdb_global_t g_irdb;
@@ -275,6 +357,16 @@ ctrlm_irdb_interface_t::ctrlm_irdb_interface_t(bool platform_tv) {
             XLOGD_ERROR("Failed to find plugin method (ctrlm_irdb_get_ir_codes_by_infoframe), error <%s>, Using STUB implementation", error);
             g_irdb.pluginGetCodesByInfoframe = STUB_ctrlm_irdb_get_ir_codes_by_infoframe;
         }
+        dlerror();  // Clear any existing error
+
+        // Optional, the autolookup calls are serialized unless the plugin states that they are thread safe
+        *(void **) (&g_irdb.pluginAutolookupConcurrent) = dlsym(m_irdbPluginHandle, "ctrlm_irdb_autolookup_concurrent");
+        if ((error = dlerror()) != NULL)  {
+            g_irdb.pluginAutolookupConcurrent = NULL;
+        } else if (g_irdb.pluginAutolookupConcurrent) {
+            g_irdb.autolookup_concurrent = (*g_irdb.pluginAutolookupConcurrent)();
+        }
+        XLOGD_INFO("autolookup <%s>", g_irdb.autolookup_concurrent ? "CONCURRENT" : "SEQUENTIAL");
     }
 
     open_plugin();
@@ -341,6 +433,7 @@ bool ctrlm_irdb_interface_t::open_plugin() {
 bool ctrlm_irdb_interface_t::close_plugin() {
     std::unique_lock<std::mutex> guard(m_mutex);
     bool ret = false;
+    ctrlm_irdb_lists_clear();
     if (g_irdb.pluginClose) {
         ret = (*g_irdb.pluginClose)();
     }
@@ -359,6 +452,8 @@ bool ctrlm_irdb_interface_t::get_vendor_info(ctrlm_irdb_vendor_info_t &info) {
 bool ctrlm_irdb_interface_t::set_vendor(const ctrlm_irdb_vendor_info_t &info) {
     std::unique_lock<std::mutex> guard(m_mutex);
     if (g_irdb.pluginSetPreferredVendor) {
+        // Autolookup results and the manufacturer and model lists depend on the vendor
+        ctrlm_irdb_lists_clear();
         return (*g_irdb.pluginSetPreferredVendor)(info);
     }
     return false;
@@ -398,6 +493,7 @@ bool ctrlm_irdb_interface_t::initialize_irdb() {
     std::unique_lock<std::mutex> guard(m_mutex);
     bool ret = false;
 
+    ctrlm_irdb_lists_clear();
     if (g_irdb.pluginInitialize) {
 
         if ((ret = (*g_irdb.pluginInitialize)()) == true) {
@@ -408,22 +504,78 @@ bool ctrlm_irdb_interface_t::initialize_irdb() {
     return ret;
 }
 
-bool ctrlm_irdb_interface_t::get_manufacturers(ctrlm_irdb_manufacturer_list_t &manufacturers, ctrlm_irdb_dev_type_t type, const std::string &prefix) {
+bool ctrlm_irdb_interface_t::get_manufacturers(ctrlm_irdb_manufacturer_list_t &manufacturers, ctrlm_irdb_dev_type_t type, const std::string &prefix, size_t offset, size_t limit, size_t *total) {
     std::unique_lock<std::mutex> guard(m_mutex);
     bool ret = false;
+    size_t count = 0;
 
     if (g_irdb.pluginGetManufacturers) {
-        ret = (*g_irdb.pluginGetManufacturers)(manufacturers, type, prefix);
+        auto index = g_irdb.manufacturer_index.find(type);
+        if (index == g_irdb.manufacturer_index.end()) {
+            // Load the full list once, type-ahead queries are then answered from the index.  If it fails, queries go to the
+            // plugin for the rest of the session rather than retrying the full list on every keystroke.
+            ctrlm_irdb_manufacturer_list_t all;
+            bool unindexed = g_irdb.manufacturer_unindexed.count(type) > 0;
+            if (!unindexed && (*g_irdb.pluginGetManufacturers)(all, type, "")) {
+                index = g_irdb.manufacturer_index.emplace(type, ctrlm_irdb_prefix_index_t(all)).first;
+            } else {
+                if (!unindexed) {
+                    XLOGD_WARN("unable to load manufacturer list for type <%d>", type);
+                    g_irdb.manufacturer_unindexed.insert(type);
+                }
+                if (!prefix.empty() && (ret = (*g_irdb.pluginGetManufacturers)(manufacturers, type, prefix))) {
+                    count = ctrlm_irdb_list_page(manufacturers, offset, limit);
+                }
+            }
+        }
+        if (index != g_irdb.manufacturer_index.end()) {
+            count = index->second.find(prefix, offset, limit, manufacturers);
+            ret   = true;
+        }
+    }
+    if (total) {
+        *total = count;
     }
     return ret;
 }
 
-bool ctrlm_irdb_interface_t::get_models(ctrlm_irdb_model_list_t &models, ctrlm_irdb_dev_type_t type, const std::string &manufacturer, const std::string &prefix) {
+bool ctrlm_irdb_interface_t::get_models(ctrlm_irdb_model_list_t &models, ctrlm_irdb_dev_type_t type, const std::string &manufacturer, const std::string &prefix, size_t offset, size_t limit, size_t *total) {
     std::unique_lock<std::mutex> guard(m_mutex);
     bool ret = false;
+    size_t count = 0;
 
     if (g_irdb.pluginGetModels) {
-        ret = (*g_irdb.pluginGetModels)(models, type, manufacturer, prefix);
+        auto key   = std::make_pair(type, manufacturer);
+        auto index = g_irdb.model_index.find(key);
+        if (index == g_irdb.model_index.end()) {
+            // Load the manufacturer's full list once, type-ahead queries are then answered from the index
+            ctrlm_irdb_model_list_t all;
+            bool unindexed = g_irdb.model_unindexed.count(key) > 0;
+            if (!unindexed && (*g_irdb.pluginGetModels)(all, type, manufacturer, "")) {
+                if (g_irdb.model_index.size() >= CTRLM_IRDB_MODEL_INDEX_QTY_MAX) {
+                    g_irdb.model_index.clear();
+                }
+                index = g_irdb.model_index.emplace(key, ctrlm_irdb_prefix_index_t(all)).first;
+            } else {
+                if (!unindexed) { // same as the manufacturer list, don't retry the full list for each keystroke
+                    XLOGD_WARN("unable to load model list for type <%d> manufacturer <%s>", type, manufacturer.c_str());
+                    if (g_irdb.model_unindexed.size() >= CTRLM_IRDB_MODEL_INDEX_QTY_MAX) {
+                        g_irdb.model_unindexed.clear();
+                    }
+                    g_irdb.model_unindexed.insert(key);
+                }
+                if (!prefix.empty() && (ret = (*g_irdb.pluginGetModels)(models, type, manufacturer, prefix))) {
+                    count = ctrlm_irdb_list_page(models, offset, limit);
+                }
+            }
+        }
+        if (index != g_irdb.model_index.end()) {
+            count = index->second.find(prefix, offset, limit, models);
+            ret   = true;
+        }
+    }
+    if (total) {
+        *total = count;
     }
     return ret;
 }
@@ -448,6 +600,7 @@ bool ctrlm_irdb_interface_t::get_ir_codes_by_autolookup(ctrlm_autolookup_ranked_
     std::unique_lock<std::mutex> guard(m_mutex);
     bool ret = false;
     std::vector<ctrlm_irdb_t2_autolookup_entry_t> t2_info;
+    std::vector<ctrlm_irdb_autolookup_task_t> tasks;
 
     // Retrieve vendor info now while mutex is held (avoids recursive lock via get_vendor_info())
     ctrlm_irdb_vendor_info_t t2_vendor_info{};
@@ -456,76 +609,28 @@ bool ctrlm_irdb_interface_t::get_ir_codes_by_autolookup(ctrlm_autolookup_ranked_
     }
 
     #if defined(CTRLM_THUNDER)
+    std::vector<Thunder::CEC::cec_device_t> cec_devices;
+    bool cec_available = false;
+
     if(m_platform_tv == false) {
         // Check EDID data
         std::vector<uint8_t> edid;
         if(g_irdb.display_settings) {
             g_irdb.display_settings->get_edid(edid);
             if(edid.size() > 0) {
-                ctrlm_irdb_dev_type_t type = CTRLM_IRDB_DEV_TYPE_INVALID;
-                ctrlm_irdb_autolookup_ranked_list_t ir_codes;
-                
-                if(g_irdb.pluginGetCodesByEdid && (*g_irdb.pluginGetCodesByEdid)(ir_codes, type, edid.data(), edid.size()) == true) {
-                    if(ir_codes.size() > 0) {
-                        if(type != CTRLM_IRDB_DEV_TYPE_INVALID) {
-                            codes[type].insert(codes[type].end(), ir_codes.begin(), ir_codes.end());
-                            ret = true;
-                            t2_info.emplace_back(-1, CTRLM_IRDB_AUTOLOOKUP_SOURCE_EDID, CTRLM_IRDB_AUTOLOOKUP_RESULT_SUCCESS);
-                        } else {
-                            XLOGD_ERROR("edid dev type invalid");
-                            t2_info.emplace_back(-1, CTRLM_IRDB_AUTOLOOKUP_SOURCE_EDID, CTRLM_IRDB_AUTOLOOKUP_RESULT_DEV_TYPE_INVALID);
-                        }
-                    } else {
-                        XLOGD_ERROR("no codes for edid data");
-                        t2_info.emplace_back(-1, CTRLM_IRDB_AUTOLOOKUP_SOURCE_EDID, CTRLM_IRDB_AUTOLOOKUP_RESULT_NO_CODES_FOR_SOURCE);
-                    }
-                } else {
-                    XLOGD_ERROR("Failed getting codes by edid");
-                    t2_info.emplace_back(-1, CTRLM_IRDB_AUTOLOOKUP_SOURCE_EDID, CTRLM_IRDB_AUTOLOOKUP_RESULT_FAILED);
-                }
+                tasks.emplace_back(-1, CTRLM_IRDB_AUTOLOOKUP_SOURCE_EDID);
+                tasks.back().data = std::move(edid);
             } else {
                 XLOGD_ERROR("No EDID data");
-                t2_info.emplace_back(-1, CTRLM_IRDB_AUTOLOOKUP_SOURCE_EDID, CTRLM_IRDB_AUTOLOOKUP_RESULT_NO_SOURCE_DATA);
+                tasks.emplace_back(-1, CTRLM_IRDB_AUTOLOOKUP_SOURCE_EDID, CTRLM_IRDB_AUTOLOOKUP_RESULT_NO_SOURCE_DATA);
             }
         } else {
             XLOGD_ERROR("display_settings is NULL");
-            t2_info.emplace_back(-1, CTRLM_IRDB_AUTOLOOKUP_SOURCE_EDID, CTRLM_IRDB_AUTOLOOKUP_RESULT_NULL);
+            tasks.emplace_back(-1, CTRLM_IRDB_AUTOLOOKUP_SOURCE_EDID, CTRLM_IRDB_AUTOLOOKUP_RESULT_NULL);
         }
         if(g_irdb.cec_source) {
-            // Check CEC data
-            std::vector<Thunder::CEC::cec_device_t> cec_devices;
             g_irdb.cec_source->get_cec_devices(cec_devices);
-            if(cec_devices.size() > 0) {
-                for(auto &itr : cec_devices) {
-                    ctrlm_irdb_dev_type_t type = CTRLM_IRDB_DEV_TYPE_INVALID;
-                    ctrlm_irdb_autolookup_ranked_list_t ir_codes;
-
-                    if(g_irdb.pluginGetCodesByCec && (*g_irdb.pluginGetCodesByCec)(ir_codes, type, itr.osd, (unsigned int)itr.vendor_id, itr.logical_address) == true) {
-                        if(ir_codes.size() > 0) {
-                            if(type != CTRLM_IRDB_DEV_TYPE_INVALID) {
-                                codes[type].insert(codes[type].end(), ir_codes.begin(), ir_codes.end());
-                                ret = true;
-                                t2_info.emplace_back(itr.port, CTRLM_IRDB_AUTOLOOKUP_SOURCE_CEC, CTRLM_IRDB_AUTOLOOKUP_RESULT_SUCCESS);
-                            } else {
-                                XLOGD_ERROR("cec dev type invalid");
-                                t2_info.emplace_back(itr.port, CTRLM_IRDB_AUTOLOOKUP_SOURCE_CEC, CTRLM_IRDB_AUTOLOOKUP_RESULT_DEV_TYPE_INVALID);
-                            }
-                        } else {
-                            XLOGD_WARN("no code for cec device <%s>", itr.osd.c_str());
-                            t2_info.emplace_back(itr.port, CTRLM_IRDB_AUTOLOOKUP_SOURCE_CEC, CTRLM_IRDB_AUTOLOOKUP_RESULT_NO_CODES_FOR_SOURCE);
-                        }
-                    } else {
-                        XLOGD_WARN("Failed to get codes for cec device <%s>", itr.osd.c_str());
-                        t2_info.emplace_back(itr.port, CTRLM_IRDB_AUTOLOOKUP_SOURCE_CEC, CTRLM_IRDB_AUTOLOOKUP_RESULT_FAILED);
-                    }
-                }
-            } else {
-                XLOGD_ERROR("No CEC device data");
-                t2_info.emplace_back(-1, CTRLM_IRDB_AUTOLOOKUP_SOURCE_CEC, CTRLM_IRDB_AUTOLOOKUP_RESULT_NO_SOURCE_DATA);
-            }
-        } else {
-            XLOGD_ERROR("cec is NULL");
-            t2_info.emplace_back(-1, CTRLM_IRDB_AUTOLOOKUP_SOURCE_CEC, CTRLM_IRDB_AUTOLOOKUP_RESULT_NULL);
+            cec_available = true;
         }
     } else {
         if(g_irdb.av_input) {
@@ -534,72 +639,93 @@ bool ctrlm_irdb_interface_t::get_ir_codes_by_autolookup(ctrlm_autolookup_ranked_
             g_irdb.av_input->get_infoframes(infoframes);
             for(auto &itr : infoframes) {
                 if(itr.second.size() > 0) {
-                    ctrlm_irdb_dev_type_t type = CTRLM_IRDB_DEV_TYPE_INVALID;
-                    ctrlm_irdb_autolookup_ranked_list_t ir_codes;
-                    if(g_irdb.pluginGetCodesByInfoframe && (*g_irdb.pluginGetCodesByInfoframe)(ir_codes, type, itr.second.data(), itr.second.size()) == true) {
-                        if(ir_codes.size() > 0) {
-                            if(type != CTRLM_IRDB_DEV_TYPE_INVALID) {
-                                codes[type].insert(codes[type].end(), ir_codes.begin(), ir_codes.end());
-                                ret = true;
-                                t2_info.emplace_back(itr.first, CTRLM_IRDB_AUTOLOOKUP_SOURCE_INFOFRAME, CTRLM_IRDB_AUTOLOOKUP_RESULT_SUCCESS);
-                            } else {
-                                XLOGD_ERROR("port %d infoframe dev type invalid", itr.first);
-                                t2_info.emplace_back(itr.first, CTRLM_IRDB_AUTOLOOKUP_SOURCE_INFOFRAME, CTRLM_IRDB_AUTOLOOKUP_RESULT_DEV_TYPE_INVALID);
-                            }
-                        } else {
-                            XLOGD_WARN("no code for port %d infoframe", itr.first);
-                            t2_info.emplace_back(itr.first, CTRLM_IRDB_AUTOLOOKUP_SOURCE_INFOFRAME, CTRLM_IRDB_AUTOLOOKUP_RESULT_NO_CODES_FOR_SOURCE);
-                        }
-                    } else {
-                        XLOGD_WARN("Failed to get codes for port %d infoframe", itr.first);
-                        t2_info.emplace_back(itr.first, CTRLM_IRDB_AUTOLOOKUP_SOURCE_INFOFRAME, CTRLM_IRDB_AUTOLOOKUP_RESULT_FAILED);
-                    }
+                    tasks.emplace_back(itr.first, CTRLM_IRDB_AUTOLOOKUP_SOURCE_INFOFRAME);
+                    tasks.back().data = std::move(itr.second);
                 } else {
                     XLOGD_WARN("no infoframe for port %d", itr.first);
-                    t2_info.emplace_back(itr.first, CTRLM_IRDB_AUTOLOOKUP_SOURCE_INFOFRAME, CTRLM_IRDB_AUTOLOOKUP_RESULT_NO_SOURCE_DATA);
+                    tasks.emplace_back(itr.first, CTRLM_IRDB_AUTOLOOKUP_SOURCE_INFOFRAME, CTRLM_IRDB_AUTOLOOKUP_RESULT_NO_SOURCE_DATA);
                 }
             }
         } else {
             XLOGD_ERROR("hdmi is NULL");
-            t2_info.emplace_back(-1, CTRLM_IRDB_AUTOLOOKUP_SOURCE_INFOFRAME, CTRLM_IRDB_AUTOLOOKUP_RESULT_NULL);
+            tasks.emplace_back(-1, CTRLM_IRDB_AUTOLOOKUP_SOURCE_INFOFRAME, CTRLM_IRDB_AUTOLOOKUP_RESULT_NULL);
         }
         if(g_irdb.cec_sink) {
-            // Check CEC data
-            std::vector<Thunder::CEC::cec_device_t> cec_devices;
             g_irdb.cec_sink->get_cec_devices(cec_devices);
-            if(cec_devices.size() > 0) {
-                for(auto &itr : cec_devices) {
-                    ctrlm_irdb_dev_type_t type = CTRLM_IRDB_DEV_TYPE_INVALID;
-                    ctrlm_irdb_autolookup_ranked_list_t ir_codes;
-                    if(g_irdb.pluginGetCodesByCec && (*g_irdb.pluginGetCodesByCec)(ir_codes, type, itr.osd, (unsigned int)itr.vendor_id, itr.logical_address) == true) {
-                        if(ir_codes.size() > 0) {
-                            if(type != CTRLM_IRDB_DEV_TYPE_INVALID) {
-                                codes[type].insert(codes[type].end(), ir_codes.begin(), ir_codes.end());
-                                ret = true;
-                                t2_info.emplace_back(itr.port, CTRLM_IRDB_AUTOLOOKUP_SOURCE_CEC, CTRLM_IRDB_AUTOLOOKUP_RESULT_SUCCESS);
-                            } else {
-                                XLOGD_ERROR("cec dev type invalid");
-                                t2_info.emplace_back(itr.port, CTRLM_IRDB_AUTOLOOKUP_SOURCE_CEC, CTRLM_IRDB_AUTOLOOKUP_RESULT_DEV_TYPE_INVALID);
-                            }
-                        } else {
-                            XLOGD_WARN("no code for cec device <%s>", itr.osd.c_str());
-                            t2_info.emplace_back(itr.port, CTRLM_IRDB_AUTOLOOKUP_SOURCE_CEC, CTRLM_IRDB_AUTOLOOKUP_RESULT_NO_CODES_FOR_SOURCE);
-                        }
+            cec_available = true;
+        }
+    }
+
+    // Check CEC data
+    if(cec_available) {
+        if(cec_devices.size() > 0) {
+            for(auto &itr : cec_devices) {
+                tasks.emplace_back(itr.port, CTRLM_IRDB_AUTOLOOKUP_SOURCE_CEC);
+                tasks.back().osd             = itr.osd;
+                tasks.back().vendor_id       = (unsigned int)itr.vendor_id;
+                tasks.back().logical_address = itr.logical_address;
+            }
+        } else {
+            XLOGD_ERROR("No CEC device data");
+            tasks.emplace_back(-1, CTRLM_IRDB_AUTOLOOKUP_SOURCE_CEC, CTRLM_IRDB_AUTOLOOKUP_RESULT_NO_SOURCE_DATA);
+        }
+    } else {
+        XLOGD_ERROR("cec is NULL");
+        tasks.emplace_back(-1, CTRLM_IRDB_AUTOLOOKUP_SOURCE_CEC, CTRLM_IRDB_AUTOLOOKUP_RESULT_NULL);
+    }
+    #endif
+
+    // Sources that are unchanged since a previous lookup are served from the memo, the rest are looked up concurrently
+    std::vector<ctrlm_irdb_autolookup_task_t *> pending;
+    for(auto &task : tasks) {
+        if(task.result != CTRLM_IRDB_AUTOLOOKUP_RESULT_UNKNOWN) {
+            continue;
+        }
+        task.key = ctrlm_irdb_autolookup_key(task);
+        auto memo = g_irdb.autolookup_memo.find(task.key);
+        if(memo != g_irdb.autolookup_memo.end()) {
+            task.type     = memo->second.type;
+            task.ir_codes = memo->second.ir_codes;
+            task.success  = true;
+            task.memoized = true;
+        } else {
+            pending.push_back(&task);
+        }
+    }
+    XLOGD_INFO("autolookup sources <%zu> memoized <%zu>", tasks.size(), tasks.size() - pending.size());
+    ctrlm_irdb_autolookup_tasks_run(pending);
+
+    // Results are merged in source order so ties in rank keep the same order as a sequential lookup
+    for(auto &task : tasks) {
+        if(task.result == CTRLM_IRDB_AUTOLOOKUP_RESULT_UNKNOWN) {
+            std::string source = ctrlm_irdb_autolookup_source_str(task);
+            if(task.success) {
+                if(!task.memoized) {
+                    if(g_irdb.autolookup_memo.size() >= CTRLM_IRDB_AUTOLOOKUP_MEMO_QTY_MAX) {
+                        g_irdb.autolookup_memo.clear();
+                    }
+                    g_irdb.autolookup_memo[task.key] = { task.type, task.ir_codes };
+                }
+                if(task.ir_codes.size() > 0) {
+                    if(task.type != CTRLM_IRDB_DEV_TYPE_INVALID) {
+                        codes[task.type].insert(codes[task.type].end(), task.ir_codes.begin(), task.ir_codes.end());
+                        ret = true;
+                        task.result = CTRLM_IRDB_AUTOLOOKUP_RESULT_SUCCESS;
                     } else {
-                        XLOGD_WARN("Failed to get codes for cec device <%s>", itr.osd.c_str());
-                        t2_info.emplace_back(itr.port, CTRLM_IRDB_AUTOLOOKUP_SOURCE_CEC, CTRLM_IRDB_AUTOLOOKUP_RESULT_FAILED);
+                        XLOGD_ERROR("%s dev type invalid", source.c_str());
+                        task.result = CTRLM_IRDB_AUTOLOOKUP_RESULT_DEV_TYPE_INVALID;
                     }
+                } else {
+                    XLOGD_WARN("no codes for %s", source.c_str());
+                    task.result = CTRLM_IRDB_AUTOLOOKUP_RESULT_NO_CODES_FOR_SOURCE;
                 }
             } else {
-                XLOGD_ERROR("No CEC device data");
-                t2_info.emplace_back(-1, CTRLM_IRDB_AUTOLOOKUP_SOURCE_CEC, CTRLM_IRDB_AUTOLOOKUP_RESULT_NO_SOURCE_DATA);
+                XLOGD_WARN("Failed to get codes for %s", source.c_str());
+                task.result = CTRLM_IRDB_AUTOLOOKUP_RESULT_FAILED;
             }
-        } else {
-            XLOGD_ERROR("cec is NULL");
-            t2_info.emplace_back(-1, CTRLM_IRDB_AUTOLOOKUP_SOURCE_CEC, CTRLM_IRDB_AUTOLOOKUP_RESULT_NULL);
         }
+        t2_info.emplace_back(task.port, task.source, task.result);
     }
-    #endif
 
     // Sort the code lists by the rank value in descending order so that the best codes are listed first in the lists.
     if(codes.count(CTRLM_IRDB_DEV_TYPE_TV) > 0) {
@@ -642,6 +768,106 @@ bool ctrlm_irdb_interface_t::get_ir_codes_by_autolookup(ctrlm_autolookup_ranked_
     return(ret);
 }
 
+std::string ctrlm_irdb_autolookup_key(const ctrlm_irdb_autolookup_task_t &task) {
+    // The key holds the complete source data so a changed EDID, infoframe or CEC device never hits a stale entry
+    std::string key = std::to_string(task.source) + ":";
+    if(task.source == CTRLM_IRDB_AUTOLOOKUP_SOURCE_CEC) {
+        key += std::to_string(task.vendor_id) + ":" + std::to_string(task.logical_address) + ":" + task.osd;
+    } else {
+        key.append(task.data.begin(), task.data.end());
+    }
+    return(key);
+}
+
+std::string ctrlm_irdb_autolookup_source_str(const ctrlm_irdb_autolookup_task_t &task) {
+    switch(task.source) {
+        case CTRLM_IRDB_AUTOLOOKUP_SOURCE_EDID:      return("edid");
+        case CTRLM_IRDB_AUTOLOOKUP_SOURCE_CEC:       return("cec device <" + task.osd + ">");
+        case CTRLM_IRDB_AUTOLOOKUP_SOURCE_INFOFRAME: return("port " + std::to_string(task.port) + " infoframe");
+        default: break;
+    }
+    return("unknown source");
+}
+
+void ctrlm_irdb_autolookup_task_run(gpointer data, gpointer user_data) {
+    ctrlm_irdb_autolookup_task_t *task = (ctrlm_irdb_autolookup_task_t *)data;
+    switch(task->source) {
+        case CTRLM_IRDB_AUTOLOOKUP_SOURCE_EDID: {
+            if(g_irdb.pluginGetCodesByEdid) {
+                task->success = (*g_irdb.pluginGetCodesByEdid)(task->ir_codes, task->type, task->data.data(), task->data.size());
+            }
+            break;
+        }
+        case CTRLM_IRDB_AUTOLOOKUP_SOURCE_CEC: {
+            if(g_irdb.pluginGetCodesByCec) {
+                task->success = (*g_irdb.pluginGetCodesByCec)(task->ir_codes, task->type, task->osd, task->vendor_id, task->logical_address);
+            }
+            break;
+        }
+        case CTRLM_IRDB_AUTOLOOKUP_SOURCE_INFOFRAME: {
+            if(g_irdb.pluginGetCodesByInfoframe) {
+                task->success = (*g_irdb.pluginGetCodesByInfoframe)(task->ir_codes, task->type, task->data.data(), task->data.size());
+            }
+            break;
+        }
+        default: {
+            XLOGD_ERROR("invalid source <%d>", task->source);
+            break;
+        }
+    }
+}
+
+void ctrlm_irdb_autolookup_tasks_run(std::vector<ctrlm_irdb_autolookup_task_t *> &tasks) {
+    if(tasks.empty()) {
+        return;
+    }
+    GThreadPool *pool = NULL;
+    if(tasks.size() > 1 && g_irdb.autolookup_concurrent) {
+        GError *error = NULL;
+        pool = g_thread_pool_new(ctrlm_irdb_autolookup_task_run, NULL, std::min(tasks.size(), (size_t)CTRLM_IRDB_AUTOLOOKUP_THREAD_QTY_MAX), TRUE, &error);
+        if(pool == NULL) {
+            XLOGD_WARN("failed to create thread pool <%s>, looking up sequentially", (error ? error->message : ""));
+            g_clear_error(&error);
+        }
+    }
+    if(pool == NULL) {
+        for(auto task : tasks) {
+            ctrlm_irdb_autolookup_task_run((gpointer)task, NULL);
+        }
+        return;
+    }
+    for(auto task : tasks) {
+        if(!g_thread_pool_push(pool, (gpointer)task, NULL)) {
+            ctrlm_irdb_autolookup_task_run((gpointer)task, NULL);
+        }
+    }
+    // Waits for all of the lookups to complete
+    g_thread_pool_free(pool, FALSE, TRUE);
+}
+
+// Trims a list returned directly by the plugin to the requested page and returns the number of entries before trimming
+size_t ctrlm_irdb_list_page(std::vector<std::string> &names, size_t offset, size_t limit) {
+    size_t total = names.size();
+    if (offset >= total) {
+        names.clear();
+        return(total);
+    }
+    if (limit != 0 && offset + limit < total) {
+        names.erase(names.begin() + offset + limit, names.end());
+    }
+    names.erase(names.begin(), names.begin() + offset);
+    return(total);
+}
+
+// Drops the results that depend on the plugin and vendor.  Called with m_mutex held.
+void ctrlm_irdb_lists_clear() {
+    g_irdb.autolookup_memo.clear();
+    g_irdb.manufacturer_index.clear();
+    g_irdb.model_index.clear();
+    g_irdb.manufacturer_unindexed.clear();
+    g_irdb.model_unindexed.clear();
+}
+
 bool ctrlm_irdb_interface_t::program_ir_codes(ctrlm_network_id_t network_id, ctrlm_controller_id_t controller_id, ctrlm_irdb_dev_type_t type, const std::string &id) {
     std::unique_lock<std::mutex> guard(m_mutex);
     bool ret = false;
@@ -70,8 +70,9 @@ public:
 
    bool get_vendor_info(ctrlm_irdb_vendor_info_t &info);
    bool set_vendor(const ctrlm_irdb_vendor_info_t &info);
-   bool get_manufacturers(ctrlm_irdb_manufacturer_list_t &manufacturers, ctrlm_irdb_dev_type_t type, const std::string &prefix = "");
-   bool get_models(ctrlm_irdb_model_list_t &models, ctrlm_irdb_dev_type_t type, const std::string &manufacturer, const std::string &prefix = "");
+   // Prefix matches are case insensitive and sorted. A limit of 0 returns every match from offset on, total is set to the number of matches.
+   bool get_manufacturers(ctrlm_irdb_manufacturer_list_t &manufacturers, ctrlm_irdb_dev_type_t type, const std::string &prefix = "", size_t offset = 0, size_t limit = 0, size_t *total = NULL);
+   bool get_models(ctrlm_irdb_model_list_t &models, ctrlm_irdb_dev_type_t type, const std::string &manufacturer, const std::string &prefix = "", size_t offset = 0, size_t limit = 0, size_t *total = NULL);
    bool get_irdb_entry_ids(ctrlm_irdb_entry_id_list_t &codes, ctrlm_irdb_dev_type_t type, const std::string &manufacturer, const std::string &model = "");
    bool program_ir_codes(ctrlm_network_id_t network_id, ctrlm_controller_id_t controller_id, ctrlm_irdb_dev_type_t type, const std::string &name);
    bool clear_ir_codes(ctrlm_network_id_t network_id, ctrlm_controller_id_t controller_id);
@@ -110,6 +110,10 @@ bool ctrlm_irdb_get_ir_codes_by_edid(ctrlm_irdb_autolookup_ranked_list_t &codes,
 
 bool ctrlm_irdb_get_ir_codes_by_cec(ctrlm_irdb_autolookup_ranked_list_t &codes, ctrlm_irdb_dev_type_t &type, const std::string &osd, unsigned int vendor_id, unsigned int logical_address);
 
+// Optional.  Returns true if the get_ir_codes_by_* calls may be made concurrently from different threads.  When it is not
+// exported the autolookup sources are looked up one at a time.
+bool ctrlm_irdb_autolookup_concurrent();
+
 #ifdef __cplusplus
 }
 #endif
@@ -36,6 +36,9 @@ namespace {
     constexpr char const* CODES         = "codes";
     constexpr char const* REMOTE_ID     = "remoteId";
     constexpr char const* SUCCESS       = "success";
+    constexpr char const* OFFSET        = "offset";
+    constexpr char const* LIMIT         = "limit";
+    constexpr char const* TOTAL         = "total";
     constexpr char const* TV            = "TV";
     constexpr char const* AMP           = "AMP";
 }
@@ -107,6 +110,8 @@ IARM_Result_t ctrlm_irdb_ipc_iarm_thunder_t::get_manufacturers(void *arg) {
     ctrlm_irdb_dev_type_t dev_type         = CTRLM_IRDB_DEV_TYPE_INVALID;
     std::string av_dev_str;
     std::string manufacturer;
+    int offset = 0, limit = 0;
+    size_t total = 0;
     json_config conf;
 
     if(call_data == NULL || call_data->api_revision != CTRLM_MAIN_IARM_BUS_API_REVISION) {
@@ -130,6 +135,10 @@ IARM_Result_t ctrlm_irdb_ipc_iarm_thunder_t::get_manufacturers(void *arg) {
         return(IARM_RESULT_INVALID_PARAM);
     }
 
+    // Paging is optional, without it every match is returned
+    conf.config_value_get(OFFSET, offset, 0);
+    conf.config_value_get(LIMIT, limit, 0);
+
     if(!ctrlm_irdb_dev_type_is_valid(av_dev_str, ir_dev_type)) {
         XLOGD_ERROR("Invalid %s type <%s>", AV_DEV_TYPE, av_dev_str.c_str());
         return(IARM_RESULT_INVALID_PARAM);
@@ -143,7 +152,7 @@ IARM_Result_t ctrlm_irdb_ipc_iarm_thunder_t::get_manufacturers(void *arg) {
     if(irdb && success) {
         manufacturers = json_array();
         ctrlm_irdb_manufacturer_list_t mans;
-        if(irdb->get_manufacturers(mans, dev_type, manufacturer) == false ) {
+        if(irdb->get_manufacturers(mans, dev_type, manufacturer, offset, limit, &total) == false ) {
             XLOGD_ERROR("Failed getting manufacturers");
             success = false;
         } else {
@@ -169,6 +178,7 @@ IARM_Result_t ctrlm_irdb_ipc_iarm_thunder_t::get_manufacturers(void *arg) {
     if(success) {
         json_object_set_new(ret, AV_DEV_TYPE,  json_string(ctrlm_irdb_ipc_iarm_thunder_t::ctrlm_irdb_dev_type_str(dev_type)));
         json_object_set_new(ret, MANUFACTURERS, (manufacturers != NULL ? manufacturers : json_null()));
+        json_object_set_new(ret, TOTAL,         json_integer(total));
     }
     if (!ctrlm_json_to_iarm_call_data_result(ret, call_data)) {
         json_decref(ret);
@@ -187,6 +197,8 @@ IARM_Result_t ctrlm_irdb_ipc_iarm_thunder_t::get_models(void *arg) {
     ctrlm_ir_device_type_t ir_dev_type     = CTRLM_IR_DEVICE_UNKNOWN;
     ctrlm_irdb_dev_type_t dev_type         = CTRLM_IRDB_DEV_TYPE_INVALID;
     std::string av_dev_str, manufacturer, model;
+    int offset = 0, limit = 0;
+    size_t total = 0;
     json_config conf;
 
     if(call_data == NULL || call_data->api_revision != CTRLM_MAIN_IARM_BUS_API_REVISION) {
@@ -215,6 +227,10 @@ IARM_Result_t ctrlm_irdb_ipc_iarm_thunder_t::get_models(void *arg) {
         return(IARM_RESULT_INVALID_PARAM);
     }
 
+    // Paging is optional, without it every match is returned
+    conf.config_value_get(OFFSET, offset, 0);
+    conf.config_value_get(LIMIT, limit, 0);
+
     if(!ctrlm_irdb_dev_type_is_valid(av_dev_str, ir_dev_type)) {
         XLOGD_ERROR("Invalid %s type <%s>", AV_DEV_TYPE, av_dev_str.c_str());
         return(IARM_RESULT_INVALID_PARAM);
@@ -228,7 +244,7 @@ IARM_Result_t ctrlm_irdb_ipc_iarm_thunder_t::get_models(void *arg) {
     if(irdb && success) {
         models = json_array();
         ctrlm_irdb_model_list_t mods;
-        if(irdb->get_models(mods, dev_type, manufacturer, model) == false ) {
+        if(irdb->get_models(mods, dev_type, manufacturer, model, offset, limit, &total) == false ) {
             XLOGD_ERROR("Failed getting models");
             success = false;
         } else {
@@ -255,6 +271,7 @@ IARM_Result_t ctrlm_irdb_ipc_iarm_thunder_t::get_models(void *arg) {
         json_object_set_new(ret, AV_DEV_TYPE,  json_string(ctrlm_irdb_ipc_iarm_thunder_t::ctrlm_irdb_dev_type_str(dev_type)));
         json_object_set_new(ret, MANUFACTURER, json_string(manufacturer.c_str()));
         json_object_set_new(ret, MODELS,       (models != NULL ? models : json_null()));
+        json_object_set_new(ret, TOTAL,        json_integer(total));
     }
     if (!ctrlm_json_to_iarm_call_data_result(ret, call_data)) {
         json_decref(ret);
@@ -20,6 +20,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <glib.h>
+#include <atomic>
 #include "ctrlm.h"
 #include "ctrlm_log.h"
 #include "ctrlm_rcu.h"
@@ -38,6 +39,22 @@ typedef enum {
    CRTLM_VOICE_REMOTE_VOICE_END_TIMEOUT_INTERPACKET  =  9
 } ctrlm_voice_remote_voice_end_reason_t;
 
+#define CTRLM_RF4CE_IND_DATA_STATS_PROFILE_QTY (3)                        // rcu, voice and device update profiles
+#define CTRLM_RF4CE_IND_DATA_STATS_INTERVAL_US (15ULL * 60 * 1000000)     // log the data indication statistics every 15 minutes
+
+// Data indication counters per profile. Packets are counted in the HAL thread and latency (HAL indication to
+// handler start) is added in the main thread so every field is atomic.
+typedef struct {
+   std::atomic<unsigned long>      packet_qty;
+   std::atomic<unsigned long>      fast_qty;
+   std::atomic<unsigned long>      latency_qty;
+   std::atomic<unsigned long long> latency_us_total;
+   std::atomic<unsigned long long> latency_us_max;
+} ctrlm_rf4ce_ind_data_stats_t;
+
+static ctrlm_rf4ce_ind_data_stats_t    g_ctrlm_rf4ce_ind_data_stats[CTRLM_RF4CE_IND_DATA_STATS_PROFILE_QTY];
+static std::atomic<unsigned long long> g_ctrlm_rf4ce_ind_data_stats_start_us(0);
+
 static ctrlm_hal_result_t ctrlm_hal_rf4ce_ind_discovery_int(ctrlm_network_id_t id, ctrlm_hal_rf4ce_ind_disc_params_t params, ctrlm_hal_rf4ce_rsp_disc_params_t *rsp_params, ctrlm_hal_rf4ce_rsp_discovery_t cb, void *cb_data, sem_t *semaphore);
 static ctrlm_hal_result_t ctrlm_hal_rf4ce_ind_pair_int(ctrlm_network_id_t id, ctrlm_hal_rf4ce_ind_pair_params_t params, ctrlm_hal_rf4ce_rsp_pair_params_t *rsp_params, ctrlm_hal_rf4ce_rsp_pair_t cb, void *cb_data, sem_t *semaphore);
 static ctrlm_hal_result_t ctrlm_hal_rf4ce_ind_discovery_async(ctrlm_network_id_t id, ctrlm_hal_rf4ce_ind_disc_params_t params, ctrlm_hal_rf4ce_rsp_discovery_t cb, void *cb_data);
@@ -47,6 +64,8 @@ static ctrlm_hal_result_t ctrlm_hal_rf4ce_ind_pair_sync(ctrlm_network_id_t id, c
 static ctrlm_hal_result_t ctrlm_hal_rf4ce_ind_unpair_async(ctrlm_network_id_t id, ctrlm_hal_rf4ce_ind_unpair_params_t params, ctrlm_hal_rf4ce_rsp_unpair_t cb, void *cb_data);
 static ctrlm_hal_result_t ctrlm_hal_rf4ce_ind_unpair_sync(ctrlm_network_id_t id, ctrlm_hal_rf4ce_ind_unpair_params_t params, ctrlm_hal_rf4ce_rsp_unpair_params_t *rsp_params);
 static ctrlm_voice_format_t ctrlm_rf4ce_audio_fmt_to_voice_fmt(ctrlm_rf4ce_audio_format_t format);
+static void                 ctrlm_rf4ce_ind_data_stats_packet(ctrlm_hal_rf4ce_profile_id_t profile_id, bool fast, const ctrlm_timestamp_t *received);
+static void                 ctrlm_rf4ce_ind_data_stats_log(unsigned long long interval_us);
 
 ctrlm_hal_result_t ctrlm_hal_rf4ce_ind_discovery_int(ctrlm_network_id_t id, ctrlm_hal_rf4ce_ind_disc_params_t params, ctrlm_hal_rf4ce_rsp_disc_params_t *rsp_params, ctrlm_hal_rf4ce_rsp_discovery_t cb, void *cb_data, sem_t *semaphore) {
 
@@ -305,9 +324,14 @@ ctrlm_hal_result_t ctrlm_hal_rf4ce_ind_data(ctrlm_network_id_t network_id, ctrlm
       return(CTRLM_HAL_RESULT_ERROR);
    }
 
+   ctrlm_timestamp_t received;
+   ctrlm_timestamp_get_monotonic(&received);
+
    if(params.profile_id == CTRLM_RF4CE_PROFILE_ID_VOICE) {
       ctrlm_hal_frequency_agility_t frequency_agility = CTRLM_HAL_FREQUENCY_AGILITY_NO_CHANGE;
+      ctrlm_rf4ce_ind_data_stats_packet(params.profile_id, false, &received);
       ctrlm_hal_result_t result = ctrlm_voice_ind_data_rf4ce(network_id, controller_id, params.timestamp, params.command_id, params.length, params.data, params.cb_data_read, params.cb_data_param, params.lqi, &frequency_agility);
+      ctrlm_rf4ce_ind_data_latency_add(params.profile_id, &received);
 
       if(frequency_agility != CTRLM_HAL_FREQUENCY_AGILITY_NO_CHANGE) {
          // Change the frequency agility state
@@ -320,11 +344,61 @@ ctrlm_hal_result_t ctrlm_hal_rf4ce_ind_data(ctrlm_network_id_t network_id, ctrlm
       return(result);
    }
 
+   // Key presses and heartbeats make up most of the traffic. They are a few bytes long so they skip the full
+   // size message and go straight to their own handlers.
+   ctrlm_main_queue_msg_rf4ce_ind_data_fast_t fast = {0};
+   if(params.profile_id == CTRLM_RF4CE_PROFILE_ID_COMCAST_RCU && params.length <= CTRLM_RF4CE_IND_DATA_FAST_PAYLOAD_LEN) {
+      fast.controller_id = controller_id;
+      fast.timestamp     = params.timestamp;
+      fast.received      = received;
+      fast.length        = params.length;
+      if(params.data != NULL) {
+         errno_t safec_rc = memcpy_s(fast.data, sizeof(fast.data), params.data, params.length);
+         ERR_CHK(safec_rc);
+      } else if(params.length != params.cb_data_read(params.length, fast.data, params.cb_data_param)) {
+         XLOGD_ERROR("unable to read data!");
+         return(CTRLM_HAL_RESULT_ERROR);
+      }
+
+      ctrlm_msg_handler_network_t handler  = NULL;
+      ctrlm_main_queue_priority_t priority = CTRLM_MAIN_QUEUE_PRIORITY_BACKGROUND;
+      switch(fast.data[0]) {
+         case RF4CE_FRAME_CONTROL_USER_CONTROL_PRESSED:
+         case RF4CE_FRAME_CONTROL_USER_CONTROL_REPEATED:
+         case RF4CE_FRAME_CONTROL_USER_CONTROL_RELEASED: {
+            if(fast.length >= 2) {
+               // Key presses are latency sensitive so they bypass background work waiting in the main queue
+               handler  = (ctrlm_msg_handler_network_t)&ctrlm_obj_network_rf4ce_t::ind_process_data_key;
+               priority = CTRLM_MAIN_QUEUE_PRIORITY_INTERACTIVE;
+            }
+            break;
+         }
+         case RF4CE_FRAME_CONTROL_HEARTBEAT: {
+            if(fast.length >= 3) {
+               handler = (ctrlm_msg_handler_network_t)&ctrlm_obj_network_rf4ce_t::ind_process_data_heartbeat;
+            }
+            break;
+         }
+         default: break;
+      }
+      if(handler != NULL) {
+         ctrlm_rf4ce_ind_data_stats_packet(params.profile_id, true, &received);
+         ctrlm_main_queue_handler_push_priority(priority, CTRLM_HANDLER_NETWORK, handler, (void *)&fast, sizeof(fast), NULL, network_id);
+         return(CTRLM_HAL_RESULT_SUCCESS);
+      }
+      // Not a key or heartbeat frame so fall back to the full size message. The payload has already been
+      // read from the HAL, so it is taken from the compact message.
+      params.data = fast.data;
+   }
+
+   ctrlm_rf4ce_ind_data_stats_packet(params.profile_id, false, &received);
+
    // Allocate a message and send it to Control Manager's queue
    ctrlm_main_queue_msg_rf4ce_ind_data_t msg = {0};
 
    msg.controller_id     = controller_id;
    msg.timestamp         = params.timestamp;
+   msg.received          = received;
    msg.profile_id        = params.profile_id;
    msg.length            = params.length;
    if(params.data != NULL) {
@@ -337,11 +411,86 @@ ctrlm_hal_result_t ctrlm_hal_rf4ce_ind_data(ctrlm_network_id_t network_id, ctrlm
       }
    }
 
-   ctrlm_main_queue_handler_push(CTRLM_HANDLER_NETWORK, (ctrlm_msg_handler_network_t)&ctrlm_obj_network_rf4ce_t::ind_process_data, (void *)&msg, sizeof(msg), NULL, network_id);
+   // Key presses with a payload too large for the compact message still bypass background work
+   ctrlm_main_queue_priority_t priority = CTRLM_MAIN_QUEUE_PRIORITY_BACKGROUND;
+   if(msg.profile_id == CTRLM_RF4CE_PROFILE_ID_COMCAST_RCU) {
+      switch(msg.data[0]) {
+         case RF4CE_FRAME_CONTROL_USER_CONTROL_PRESSED:
+         case RF4CE_FRAME_CONTROL_USER_CONTROL_REPEATED:
+         case RF4CE_FRAME_CONTROL_USER_CONTROL_RELEASED: priority = CTRLM_MAIN_QUEUE_PRIORITY_INTERACTIVE; break;
+         default: break;
+      }
+   }
+   ctrlm_main_queue_handler_push_priority(priority, CTRLM_HANDLER_NETWORK, (ctrlm_msg_handler_network_t)&ctrlm_obj_network_rf4ce_t::ind_process_data, (void *)&msg, sizeof(msg), NULL, network_id);
 
    return(CTRLM_HAL_RESULT_SUCCESS);
 }
 
+// Count a data indication and log the statistics once the interval has elapsed. Called in the HAL thread.
+void ctrlm_rf4ce_ind_data_stats_packet(ctrlm_hal_rf4ce_profile_id_t profile_id, bool fast, const ctrlm_timestamp_t *received) {
+   unsigned int index = (unsigned int)profile_id - CTRLM_RF4CE_PROFILE_ID_COMCAST_RCU;
+   if(index >= CTRLM_RF4CE_IND_DATA_STATS_PROFILE_QTY) {
+      return;
+   }
+   ctrlm_rf4ce_ind_data_stats_t *stats = &g_ctrlm_rf4ce_ind_data_stats[index];
+   stats->packet_qty++;
+   if(fast) {
+      stats->fast_qty++;
+   }
+
+   unsigned long long now_us   = (unsigned long long)received->tv_sec * 1000000 + received->tv_nsec / 1000;
+   unsigned long long start_us = g_ctrlm_rf4ce_ind_data_stats_start_us.load();
+   if(start_us == 0) {
+      g_ctrlm_rf4ce_ind_data_stats_start_us.compare_exchange_strong(start_us, now_us);
+   } else if(now_us - start_us >= CTRLM_RF4CE_IND_DATA_STATS_INTERVAL_US && g_ctrlm_rf4ce_ind_data_stats_start_us.compare_exchange_strong(start_us, now_us)) {
+      ctrlm_rf4ce_ind_data_stats_log(now_us - start_us);
+   }
+}
+
+// Record the time from the HAL indication to the start of its processing
+void ctrlm_rf4ce_ind_data_latency_add(ctrlm_hal_rf4ce_profile_id_t profile_id, const ctrlm_timestamp_t *received) {
+   unsigned int index = (unsigned int)profile_id - CTRLM_RF4CE_PROFILE_ID_COMCAST_RCU;
+   if(index >= CTRLM_RF4CE_IND_DATA_STATS_PROFILE_QTY || received == NULL) {
+      return;
+   }
+   ctrlm_rf4ce_ind_data_stats_t *stats = &g_ctrlm_rf4ce_ind_data_stats[index];
+   ctrlm_timestamp_t now;
+   ctrlm_timestamp_get_monotonic(&now);
+   signed long long latency_us = ctrlm_timestamp_subtract_us(*received, now);
+   if(latency_us < 0) {
+      latency_us = 0;
+   }
+   stats->latency_qty++;
+   stats->latency_us_total += latency_us;
+   unsigned long long latency_us_max = stats->latency_us_max.load();
+   while((unsigned long long)latency_us > latency_us_max) {
+      if(stats->latency_us_max.compare_exchange_weak(latency_us_max, latency_us)) {
+         break;
+      }
+   }
+}
+
+void ctrlm_rf4ce_ind_data_stats_log(unsigned long long interval_us) {
+   static const char *profile_str[CTRLM_RF4CE_IND_DATA_STATS_PROFILE_QTY] = { "RCU", "VOICE", "DEVICE_UPDATE" };
+   unsigned long long interval_ms = (interval_us / 1000) ? (interval_us / 1000) : 1;
+
+   for(unsigned int index = 0; index < CTRLM_RF4CE_IND_DATA_STATS_PROFILE_QTY; index++) {
+      ctrlm_rf4ce_ind_data_stats_t *stats = &g_ctrlm_rf4ce_ind_data_stats[index];
+      unsigned long      packet_qty       = stats->packet_qty.exchange(0);
+      unsigned long      fast_qty         = stats->fast_qty.exchange(0);
+      unsigned long      latency_qty      = stats->latency_qty.exchange(0);
+      unsigned long long latency_us_total = stats->latency_us_total.exchange(0);
+      unsigned long long latency_us_max   = stats->latency_us_max.exchange(0);
+      if(packet_qty == 0) {
+         continue;
+      }
+      unsigned long long rate_milli = (unsigned long long)packet_qty * 1000000 / interval_ms; // packets per 1000 seconds
+
+      XLOGD_INFO("data ind <%s> packets <%lu> fast <%lu> rate <%llu.%03llu/s> latency avg <%llu> max <%llu> us", profile_str[index], packet_qty, fast_qty,
+                 rate_milli / 1000, rate_milli % 1000, (latency_qty ? latency_us_total / latency_qty : 0), latency_us_max);
+   }
+}
+
 // Note this thread is not called in control manager's context so it can't use global state unless a mutex is put in place
 ctrlm_hal_result_t ctrlm_voice_ind_data_rf4ce(ctrlm_network_id_t network_id, ctrlm_controller_id_t controller_id, ctrlm_timestamp_t timestamp, guchar command_id, unsigned long data_length, guchar *data, ctrlm_hal_rf4ce_data_read_t cb_data_read, void *cb_data_param, unsigned char lqi, ctrlm_hal_frequency_agility_t *frequency_agility) {
    ctrlm_hal_frequency_agility_t agility_state = CTRLM_HAL_FREQUENCY_AGILITY_NO_CHANGE;
@@ -397,7 +546,7 @@ ctrlm_hal_result_t ctrlm_voice_ind_data_rf4ce(ctrlm_network_id_t network_id, ctr
          errno_t safec_rc = memcpy_s(msg.data, sizeof(msg.data), request_data, request_data_len);
          ERR_CHK(safec_rc);
       }
-      ctrlm_main_queue_handler_push(CTRLM_HANDLER_NETWORK, (ctrlm_msg_handler_network_t)&ctrlm_obj_network_t::ind_process_voice_session_request, &msg, sizeof(msg), NULL, network_id);
+      ctrlm_main_queue_handler_push_priority(CTRLM_MAIN_QUEUE_PRIORITY_INTERACTIVE, CTRLM_HANDLER_NETWORK, (ctrlm_msg_handler_network_t)&ctrlm_obj_network_t::ind_process_voice_session_request, &msg, sizeof(msg), NULL, network_id);
 
       first_audio_packet            = true;
 
@@ -417,7 +566,7 @@ ctrlm_hal_result_t ctrlm_voice_ind_data_rf4ce(ctrlm_network_id_t network_id, ctr
          msg.session_end_reason = CTRLM_VOICE_SESSION_END_REASON_DONE;
          msg.key_code           = 0;
 
-         ctrlm_main_queue_handler_push(CTRLM_HANDLER_NETWORK, (ctrlm_msg_handler_network_t)&ctrlm_obj_network_t::ind_process_voice_session_stop, &msg, sizeof(msg), NULL, network_id);
+         ctrlm_main_queue_handler_push_priority(CTRLM_MAIN_QUEUE_PRIORITY_INTERACTIVE, CTRLM_HANDLER_NETWORK, (ctrlm_msg_handler_network_t)&ctrlm_obj_network_t::ind_process_voice_session_stop, &msg, sizeof(msg), NULL, network_id);
       } else if(data_length == 4) { // Remote supports enhanced stop command
          XLOGD_INFO("session stop - enhanced");
          guchar local_data[data_length];
@@ -439,7 +588,7 @@ ctrlm_hal_result_t ctrlm_voice_ind_data_rf4ce(ctrlm_network_id_t network_id, ctr
             msg.session_end_reason = CTRLM_VOICE_SESSION_END_REASON_OTHER_KEY_PRESSED;
             msg.key_code           = data[2];
 
-            ctrlm_main_queue_handler_push(CTRLM_HANDLER_NETWORK, (ctrlm_msg_handler_network_t)&ctrlm_obj_network_t::ind_process_voice_session_stop, &msg, sizeof(msg), NULL, network_id);
+            ctrlm_main_queue_handler_push_priority(CTRLM_MAIN_QUEUE_PRIORITY_INTERACTIVE, CTRLM_HANDLER_NETWORK, (ctrlm_msg_handler_network_t)&ctrlm_obj_network_t::ind_process_voice_session_stop, &msg, sizeof(msg), NULL, network_id);
          } else { // CRTLM_VOICE_REMOTE_*
             ctrlm_voice_session_end_reason_t session_end_reason = CTRLM_VOICE_SESSION_END_REASON_DONE;
 
@@ -455,7 +604,7 @@ ctrlm_hal_result_t ctrlm_voice_ind_data_rf4ce(ctrlm_network_id_t network_id, ctr
             msg.session_end_reason = session_end_reason;
             msg.key_code           = 0;
 
-            ctrlm_main_queue_handler_push(CTRLM_HANDLER_NETWORK, (ctrlm_msg_handler_network_t)&ctrlm_obj_network_t::ind_process_voice_session_stop, &msg, sizeof(msg), NULL, network_id);
+            ctrlm_main_queue_handler_push_priority(CTRLM_MAIN_QUEUE_PRIORITY_INTERACTIVE, CTRLM_HANDLER_NETWORK, (ctrlm_msg_handler_network_t)&ctrlm_obj_network_t::ind_process_voice_session_stop, &msg, sizeof(msg), NULL, network_id);
          }
       }
    } else { // Voice fragment
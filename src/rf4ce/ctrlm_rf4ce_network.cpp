@@ -1200,6 +1200,7 @@ void ctrlm_obj_network_rf4ce_t::controllers_load() {
 
    ctrlm_db_rf4ce_controllers_list(network_id, &controller_ids);
 
+   // The attributes read while loading are served by the database value cache
    for(vector<ctrlm_controller_id_t>::iterator it = controller_ids.begin(); it < controller_ids.end(); it++) {
       unsigned long long ieee_address = 0;
       ctrlm_db_rf4ce_read_ieee_address(network_id, *it, &ieee_address);
@@ -1912,9 +1913,10 @@ bool ctrlm_obj_network_rf4ce_t::backup_hal_nvm() {
    XLOGD_WARN("This platform deos not support HAL NVM backup");
    return(TRUE);
    #else
-   XLOGD_INFO("Backing up HAL NVM data to \"%s\"", HAL_NVM_BACKUP);
+   XLOGD_INFO("Backing up HAL NVM data to \"%s\"", HAL_NVM_BACKUP_TMP);
    
    GFile    *g_file   = g_file_new_for_path(HAL_NVM_BACKUP);
+   GFile    *g_file_tmp = g_file_new_for_path(HAL_NVM_BACKUP_TMP);
    char     *contents = NULL;
    gsize     length   = 0;
    GError   *error    = NULL;
@@ -1937,20 +1939,23 @@ bool ctrlm_obj_network_rf4ce_t::backup_hal_nvm() {
                XLOGD_INFO("Backup of HAL NVM matches current NVM. No need to backup.");
                g_free(contents);
                g_object_unref(g_file);
+               g_object_unref(g_file_tmp);
                return(TRUE);
             }
          }
          g_free(contents);
       }
 
-   // Backup NVM is different from current, or doesn't exist. Dump to file.
-      if(FALSE == g_file_replace_contents(g_file, (char *)nvm_backup_data_, nvm_backup_len_, NULL, FALSE, G_FILE_CREATE_NONE, NULL, NULL, &error)) {
+   // Backup NVM is different from current, or doesn't exist. Dump to the temporary file, the previous backup is kept
+   // until the ctrlm DB backup has completed as well.
+      if(FALSE == g_file_replace_contents(g_file_tmp, (char *)nvm_backup_data_, nvm_backup_len_, NULL, FALSE, G_FILE_CREATE_NONE, NULL, NULL, &error)) {
          XLOGD_ERROR("Failed to make backup of HAL NVM due to %s", (error != NULL ? error->message : "unknown reason"));
          if(error) {
             g_error_free(error);
          }
-         g_file_delete(g_file, NULL, NULL); // Just in case partially written or something.. Sanitity
+         g_file_delete(g_file_tmp, NULL, NULL); // Just in case partially written or something.. Sanitity
          g_object_unref(g_file);
+         g_object_unref(g_file_tmp);
          return(FALSE);
       } else {
          XLOGD_INFO("Backup of HAL NVM successful");
@@ -1963,6 +1968,7 @@ bool ctrlm_obj_network_rf4ce_t::backup_hal_nvm() {
    }
 
    g_object_unref(g_file);
+   g_object_unref(g_file_tmp);
 
 
    return(TRUE);
@@ -148,8 +148,21 @@ typedef struct {
    ctrlm_hal_rf4ce_profile_id_t  profile_id;
    unsigned char                 length;
    unsigned char                 data[CTRLM_RF4CE_MAX_PAYLOAD_LEN];
+   ctrlm_timestamp_t             received; // monotonic time the HAL handed over the packet
 } ctrlm_main_queue_msg_rf4ce_ind_data_t;
 
+// Key and heartbeat frames are a few bytes long so they are queued in a compact message
+// instead of one sized for the largest payload
+#define CTRLM_RF4CE_IND_DATA_FAST_PAYLOAD_LEN (8)
+
+typedef struct {
+   ctrlm_controller_id_t         controller_id;
+   ctrlm_timestamp_t             timestamp;
+   ctrlm_timestamp_t             received; // monotonic time the HAL handed over the packet
+   unsigned char                 length;
+   unsigned char                 data[CTRLM_RF4CE_IND_DATA_FAST_PAYLOAD_LEN];
+} ctrlm_main_queue_msg_rf4ce_ind_data_fast_t;
+
 typedef struct {
    ctrlm_controller_id_t             controller_id;
    guint8                            action;
@@ -256,6 +269,7 @@ ctrlm_hal_result_t ctrlm_hal_rf4ce_ind_unpair(ctrlm_network_id_t id, ctrlm_hal_r
 ctrlm_hal_result_t ctrlm_hal_rf4ce_ind_data(ctrlm_network_id_t network_id, ctrlm_controller_id_t controller_id, ctrlm_hal_rf4ce_ind_data_params_t params);
 ctrlm_hal_result_t ctrlm_voice_ind_data_rf4ce(ctrlm_network_id_t network_id, ctrlm_controller_id_t controller_id, ctrlm_timestamp_t timestamp, guchar command_id, unsigned long data_length, guchar *data, ctrlm_hal_rf4ce_data_read_t cb_data_read, void *cb_data_param, unsigned char lqi, ctrlm_hal_frequency_agility_t *frequency_agility);
 
+void ctrlm_rf4ce_ind_data_latency_add(ctrlm_hal_rf4ce_profile_id_t profile_id, const ctrlm_timestamp_t *received);
 void ctrlm_rf4ce_polling_action_push(ctrlm_network_id_t network_id, ctrlm_controller_id_t controller_id, guint8 action, char* data, size_t len);
 
 class ctrlm_obj_network_rf4ce_t : public ctrlm_obj_network_t
@@ -318,6 +332,8 @@ public:
    void                                 ind_process_pair_result(void *data, int size);
    void                                 ind_process_unpair(void *data, int size);     
    void                                 ind_process_data(void *data, int size);
+   void                                 ind_process_data_key(void *data, int size);
+   void                                 ind_process_data_heartbeat(void *data, int size);
    void                                 ind_process_voice_session_request(void *data, int size);
    void                                 ind_process_voice_session_first_audio_packet(void *data, int size);
    void                                 ind_process_voice_session_stop(void *data, int size);
@@ -655,6 +671,8 @@ private:
    void                  ind_process_pair_binding_button(ctrlm_main_queue_msg_rf4ce_ind_pair_t *dqm, ctrlm_hal_rf4ce_result_t status);
    void                  ind_process_pair_screen_bind(ctrlm_main_queue_msg_rf4ce_ind_pair_t *dqm, ctrlm_hal_rf4ce_result_t status);
    void                  ind_process_data_rcu(ctrlm_main_queue_msg_rf4ce_ind_data_t *dqm);
+   void                  ind_process_key(ctrlm_controller_id_t controller_id, ctrlm_rf4ce_frame_control_t frame_control, ctrlm_key_code_t key_code, unsigned long length, const ctrlm_timestamp_t &received);
+   void                  ind_process_activity(ctrlm_controller_id_t controller_id, ctrlm_rf4ce_frame_control_t frame_control);
    void                  ind_process_data_voice(ctrlm_main_queue_msg_rf4ce_ind_data_t *dqm);
    void                  ind_process_data_device_update(ctrlm_main_queue_msg_rf4ce_ind_data_t *dqm);
 #if CTRLM_HAL_RF4CE_API_VERSION >= 15 && !defined(CTRLM_HOST_DECRYPTION_NOT_SUPPORTED)
@@ -88,6 +88,8 @@ void ctrlm_obj_network_rf4ce_t::ind_process_data(void *data, int size) { // ctrl
    g_assert(dqm);
    g_assert((unsigned int)size >= sizeof(ctrlm_main_queue_msg_rf4ce_ind_data_t));
 
+   ctrlm_rf4ce_ind_data_latency_add(dqm->profile_id, &dqm->received);
+
    if(dqm->profile_id == CTRLM_RF4CE_PROFILE_ID_COMCAST_RCU) {
       this->ind_process_data_rcu(dqm);
    } else if(dqm->profile_id == CTRLM_RF4CE_PROFILE_ID_VOICE) {
@@ -101,87 +103,178 @@ void ctrlm_obj_network_rf4ce_t::ind_process_data(void *data, int size) { // ctrl
    }
 }
 
-void ctrlm_obj_network_rf4ce_t::ind_process_data_rcu(ctrlm_main_queue_msg_rf4ce_ind_data_t *dqm) {
+void ctrlm_obj_network_rf4ce_t::ind_process_data_key(void *data, int size) { // ctrlm_main_queue_msg_rf4ce_ind_data_fast_t *dqm
+   ctrlm_main_queue_msg_rf4ce_ind_data_fast_t *dqm = (ctrlm_main_queue_msg_rf4ce_ind_data_fast_t *)data;
+
+   g_assert(dqm);
+   g_assert((unsigned int)size >= sizeof(ctrlm_main_queue_msg_rf4ce_ind_data_fast_t));
    THREAD_ID_VALIDATE();
-   XLOGD_DEBUG("enter");
-   if(dqm == NULL) {
-      XLOGD_ERROR("Invalid parameters");
-      return;
-   }
+
+   ctrlm_rf4ce_ind_data_latency_add(CTRLM_RF4CE_PROFILE_ID_COMCAST_RCU, &dqm->received);
 
    if(!controller_exists(dqm->controller_id)) {
       XLOGD_TELEMETRY("Invalid controller id %u", dqm->controller_id);
       return;
    }
+   if(dqm->length < 2) {
+      XLOGD_ERROR("Invalid length %u", dqm->length);
+      return;
+   }
+   ind_process_key(dqm->controller_id, (ctrlm_rf4ce_frame_control_t)dqm->data[0], (ctrlm_key_code_t)dqm->data[1], dqm->length, dqm->received);
+}
 
-   unsigned long cmd_length = dqm->length;
-   guchar *      cmd_data   = dqm->data;
-   ctrlm_rf4ce_frame_control_t frame_control;
-   
-   if(cmd_length < 2) {
-      XLOGD_ERROR("Invalid length %lu", cmd_length);
+void ctrlm_obj_network_rf4ce_t::ind_process_data_heartbeat(void *data, int size) { // ctrlm_main_queue_msg_rf4ce_ind_data_fast_t *dqm
+   ctrlm_main_queue_msg_rf4ce_ind_data_fast_t *dqm = (ctrlm_main_queue_msg_rf4ce_ind_data_fast_t *)data;
+
+   g_assert(dqm);
+   g_assert((unsigned int)size >= sizeof(ctrlm_main_queue_msg_rf4ce_ind_data_fast_t));
+   THREAD_ID_VALIDATE();
+
+   ctrlm_rf4ce_ind_data_latency_add(CTRLM_RF4CE_PROFILE_ID_COMCAST_RCU, &dqm->received);
+
+   if(!controller_exists(dqm->controller_id)) {
+      XLOGD_TELEMETRY("Invalid controller id %u", dqm->controller_id);
       return;
    }
-   if(g_ctrlm_rcu_keypress_last_rf4ce.count(dqm->controller_id) == 0) {
-      XLOGD_INFO("New controller id %u", dqm->controller_id);
-      g_ctrlm_rcu_keypress_last_rf4ce[dqm->controller_id].network_id     = network_id_get();
-      g_ctrlm_rcu_keypress_last_rf4ce[dqm->controller_id].controller_id  = dqm->controller_id;
+   if(dqm->length < 3) {
+      XLOGD_ERROR("Invalid length %u", dqm->length);
+      return;
    }
+   XLOGD_DEBUG("Heartbeat command");
+   controllers_[dqm->controller_id]->rf4ce_heartbeat(dqm->timestamp, (guint16)((dqm->data[1] << 8) + dqm->data[2]));
+}
 
-   frame_control = (ctrlm_rf4ce_frame_control_t)((guchar)cmd_data[0]);
+// Key presses arrive either through the compact fast path message or as part of a full rcu profile indication
+void ctrlm_obj_network_rf4ce_t::ind_process_key(ctrlm_controller_id_t controller_id, ctrlm_rf4ce_frame_control_t frame_control, ctrlm_key_code_t key_code, unsigned long length, const ctrlm_timestamp_t &received) {
+   // The HAL does not define the clock of its packet timestamp, so latency is measured from the hand over to ctrlm
+   ctrlm_key_latency_trace_t trace;
+   trace.received = received;
+   trace.input_us = 0;
+   ctrlm_timestamp_get_monotonic(&trace.dequeued);
+   bool emitted = false;
+
+   if(g_ctrlm_rcu_keypress_last_rf4ce.count(controller_id) == 0) {
+      XLOGD_INFO("New controller id %u", controller_id);
+      g_ctrlm_rcu_keypress_last_rf4ce[controller_id].network_id     = network_id_get();
+      g_ctrlm_rcu_keypress_last_rf4ce[controller_id].controller_id  = controller_id;
+   }
 
    switch(frame_control) {
       case RF4CE_FRAME_CONTROL_USER_CONTROL_PRESSED: {
-         ctrlm_key_code_t key_code = (ctrlm_key_code_t)((guchar)cmd_data[1]);
-         XLOGD_DEBUG("User control pressed <%s>. Payload (%ld)", mask_key_codes_get() ? "*" : ctrlm_key_code_str(key_code), cmd_length - 2);
+         XLOGD_DEBUG("User control pressed <%s>. Payload (%ld)", mask_key_codes_get() ? "*" : ctrlm_key_code_str(key_code), length - 2);
          
          // If new key, then send key release and delete key release timer
-         if(g_ctrlm_rcu_keypress_last_rf4ce[dqm->controller_id].timeout_tag) {
-            ctrlm_timeout_destroy(&g_ctrlm_rcu_keypress_last_rf4ce[dqm->controller_id].timeout_tag);
-            process_event_key(dqm->controller_id, CTRLM_KEY_STATUS_UP, key_code);
+         if(g_ctrlm_rcu_keypress_last_rf4ce[controller_id].timeout_tag) {
+            ctrlm_timeout_destroy(&g_ctrlm_rcu_keypress_last_rf4ce[controller_id].timeout_tag);
+            process_event_key(controller_id, CTRLM_KEY_STATUS_UP, key_code);
          }
 
-         if(key_event_hook(network_id_get(), dqm->controller_id, CTRLM_KEY_STATUS_DOWN, key_code)) {         
-            controllers_[dqm->controller_id]->print_remote_firmware_debug_info(RF4CE_PRINT_FIRMWARE_LOG_BUTTON_PRESS);
+         if(key_event_hook(network_id_get(), controller_id, CTRLM_KEY_STATUS_DOWN, key_code)) {         
+            controllers_[controller_id]->print_remote_firmware_debug_info(RF4CE_PRINT_FIRMWARE_LOG_BUTTON_PRESS);
 
-            g_ctrlm_rcu_keypress_last_rf4ce[dqm->controller_id].key_code = key_code;
-            g_ctrlm_rcu_keypress_last_rf4ce[dqm->controller_id].ignore_first_repeat = true;
-            process_event_key(dqm->controller_id, CTRLM_KEY_STATUS_DOWN, key_code);
+            g_ctrlm_rcu_keypress_last_rf4ce[controller_id].key_code = key_code;
+            g_ctrlm_rcu_keypress_last_rf4ce[controller_id].ignore_first_repeat = true;
+            process_event_key(controller_id, CTRLM_KEY_STATUS_DOWN, key_code);
+            emitted = true;
 
             // Set a timer to release the key if no repeats are received for a while
-            g_ctrlm_rcu_keypress_last_rf4ce[dqm->controller_id].timeout_tag = ctrlm_timeout_create(timeout_key_release_, ctrlm_rcu_timeout_key_release_handler, (gpointer)&g_ctrlm_rcu_keypress_last_rf4ce[dqm->controller_id]);
+            g_ctrlm_rcu_keypress_last_rf4ce[controller_id].timeout_tag = ctrlm_timeout_create(timeout_key_release_, ctrlm_rcu_timeout_key_release_handler, (gpointer)&g_ctrlm_rcu_keypress_last_rf4ce[controller_id]);
          }
          break;
       }
       case RF4CE_FRAME_CONTROL_USER_CONTROL_REPEATED: {
          XLOGD_DEBUG("User control repeated.");
          
-         if(key_event_hook(network_id_get(), dqm->controller_id, CTRLM_KEY_STATUS_REPEAT, (ctrlm_key_code_t) 0) &&
-            !g_ctrlm_rcu_keypress_last_rf4ce[dqm->controller_id].ignore_first_repeat) {
+         if(key_event_hook(network_id_get(), controller_id, CTRLM_KEY_STATUS_REPEAT, (ctrlm_key_code_t) 0) &&
+            !g_ctrlm_rcu_keypress_last_rf4ce[controller_id].ignore_first_repeat) {
             // Need to store last key and repeat it here
-            process_event_key(dqm->controller_id, CTRLM_KEY_STATUS_REPEAT, g_ctrlm_rcu_keypress_last_rf4ce[dqm->controller_id].key_code);
+            process_event_key(controller_id, CTRLM_KEY_STATUS_REPEAT, g_ctrlm_rcu_keypress_last_rf4ce[controller_id].key_code);
+            emitted = true;
 
             // Kick key release timer
-            ctrlm_timeout_destroy(&g_ctrlm_rcu_keypress_last_rf4ce[dqm->controller_id].timeout_tag);
-            g_ctrlm_rcu_keypress_last_rf4ce[dqm->controller_id].timeout_tag = ctrlm_timeout_create(timeout_key_release_, ctrlm_rcu_timeout_key_release_handler, (gpointer)&g_ctrlm_rcu_keypress_last_rf4ce[dqm->controller_id]);
+            ctrlm_timeout_destroy(&g_ctrlm_rcu_keypress_last_rf4ce[controller_id].timeout_tag);
+            g_ctrlm_rcu_keypress_last_rf4ce[controller_id].timeout_tag = ctrlm_timeout_create(timeout_key_release_, ctrlm_rcu_timeout_key_release_handler, (gpointer)&g_ctrlm_rcu_keypress_last_rf4ce[controller_id]);
          }
-         if (g_ctrlm_rcu_keypress_last_rf4ce[dqm->controller_id].ignore_first_repeat) {
-            g_ctrlm_rcu_keypress_last_rf4ce[dqm->controller_id].ignore_first_repeat = false;
+         if (g_ctrlm_rcu_keypress_last_rf4ce[controller_id].ignore_first_repeat) {
+            g_ctrlm_rcu_keypress_last_rf4ce[controller_id].ignore_first_repeat = false;
          }
          break;
       }
       case RF4CE_FRAME_CONTROL_USER_CONTROL_RELEASED: {
          XLOGD_DEBUG("User control released.");
-         if(key_event_hook(network_id_get(), dqm->controller_id, CTRLM_KEY_STATUS_UP, (ctrlm_key_code_t) 0)) {
+         if(key_event_hook(network_id_get(), controller_id, CTRLM_KEY_STATUS_UP, (ctrlm_key_code_t) 0)) {
             // Need to store last key and release it here
 
-            process_event_key(dqm->controller_id, CTRLM_KEY_STATUS_UP, g_ctrlm_rcu_keypress_last_rf4ce[dqm->controller_id].key_code);
+            process_event_key(controller_id, CTRLM_KEY_STATUS_UP, g_ctrlm_rcu_keypress_last_rf4ce[controller_id].key_code);
+            emitted = true;
 
             // Cancel key release timer, delete last key
-            ctrlm_timeout_destroy(&g_ctrlm_rcu_keypress_last_rf4ce[dqm->controller_id].timeout_tag);
+            ctrlm_timeout_destroy(&g_ctrlm_rcu_keypress_last_rf4ce[controller_id].timeout_tag);
          }
          break;
       }
+      default: {
+         break;
+      }
+   }
+   if(emitted && controller_exists(controller_id)) {
+      controllers_[controller_id]->key_latency_add(trace);
+   }
+   ind_process_activity(controller_id, frame_control);
+}
+
+// Update device update timer so that download sessions do not timeout.  Keys arrive on the fast path and the full rcu path.
+void ctrlm_obj_network_rf4ce_t::ind_process_activity(ctrlm_controller_id_t controller_id, ctrlm_rf4ce_frame_control_t frame_control) {
+   switch(frame_control) {
+      case RF4CE_FRAME_CONTROL_USER_CONTROL_PRESSED:
+      case RF4CE_FRAME_CONTROL_USER_CONTROL_REPEATED:
+      case RF4CE_FRAME_CONTROL_USER_CONTROL_RELEASED: {
+         // Update timer
+         ctrlm_device_update_timeout_update_activity(network_id_get(), controller_id);
+         break;
+      }
+      case RF4CE_FRAME_CONTROL_KEY_COMBO: {
+         // Update timer with a longer value to prevent timeout from holding the button too long
+         ctrlm_device_update_timeout_update_activity(network_id_get(), controller_id, CTRLM_DEVICE_UPDATE_EXTENDED_TIMEOUT_VALUE);
+         break;
+      }
+      default: {
+         break;
+      }
+   }
+}
+
+void ctrlm_obj_network_rf4ce_t::ind_process_data_rcu(ctrlm_main_queue_msg_rf4ce_ind_data_t *dqm) {
+   THREAD_ID_VALIDATE();
+   XLOGD_DEBUG("enter");
+   if(dqm == NULL) {
+      XLOGD_ERROR("Invalid parameters");
+      return;
+   }
+
+   if(!controller_exists(dqm->controller_id)) {
+      XLOGD_TELEMETRY("Invalid controller id %u", dqm->controller_id);
+      return;
+   }
+
+   unsigned long cmd_length = dqm->length;
+   guchar *      cmd_data   = dqm->data;
+   ctrlm_rf4ce_frame_control_t frame_control;
+   
+   if(cmd_length < 2) {
+      XLOGD_ERROR("Invalid length %lu", cmd_length);
+      return;
+   }
+
+   frame_control = (ctrlm_rf4ce_frame_control_t)((guchar)cmd_data[0]);
+
+   switch(frame_control) {
+      case RF4CE_FRAME_CONTROL_USER_CONTROL_PRESSED:
+      case RF4CE_FRAME_CONTROL_USER_CONTROL_REPEATED:
+      case RF4CE_FRAME_CONTROL_USER_CONTROL_RELEASED: {
+         ind_process_key(dqm->controller_id, frame_control, (ctrlm_key_code_t)((guchar)cmd_data[1]), cmd_length, dqm->received);
+         break;
+      }
       case RF4CE_FRAME_CONTROL_CHECK_VALIDATION_REQUEST: {
          guchar check_validation_control = cmd_data[1];
          XLOGD_INFO("Check validation request (%s).", (check_validation_control & 0x1) ? "Automatic" : "Normal");
@@ -258,6 +351,7 @@ void ctrlm_obj_network_rf4ce_t::ind_process_data_rcu(ctrlm_main_queue_msg_rf4ce_
          break;
       }
       case RF4CE_FRAME_CONTROL_KEY_COMBO: {
+         ind_process_activity(dqm->controller_id, frame_control);
          guchar length = cmd_data[1];
          unsigned long code;
          if(cmd_length != ((unsigned long)(length)) + 2) {
@@ -602,25 +696,6 @@ void ctrlm_obj_network_rf4ce_t::ind_process_data_rcu(ctrlm_main_queue_msg_rf4ce_
          break;
       }
    }
-
-   // Update device update timer so that download sessions do not timeout
-   switch(frame_control) {
-      case RF4CE_FRAME_CONTROL_USER_CONTROL_PRESSED:
-      case RF4CE_FRAME_CONTROL_USER_CONTROL_REPEATED:
-      case RF4CE_FRAME_CONTROL_USER_CONTROL_RELEASED: {
-         // Update timer
-         ctrlm_device_update_timeout_update_activity(network_id_get(), dqm->controller_id);
-         break;
-      }
-      case RF4CE_FRAME_CONTROL_KEY_COMBO: {
-         // Update timer with a longer value to prevent timeout from holding the button too long
-         ctrlm_device_update_timeout_update_activity(network_id_get(), dqm->controller_id, CTRLM_DEVICE_UPDATE_EXTENDED_TIMEOUT_VALUE);
-         break;
-      }
-      default: {
-         break;
-      }
-   }
 }
 
 //#define DEMO_ONLY
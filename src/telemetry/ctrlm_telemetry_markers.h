@@ -27,6 +27,46 @@
 // Global Markers
 //
 
+// Main Thread Dispatch Statistics
+// Reported once per telemetry interval for the message types and handlers with the most run time on the
+// ctrlm_main thread. The format of the marker is a json array of arrays with each entry in the format below:
+//
+// [[entry1], [entry2], [entry3], ...]
+// [<version>,<name>,<count>,<wait_p50>,<wait_p99>,<wait_max>,<run_p50>,<run_p99>,<run_max>]
+//
+// <version>  - Version of the marker format.
+// <name>     - Message type or handler function name.
+// <count>    - Number of messages dispatched in the interval.
+// <wait_p50> - Median time in us that the message waited in the queue (log2 bucket upper bound).
+// <wait_p99> - 99th percentile time in us that the message waited in the queue (log2 bucket upper bound).
+// <wait_max> - Maximum time in us that the message waited in the queue.
+// <run_p50>  - Median time in us taken by the handler (log2 bucket upper bound).
+// <run_p99>  - 99th percentile time in us taken by the handler (log2 bucket upper bound).
+// <run_max>  - Maximum time in us taken by the handler.
+#define MARKER_MAIN_DISPATCH_STATS         "ctrlm.main.dispatch.stats"
+#define MARKER_MAIN_DISPATCH_STATS_VERSION "1"
+
+// RCU Key Latency
+// Reported once per telemetry interval for every remote that sent keys in the interval. The latency is measured
+// from the remote's input event (evdev timestamp for BLE, HAL indication for RF4CE) to uinput/IARM emission.
+// The format of the marker is a json array of arrays with each entry in the format below:
+//
+// [[entry1], [entry2], [entry3], ...]
+// [<version>,<type>,<count>,<p50>,<p95>,<p99>,<max>,<input_p99>,<queue_p99>,<process_p99>]
+//
+// <version>     - Version of the marker format.
+// <type>        - Controller type string.
+// <count>       - Number of keys in the interval.
+// <p50>         - Median end to end latency in us (log2 bucket upper bound).
+// <p95>         - 95th percentile end to end latency in us (log2 bucket upper bound).
+// <p99>         - 99th percentile end to end latency in us (log2 bucket upper bound).
+// <max>         - Maximum end to end latency in us.
+// <input_p99>   - 99th percentile time in us from the evdev event to the key monitor reading it (0 for RF4CE).
+// <queue_p99>   - 99th percentile time in us the key waited for the ctrlm_main thread.
+// <process_p99> - 99th percentile time in us from the ctrlm_main thread picking up the key to emission.
+#define MARKER_RCU_KEY_LATENCY         "ctrlm.rcu.key.latency"
+#define MARKER_RCU_KEY_LATENCY_VERSION "1"
+
 //
 // End Global Markers
 //
@@ -0,0 +1,134 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+// Feeds synthetic session timings into ctrlm_voice_timeline_t and checks the phase percentiles.  The exit status is
+// the number of failed checks.
+#include <stdio.h>
+#include <string.h>
+#include "ctrlm_voice_timeline.h"
+
+#define TEST_CHECK(cond) test_check((cond), #cond, __LINE__)
+
+static unsigned int g_test_failures = 0;
+
+static void test_check(bool cond, const char *str, int line) {
+   if(!cond) {
+      fprintf(stderr, "line %d: check failed <%s>\n", line, str);
+      g_test_failures++;
+   }
+}
+
+// All sessions are relative to the same base time, in ms
+static rdkx_timestamp_t test_ts(unsigned long ms) {
+   rdkx_timestamp_t ts;
+   ts.tv_sec  = 1000 + ms / 1000;
+   ts.tv_nsec = (ms % 1000) * 1000000;
+   return(ts);
+}
+
+// A streamed session where each phase takes the given time in ms.  With respond false the server never responds,
+// so only the disconnect is set.
+static ctrlm_voice_session_timing_t test_session(unsigned long stream_begin_ms, unsigned long audio_ms, unsigned long response_ms, bool respond) {
+   ctrlm_voice_session_timing_t timing;
+   memset(&timing, 0, sizeof(timing));
+   timing.available            = true;
+   timing.connect_attempt      = true;
+   timing.connect_success      = true;
+   timing.ctrl_request         = test_ts(0);
+   timing.ctrl_audio_rxd_first = test_ts(stream_begin_ms - audio_ms);
+   timing.srvr_audio_txd_first = test_ts(stream_begin_ms);
+   timing.srvr_audio_txd_final = test_ts(stream_begin_ms + 2000);
+   if(respond) {
+      timing.srvr_response     = test_ts(stream_begin_ms + 2000 + response_ms);
+      timing.srvr_disconnect   = test_ts(stream_begin_ms + 2000 + response_ms + 500);
+   } else {
+      timing.srvr_disconnect   = test_ts(stream_begin_ms + 2000 + response_ms);
+   }
+   return(timing);
+}
+
+static void test_check_stats(const ctrlm_voice_timeline_t &timeline, ctrlm_voice_phase_t phase, unsigned long count, unsigned long long p50_ms, unsigned long long p95_ms, unsigned long long p99_ms, unsigned long long max_ms, int line) {
+   ctrlm_voice_phase_stats_t stats;
+   bool ret = timeline.phase_stats(phase, &stats);
+   if(ret != (count > 0) || stats.count != count || stats.p50_us != p50_ms * 1000 || stats.p95_us != p95_ms * 1000 || stats.p99_us != p99_ms * 1000 || stats.max_us != max_ms * 1000) {
+      fprintf(stderr, "line %d: %s count <%lu> p50 <%llu> p95 <%llu> p99 <%llu> max <%llu> us, expected count <%lu> p50 <%llu> p95 <%llu> p99 <%llu> max <%llu> ms\n", line,
+              ctrlm_voice_timeline_t::phase_str(phase), stats.count, stats.p50_us, stats.p95_us, stats.p99_us, stats.max_us, count, p50_ms, p95_ms, p99_ms, max_ms);
+      g_test_failures++;
+   }
+}
+
+// 1..100 ms added out of order.  Nearest rank gives the percentile itself.
+static void test_percentiles() {
+   ctrlm_voice_timeline_t timeline(100);
+   for(unsigned long i = 0; i < 100; i++) {
+      unsigned long ms = ((i * 37) % 100) + 1;
+      timeline.add(i, "test", test_session(ms, ms, ms, true));
+   }
+   TEST_CHECK(timeline.size() == 100);
+   test_check_stats(timeline, CTRLM_VOICE_PHASE_KEY_TO_STREAM_BEGIN,   100, 50, 95, 99, 100, __LINE__);
+   test_check_stats(timeline, CTRLM_VOICE_PHASE_AUDIO_FIRST_TO_SERVER, 100, 50, 95, 99, 100, __LINE__);
+   test_check_stats(timeline, CTRLM_VOICE_PHASE_EOS_TO_RESPONSE,       100, 50, 95, 99, 100, __LINE__);
+
+   timeline.clear();
+   TEST_CHECK(timeline.size() == 0);
+   test_check_stats(timeline, CTRLM_VOICE_PHASE_KEY_TO_STREAM_BEGIN, 0, 0, 0, 0, 0, __LINE__);
+}
+
+// 25 sessions through a ring of 10 leave the last 10 (16..25 ms), so the percentiles roll with the ring
+static void test_wraparound() {
+   ctrlm_voice_timeline_t timeline(10);
+   for(unsigned long i = 1; i <= 25; i++) {
+      timeline.add(i, "test", test_session(i, i, i, true));
+      if(i == 10) {
+         test_check_stats(timeline, CTRLM_VOICE_PHASE_KEY_TO_STREAM_BEGIN, 10, 5, 10, 10, 10, __LINE__);
+      }
+   }
+   TEST_CHECK(timeline.size() == 10);
+   test_check_stats(timeline, CTRLM_VOICE_PHASE_KEY_TO_STREAM_BEGIN, 10, 20, 25, 25, 25, __LINE__);
+   test_check_stats(timeline, CTRLM_VOICE_PHASE_EOS_TO_RESPONSE,     10, 20, 25, 25, 25, __LINE__);
+}
+
+// Without a response the end of speech phase runs to the disconnect.  Sessions that never connected and timestamps
+// out of order are left out.
+static void test_missing_response() {
+   ctrlm_voice_timeline_t timeline(10);
+   timeline.add(1, "test", test_session(100, 10, 300, true));
+   timeline.add(2, "test", test_session(100, 10, 700, false));
+
+   ctrlm_voice_session_timing_t timing = test_session(100, 10, 300, true);
+   timing.connect_success = false;
+   timeline.add(3, "test", timing);
+
+   timing = test_session(100, 10, 300, true);
+   timing.srvr_response = test_ts(50); // before the end of speech
+   timeline.add(4, "test", timing);
+
+   TEST_CHECK(timeline.size() == 4);
+   test_check_stats(timeline, CTRLM_VOICE_PHASE_KEY_TO_STREAM_BEGIN,   3, 100, 100, 100, 100, __LINE__);
+   test_check_stats(timeline, CTRLM_VOICE_PHASE_AUDIO_FIRST_TO_SERVER, 3, 10, 10, 10, 10, __LINE__);
+   test_check_stats(timeline, CTRLM_VOICE_PHASE_EOS_TO_RESPONSE,       2, 300, 700, 700, 700, __LINE__);
+}
+
+int main(void) {
+   test_percentiles();
+   test_wraparound();
+   test_missing_response();
+
+   printf("voice timeline: %s (%u failures)\n", g_test_failures ? "FAIL" : "PASS", g_test_failures);
+   return(g_test_failures);
+}
@@ -22,6 +22,7 @@
 #include <WPEFramework/websocket/websocket.h>
 #include <WPEFramework/plugins/plugins.h>
 #include <sstream>
+#include <algorithm>
 #include <secure_wrapper.h>
 #include <glib.h>
 
@@ -38,7 +39,24 @@ struct on_plugin_activated_params_t {
         , state_(state) {}
 };
 
+struct call_async_params_t {
+    ctrlm_thunder_plugin_t *plugin_;
+    std::string             method_;
+    JsonObject              params_;
+    JsonObject              response_;
+    unsigned int            retries_;
+    bool                    result_;
+    plugin_call_handler_t   handler_;
+    void                   *user_data_;
+};
+
 #define REGISTER_EVENTS_RETRY_MAX (5)
+#define CALL_ASYNC_THREAD_QTY_MAX (4)
+
+static GThreadPool                          *_call_async_pool = NULL;
+static std::mutex                            _call_async_pool_mutex;
+static std::mutex                            _plugins_mutex;
+static std::vector<ctrlm_thunder_plugin_t *> _plugins;
 
 static void _on_activation_change(Thunder::plugin_state_t state, void *data) {
     ctrlm_thunder_plugin_t *plugin = (ctrlm_thunder_plugin_t *)data;
@@ -67,6 +85,11 @@ ctrlm_thunder_plugin_t::ctrlm_thunder_plugin_t(std::string name, std::string cal
     this->controller    = Thunder::Controller::ctrlm_thunder_controller_t::getInstance();
     this->plugin_client = NULL;
 
+    {
+        std::lock_guard<std::mutex> lock(_plugins_mutex);
+        _plugins.push_back(this);
+    }
+
     if(this->controller) {
         if(!this->controller->is_ready()) {
             XLOGD_INFO("Thunder is not ready, setting up thunder ready handler");
@@ -91,6 +114,9 @@ ctrlm_thunder_plugin_t::~ctrlm_thunder_plugin_t() {
     if(this->controller) {
         this->controller->remove_activation_handler(this->callsign, _on_activation_change);
     }
+
+    std::lock_guard<std::mutex> lock(_plugins_mutex);
+    _plugins.erase(std::remove(_plugins.begin(), _plugins.end(), this), _plugins.end());
 }
 
 std::string ctrlm_thunder_plugin_t::callsign_with_api() {
@@ -182,6 +208,8 @@ int ctrlm_thunder_plugin_t::on_plugin_activated(void *data) {
 }
 
 void ctrlm_thunder_plugin_t::on_activation_change(plugin_state_t state) {
+    // Cached responses may not hold across a restart of the plugin
+    this->cache_invalidate();
     if(state == PLUGIN_ACTIVATED || state == PLUGIN_BOOT_ACTIVATED) {
         on_plugin_activated_params_t *params = new on_plugin_activated_params_t(this, state);
         g_timeout_add(100, &ctrlm_thunder_plugin_t::on_plugin_activated, (void *)params);
@@ -213,9 +241,13 @@ bool ctrlm_thunder_plugin_t::property_get(std::string property, void *response,
     auto clientObject = (JSONRPC::LinkType<Core::JSON::IElement>*)this->plugin_client;
     JsonObject *jsonResponse = (JsonObject *)response;
     if(clientObject) {
-        if(!property.empty() && jsonResponse) {
+        std::string cache_key;
+        if(!property.empty() && jsonResponse && this->cache_get(property, NULL, response, cache_key)) {
+            ret = true;
+        } else if(!property.empty() && jsonResponse) {
             uint32_t thunderRet = Core::ERROR_TIMEDOUT;
             const char *method = property.c_str(); 
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
             while(thunderRet == Core::ERROR_TIMEDOUT && attempts <= retries) { // We only want to retry if return code is for TIMEDOUT
                 thunderRet = clientObject->GetProperty(method, *jsonResponse, CALL_TIMEOUT);
                 if(thunderRet == Core::ERROR_NONE) {
@@ -225,6 +257,10 @@ bool ctrlm_thunder_plugin_t::property_get(std::string property, void *response,
                     XLOGD_ERROR("Thunder property get failed <%s> <%u>, attempt %u of %u", method, thunderRet, attempts, (thunderRet == Core::ERROR_TIMEDOUT ? retries : 0) + 1); // retries + initial attempt
                 }
             }
+            this->call_latency_add(property, start);
+            if(ret && !cache_key.empty()) {
+                this->cache_put(cache_key, property, response);
+            }
         } else {
             XLOGD_ERROR("Invalid parameters");
         }
@@ -241,8 +277,12 @@ bool ctrlm_thunder_plugin_t::call_plugin(std::string method, void *params, void
     JsonObject *jsonParams = (JsonObject *)params;
     JsonObject *jsonResponse = (JsonObject *)response;
     if(clientObject) {
-        if(!method.empty() && jsonParams && jsonResponse) {
+        std::string cache_key;
+        if(!method.empty() && jsonParams && jsonResponse && this->cache_get(method, params, response, cache_key)) {
+            ret = true;
+        } else if(!method.empty() && jsonParams && jsonResponse) {
             uint32_t thunderRet = Core::ERROR_TIMEDOUT;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
             while(thunderRet == Core::ERROR_TIMEDOUT && attempts <= retries) { // We only want to retry if return code is for TIMEDOUT
                 thunderRet = clientObject->Invoke<JsonObject, JsonObject>(CALL_TIMEOUT, _T(method), *jsonParams, *jsonResponse);
                 if(thunderRet == Core::ERROR_NONE) {
@@ -252,6 +292,10 @@ bool ctrlm_thunder_plugin_t::call_plugin(std::string method, void *params, void
                     XLOGD_ERROR("Thunder call failed <%s> <%u>, attempt %u of %u", method.c_str(), thunderRet, attempts, (thunderRet == Core::ERROR_TIMEDOUT ? retries : 0) + 1); // retries + initial attempt
                 }
             }
+            this->call_latency_add(method, start);
+            if(ret && !cache_key.empty()) {
+                this->cache_put(cache_key, method, response);
+            }
         } else {
             XLOGD_ERROR("Invalid parameters");
         }
@@ -268,7 +312,9 @@ bool ctrlm_thunder_plugin_t::call_plugin_boolean(std::string method, void *param
     if(clientObject) {
         if(!method.empty() && jsonParams && response) {
             Core::JSON::Boolean jsonResponse;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
             uint32_t thunderRet = clientObject->Invoke<JsonObject, Core::JSON::Boolean>(CALL_TIMEOUT, _T(method), *jsonParams, jsonResponse);
+            this->call_latency_add(method, start);
             if(thunderRet != Core::ERROR_NONE) {
                XLOGD_ERROR("Thunder call failed <%s> <%u>", method.c_str(), thunderRet);
             } else {
@@ -291,7 +337,9 @@ bool ctrlm_thunder_plugin_t::call_plugin_string(std::string method, void *params
     if(clientObject) {
         if(!method.empty() && jsonParams && response) {
             Core::JSON::String jsonString;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
             uint32_t thunderRet = clientObject->Invoke<JsonObject, Core::JSON::String>(CALL_TIMEOUT, _T(method), *jsonParams, jsonString);
+            this->call_latency_add(method, start);
             if(thunderRet != Core::ERROR_NONE) {
                XLOGD_ERROR("Thunder call failed <%s> <%u>", method.c_str(), thunderRet);
             } else {
@@ -308,6 +356,155 @@ bool ctrlm_thunder_plugin_t::call_plugin_string(std::string method, void *params
 }
 
 
+bool ctrlm_thunder_plugin_t::call_plugin_async(std::string method, void *params, plugin_call_handler_t handler, void *user_data, unsigned int retries) {
+    JsonObject *jsonParams = (JsonObject *)params;
+    if(method.empty() || jsonParams == NULL || handler == NULL) {
+        XLOGD_ERROR("Invalid parameters");
+        return(false);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_call_async_pool_mutex);
+        if(_call_async_pool == NULL) {
+            GError *error = NULL;
+            _call_async_pool = g_thread_pool_new(&ctrlm_thunder_plugin_t::on_call_async, NULL, CALL_ASYNC_THREAD_QTY_MAX, FALSE, &error);
+            if(_call_async_pool == NULL) {
+                XLOGD_ERROR("Failed to create thread pool <%s>", (error ? error->message : ""));
+                g_clear_error(&error);
+                return(false);
+            }
+        }
+    }
+
+    call_async_params_t *call = new call_async_params_t();
+    call->plugin_    = this;
+    call->method_    = std::move(method);
+    call->params_    = *jsonParams;
+    call->retries_   = retries;
+    call->result_    = false;
+    call->handler_   = handler;
+    call->user_data_ = user_data;
+
+    GError *error = NULL;
+    if(!g_thread_pool_push(_call_async_pool, (gpointer)call, &error)) {
+        XLOGD_ERROR("Failed to queue call <%s> <%s>", call->method_.c_str(), (error ? error->message : ""));
+        g_clear_error(&error);
+        delete call;
+        return(false);
+    }
+    return(true);
+}
+
+void ctrlm_thunder_plugin_t::on_call_async(void *data, void *user_data) {
+    call_async_params_t *call = (call_async_params_t *)data;
+    if(call) {
+        call->result_ = call->plugin_->call_plugin(call->method_, (void *)&call->params_, (void *)&call->response_, call->retries_);
+        // Handlers run on the main loop like the other plugin callbacks
+        g_idle_add(&ctrlm_thunder_plugin_t::on_call_async_complete, (void *)call);
+    } else {
+        XLOGD_ERROR("Params NULL");
+    }
+}
+
+int ctrlm_thunder_plugin_t::on_call_async_complete(void *data) {
+    call_async_params_t *call = (call_async_params_t *)data;
+    if(call) {
+        call->handler_(call->result_, (void *)&call->response_, call->user_data_);
+        delete call;
+    } else {
+        XLOGD_ERROR("Params NULL");
+    }
+    return(0);
+}
+
+void ctrlm_thunder_plugin_t::cache_ttl_set(std::string method, std::chrono::milliseconds ttl) {
+    std::lock_guard<std::mutex> lock(this->call_mutex);
+    this->cache_ttl[method] = ttl;
+}
+
+void ctrlm_thunder_plugin_t::cache_invalidate(std::string method) {
+    std::lock_guard<std::mutex> lock(this->call_mutex);
+    if(method.empty()) {
+        this->cache.clear();
+        return;
+    }
+    // Keys are the method name followed by the parameters
+    auto itr = this->cache.lower_bound(method);
+    while(itr != this->cache.end() && itr->first.compare(0, method.size(), method) == 0) {
+        if(itr->first.size() == method.size() || itr->first[method.size()] == '\n') {
+            itr = this->cache.erase(itr);
+        } else {
+            ++itr;
+        }
+    }
+}
+
+// Returns true with the cached response if there is one. The key is left empty if the method is not cached.
+bool ctrlm_thunder_plugin_t::cache_get(const std::string &method, void *params, void *response, std::string &key) {
+    std::lock_guard<std::mutex> lock(this->call_mutex);
+    key.clear();
+    if(this->cache_ttl.count(method) == 0) {
+        return(false);
+    }
+    key = method;
+    if(params) {
+        std::string params_str;
+        ((JsonObject *)params)->ToString(params_str);
+        key += "\n" + params_str;
+    }
+
+    auto itr = this->cache.find(key);
+    if(itr == this->cache.end()) {
+        return(false);
+    }
+    if(std::chrono::steady_clock::now() >= itr->second.expires) {
+        this->cache.erase(itr);
+        return(false);
+    }
+    XLOGD_DEBUG("%s <%s> served from cache", this->name.c_str(), method.c_str());
+    ((JsonObject *)response)->FromString(itr->second.response);
+    return(true);
+}
+
+void ctrlm_thunder_plugin_t::cache_put(const std::string &key, const std::string &method, void *response) {
+    std::lock_guard<std::mutex> lock(this->call_mutex);
+    auto ttl = this->cache_ttl.find(method);
+    if(ttl == this->cache_ttl.end()) {
+        return;
+    }
+    call_cache_entry_t &entry = this->cache[key];
+    ((JsonObject *)response)->ToString(entry.response);
+    entry.expires = std::chrono::steady_clock::now() + ttl->second;
+}
+
+void ctrlm_thunder_plugin_t::call_latency_add(const std::string &method, std::chrono::steady_clock::time_point start) {
+    unsigned long long latency_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    std::lock_guard<std::mutex> lock(this->call_mutex);
+    this->call_latency[method].add(latency_us);
+}
+
+void ctrlm_thunder_plugin_t::call_stats_log(bool reset) {
+    std::lock_guard<std::mutex> lock(this->call_mutex);
+    for(auto &itr : this->call_latency) {
+        const ctrlm_histogram_t &latency = itr.second;
+        if(latency.count() == 0) {
+            continue;
+        }
+        XLOGD_INFO("%s <%s> calls <%llu> latency avg <%llu> p50 <%llu> p95 <%llu> p99 <%llu> max <%llu> us", this->name.c_str(), itr.first.c_str(), latency.count(),
+                   latency.average(), latency.percentile(50), latency.percentile(95), latency.percentile(99), latency.max());
+        if(reset) {
+            itr.second.reset();
+        }
+    }
+}
+
+void ctrlm_thunder_plugin_t::call_stats_log_all(bool reset) {
+    std::lock_guard<std::mutex> lock(_plugins_mutex);
+    for(auto plugin : _plugins) {
+        plugin->call_stats_log(reset);
+    }
+}
+
 bool ctrlm_thunder_plugin_t::call_controller(std::string method, void *params, void *response) {
     bool ret = false;
     if(this->controller) {
@@ -19,15 +19,19 @@
 #ifndef __CTRLM_THUNDER_PLUGIN_H__
 #define __CTRLM_THUNDER_PLUGIN_H__
 #include "ctrlm_thunder_controller.h"
+#include "ctrlm_histogram.h"
 #include <iostream>
 #include <map>
 #include <vector>
 #include <utility>
+#include <mutex>
+#include <chrono>
 
 namespace Thunder {
 namespace Plugin {
 
 typedef void (*plugin_activation_handler_t)(plugin_state_t state, void *user_data);
+typedef void (*plugin_call_handler_t)(bool success, void *response, void *user_data);
 
 /**
  * This class is the base class for thunder plugins within ControlMgr. This implementation handles calling Thunder for status on plugins, registering for plugin events, and making calls to thunder plugins.
@@ -90,6 +94,18 @@ public:
      * */
     void iterate_activation_callbacks(plugin_state_t state);
 
+    /**
+     * This function logs the call count and latency percentiles for each method called on this plugin.
+     * @param reset True to start the statistics over after logging them.
+     */
+    void call_stats_log(bool reset);
+
+    /**
+     * This function logs the call statistics of every Thunder Plugin instance.
+     * @param reset True to start the statistics over after logging them.
+     */
+    static void call_stats_log_all(bool reset);
+
 protected:
     /**
      * This is the Constructor for the base class object. It is protected, as the derived Thunder Plugins will be Singletons.
@@ -123,6 +139,30 @@ protected:
      */
     bool call_plugin(std::string method, void *params, void *response, unsigned int retries = 0);
 
+    /**
+     * This function is used to call a Thunder Plugin method without blocking the caller. Calls are run on a shared pool of threads so several can be in flight at once.
+     * @param method The method in which the user wants to call.
+     * @param params The WPEFramework JsonObject containing the parameters for the call. It is copied so it does not need to outlive this call. (We can't include WPEFramework headers in controlMgr .h files as their logging macros clash)
+     * @param handler The function called from the main loop when the call completes. The response is a WPEFramework JsonObject that is only valid during the handler.
+     * @param user_data A pointer to data to pass to the handler.
+     * @param retries The number of retries if the call times out.
+     * @return True if the call was queued, otherwise False.
+     */
+    bool call_plugin_async(std::string method, void *params, plugin_call_handler_t handler, void *user_data = NULL, unsigned int retries = 0);
+
+    /**
+     * This function enables response caching for a method or property that changes rarely. Successful responses are reused until they expire, the plugin changes state or they are invalidated.
+     * @param method The method or property name.
+     * @param ttl The time a cached response stays valid.
+     */
+    void cache_ttl_set(std::string method, std::chrono::milliseconds ttl);
+
+    /**
+     * This function drops cached responses, for example when an event reports that the value changed.
+     * @param method The method or property name to drop, or an empty string to drop everything.
+     */
+    void cache_invalidate(std::string method = "");
+
     /**
      * This function is used to call a Thunder Plugin method.
      * @param method The method in which the user wants to call.
@@ -167,16 +207,36 @@ protected:
      */
     static int on_plugin_activated(void *data);
 
+    /**
+     * These callback functions run an asynchronous call on a pool thread and deliver its result on the main loop.
+     */
+    static void on_call_async(void *data, void *user_data);
+    static int  on_call_async_complete(void *data);
+
 protected:
     std::string name;
     void       *plugin_client;
 
 private:
+    struct call_cache_entry_t {
+        std::string                           response;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    bool cache_get(const std::string &method, void *params, void *response, std::string &key);
+    void cache_put(const std::string &key, const std::string &method, void *response);
+    void call_latency_add(const std::string &method, std::chrono::steady_clock::time_point start);
+
     Thunder::Controller::ctrlm_thunder_controller_t *controller;
     std::string callsign;
     int         api_version;
     std::vector<std::pair<plugin_activation_handler_t, void *> > activation_callbacks;
     int  register_events_retry;
+
+    std::mutex                                       call_mutex; // protects the cache and latency statistics, which pool threads also update
+    std::map<std::string, std::chrono::milliseconds> cache_ttl;
+    std::map<std::string, call_cache_entry_t>        cache;
+    std::map<std::string, ctrlm_histogram_t>         call_latency;
 };
 };
 };
@@ -32,6 +32,7 @@ ctrlm_thunder_plugin_device_info_t::ctrlm_thunder_plugin_device_info_t() : ctrlm
     sem_init(&this->semaphore, 0, 1);
     this->device_type = CTRLM_DEVICE_TYPE_INVALID;
     this->activated   = false;
+    this->cache_ttl_set("devicetype", std::chrono::hours(1));
 }
 
 ctrlm_thunder_plugin_device_info_t::~ctrlm_thunder_plugin_device_info_t() {
@@ -61,9 +61,24 @@ static void _on_hotplug(ctrlm_thunder_plugin_display_settings_t *plugin, JsonObj
     }
 }
 
+static void _on_edid(bool success, void *response, void *user_data) {
+    auto params = (std::pair<ctrlm_thunder_plugin_display_settings_t *, unsigned int> *)user_data;
+    if(params) {
+        if(params->first) {
+            params->first->on_edid(params->second, success, response);
+        } else {
+            XLOGD_ERROR("Plugin NULL");
+        }
+        delete params;
+    } else {
+        XLOGD_ERROR("Params NULL");
+    }
+}
+
 ctrlm_thunder_plugin_display_settings_t::ctrlm_thunder_plugin_display_settings_t() : ctrlm_thunder_plugin_t("DisplaySettings", "org.rdk.DisplaySettings", 1) {
     sem_init(&this->semaphore, 0, 1);
     this->registered_events = false;
+    this->edid_sequence     = 0;
 }
 
 ctrlm_thunder_plugin_display_settings_t::~ctrlm_thunder_plugin_display_settings_t() {
@@ -87,17 +102,37 @@ void ctrlm_thunder_plugin_display_settings_t::get_edid(std::vector<uint8_t> &edi
 }
 
 bool ctrlm_thunder_plugin_display_settings_t::_get_edid() {
-    bool ret = false;
-    JsonObject params, response;
+    JsonObject params;
 
     XLOGD_INFO("Calling DisplaySettings for EDID data");
 
     // Lock sempahore as we are touching EDID cache
     sem_wait(&this->semaphore);
+    unsigned int sequence = ++this->edid_sequence;
+    // Unlock semaphore as we are done touching the EDID cache
+    sem_post(&this->semaphore);
+
+    // readEDID can take seconds with retries so the response is parsed on the main loop when it arrives
+    auto request = new std::pair<ctrlm_thunder_plugin_display_settings_t *, unsigned int>(this, sequence);
+    if(!this->call_plugin_async("readEDID", (void *)&params, &_on_edid, (void *)request, 2)) {
+        XLOGD_ERROR("DisplaySettings readEDID call failed!");
+        delete request;
+        return(false);
+    }
+    return(true);
+}
 
-    if(this->call_plugin("readEDID", (void *)&params, (void *)&response, 2)) {
-        if(response.HasLabel("EDID")) {
-            std::string edid_str = response["EDID"].String();
+void ctrlm_thunder_plugin_display_settings_t::on_edid(unsigned int sequence, bool success, void *data) {
+    JsonObject *response = (JsonObject *)data;
+
+    // Lock sempahore as we are touching EDID cache
+    sem_wait(&this->semaphore);
+
+    if(sequence != this->edid_sequence) {
+        XLOGD_INFO("Discarding stale EDID data");
+    } else if(success && response) {
+        if(response->HasLabel("EDID")) {
+            std::string edid_str = (*response)["EDID"].String();
             if(!edid_str.empty()) {
                 uint8_t *edid_buf  = NULL;
                 size_t   edid_size = 0;
@@ -117,7 +152,6 @@ bool ctrlm_thunder_plugin_display_settings_t::_get_edid() {
                             ss << ' ';
                         }
                     }
-                    ret = true;
                     XLOGD_INFO("EDID data <%d> bytes: \n<%s>", edid_size, ss.str().c_str());
                 } else {
                     XLOGD_ERROR("Failed to decode EDID base64!");
@@ -128,7 +162,7 @@ bool ctrlm_thunder_plugin_display_settings_t::_get_edid() {
             }
         } else {
             std::string response_str;
-            response.ToString(response_str);
+            response->ToString(response_str);
             XLOGD_ERROR("DisplaySettings readEDID response malformed: <%s>", response_str.c_str());
         }
     } else {
@@ -137,7 +171,6 @@ bool ctrlm_thunder_plugin_display_settings_t::_get_edid() {
 
     // Unlock semaphore as we are done touching the EDID cache
     sem_post(&this->semaphore);
-    return(ret);
 }
 
 void ctrlm_thunder_plugin_display_settings_t::_clear_edid() {
@@ -145,6 +178,7 @@ void ctrlm_thunder_plugin_display_settings_t::_clear_edid() {
     // Lock sempahore as we are touching EDID cache
     sem_wait(&this->semaphore);
     this->edid.clear();
+    this->edid_sequence++;
     // Unlock semaphore as we are done touching the EDID cache
     sem_post(&this->semaphore);
 }
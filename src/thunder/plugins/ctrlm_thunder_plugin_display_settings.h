@@ -53,6 +53,14 @@ public:
      */
     void on_hotplug(bool connected);
 
+    /**
+     * This function is technically used internally but from static function. This is used to parse the EDID data response.
+     * @param sequence The request sequence number, responses for superseded requests are discarded.
+     * @param success True if the call was successful, otherwise False.
+     * @param response The JsonObject response from the plugin.
+     */
+    void on_edid(unsigned int sequence, bool success, void *response);
+
 protected:
     /**
      * DisplaySettings Thunder Plugin Default Constructor
@@ -71,8 +79,9 @@ protected:
     virtual void on_initial_activation();
 
     /**
-     * This function actually calls the Display Settings Thunder Plugin to get the EDID data.
-     * @return True if the call was successful and there is data available, otherwise False.
+     * This function actually calls the Display Settings Thunder Plugin to get the EDID data. The call is
+     * asynchronous and the EDID cache is updated when the response arrives.
+     * @return True if the call was queued successfully, otherwise False.
      */
     bool _get_edid();
 
@@ -83,6 +92,7 @@ protected:
 
 private:
     std::vector<uint8_t> edid;
+    unsigned int         edid_sequence;
     sem_t                semaphore;
     bool                 registered_events;
 
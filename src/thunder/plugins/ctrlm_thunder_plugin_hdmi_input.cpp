@@ -71,6 +71,26 @@ static void _on_device_status_change(ctrlm_thunder_plugin_hdmi_input_t *plugin,
     g_idle_add(_on_device_status_change_thread, new std::pair<ctrlm_thunder_plugin_hdmi_input_t *, JsonObject>(plugin, params));
 }
 
+struct infoframe_request_t {
+    ctrlm_thunder_plugin_hdmi_input_t *plugin;
+    int                                port;
+    unsigned int                       sequence;
+};
+
+static void _on_infoframe(bool success, void *response, void *user_data) {
+    infoframe_request_t *request = (infoframe_request_t *)user_data;
+    if(request) {
+        if(request->plugin) {
+            request->plugin->on_infoframe(request->port, request->sequence, success, response);
+        } else {
+            XLOGD_ERROR("Plugin NULL");
+        }
+        delete request;
+    } else {
+        XLOGD_ERROR("Params NULL");
+    }
+}
+
 ctrlm_thunder_plugin_hdmi_input_t::ctrlm_thunder_plugin_hdmi_input_t() : ctrlm_thunder_plugin_t("HdmiInput", "org.rdk.HdmiInput", 2) {
     sem_init(&this->semaphore, 0, 1);
     this->registered_events = false;
@@ -95,8 +115,7 @@ void ctrlm_thunder_plugin_hdmi_input_t::get_infoframes(std::map<int, std::vector
 }
 
 bool ctrlm_thunder_plugin_hdmi_input_t::_get_infoframe(int port) {
-    bool ret = false;
-    JsonObject params, response;
+    JsonObject params;
 
     XLOGD_INFO("Calling HDMIInput for infoframe data for port %d", port);
 
@@ -104,10 +123,30 @@ bool ctrlm_thunder_plugin_hdmi_input_t::_get_infoframe(int port) {
     // Lock sempahore as we are touching infoframe cache
     sem_wait(&this->semaphore);
     this->infoframes[port].clear();
+    unsigned int sequence = ++this->infoframe_sequence[port];
+    // Unlock semaphore as we are done touching the infoframe cache
+    sem_post(&this->semaphore);
+
+    // The response is parsed on the main loop so the requests for all ports are in flight together
+    infoframe_request_t *request = new infoframe_request_t { this, port, sequence };
+    if(!this->call_plugin_async("getRawHDMISPD", (void *)&params, &_on_infoframe, (void *)request)) {
+        XLOGD_ERROR("HDMIInput readINFOFRAME call failed!");
+        delete request;
+        return(false);
+    }
+    return(true);
+}
+
+void ctrlm_thunder_plugin_hdmi_input_t::on_infoframe(int port, unsigned int sequence, bool success, void *data) {
+    JsonObject *response = (JsonObject *)data;
 
-    if(this->call_plugin("getRawHDMISPD", (void *)&params, (void *)&response)) {
-        if(response.HasLabel("HDMISPD")) {
-            std::string infoframe_str = response["HDMISPD"].String();
+    // Lock sempahore as we are touching infoframe cache
+    sem_wait(&this->semaphore);
+    if(sequence != this->infoframe_sequence[port]) {
+        XLOGD_INFO("Discarding stale infoframe data for port %d", port);
+    } else if(success && response) {
+        if(response->HasLabel("HDMISPD")) {
+            std::string infoframe_str = (*response)["HDMISPD"].String();
             if(!infoframe_str.empty()) {
                 uint8_t *infoframe_buf  = NULL;
                 size_t   infoframe_size = 0;
@@ -133,7 +172,6 @@ bool ctrlm_thunder_plugin_hdmi_input_t::_get_infoframe(int port) {
                             this->infoframes[port].pop_back();
                         }
                     }
-                    ret = true;
                 } else {
                     XLOGD_ERROR("Failed to decode Infoframe base64!");
                 }
@@ -143,7 +181,7 @@ bool ctrlm_thunder_plugin_hdmi_input_t::_get_infoframe(int port) {
             }
         } else {
             std::string response_str;
-            response.ToString(response_str);
+            response->ToString(response_str);
             XLOGD_ERROR("HDMIInput readINFOFRAME response malformed: <%s>", response_str.c_str());
         }
     } else {
@@ -152,7 +190,6 @@ bool ctrlm_thunder_plugin_hdmi_input_t::_get_infoframe(int port) {
 
     // Unlock semaphore as we are done touching the infoframe cache
     sem_post(&this->semaphore);
-    return(ret);
 }
 
 void ctrlm_thunder_plugin_hdmi_input_t::_clear_infoframe(int port) {
@@ -160,6 +197,7 @@ void ctrlm_thunder_plugin_hdmi_input_t::_clear_infoframe(int port) {
     // Lock sempahore as we are touching infoframe cache
     sem_wait(&this->semaphore);
     this->infoframes[port].clear();
+    this->infoframe_sequence[port]++;
     // Unlock semaphore as we are done touching the infoframe cache
     sem_post(&this->semaphore);
 }
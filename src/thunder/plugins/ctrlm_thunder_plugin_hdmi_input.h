@@ -60,6 +60,15 @@ public:
      */
     void check_device_list(void *params);
 
+    /**
+     * This function is technically used internally but from static function. This is used to parse the Infoframe data response.
+     * @param port The HDMI port the Infoframe data was requested for.
+     * @param sequence The request sequence number, responses for superseded requests are discarded.
+     * @param success True if the call was successful, otherwise False.
+     * @param response The JsonObject response from the plugin.
+     */
+    void on_infoframe(int port, unsigned int sequence, bool success, void *response);
+
 protected:
     /**
      * HDMIInput Thunder Plugin Default Constructor
@@ -78,8 +87,9 @@ protected:
     virtual void on_initial_activation();
 
     /**
-     * This function actually calls the HDMI Input Thunder Plugin to get the Infoframe data.
-     * @return True if the call was successful and there is data available, otherwise False.
+     * This function actually calls the HDMI Input Thunder Plugin to get the Infoframe data. The call is
+     * asynchronous and the Infoframe cache is updated when the response arrives.
+     * @return True if the call was queued successfully, otherwise False.
      */
     bool _get_infoframe(int port);
 
@@ -90,6 +100,7 @@ protected:
 
 private:
     std::map<int, std::vector<uint8_t> > infoframes;
+    std::map<int, unsigned int>          infoframe_sequence;
     sem_t                                semaphore;
     bool                                 registered_events;
 
@@ -33,6 +33,7 @@ static void _on_firmware_update_state_change(ctrlm_thunder_plugin_system_t *plug
 ctrlm_thunder_plugin_system_t::ctrlm_thunder_plugin_system_t() : ctrlm_thunder_plugin_t("System", "org.rdk.System", 1) {
     this->registered_events = false;
     this->estb_mac = "";
+    this->cache_ttl_set("getDeviceInfo", std::chrono::hours(1));
 }
 
 ctrlm_thunder_plugin_system_t::~ctrlm_thunder_plugin_system_t() {
@@ -71,6 +72,8 @@ void ctrlm_thunder_plugin_system_t::remove_event_handler(system_event_handler_t
 
 void ctrlm_thunder_plugin_system_t::on_firmware_update_state_change(firmware_update_state_t state) {
     XLOGD_INFO("state: %s", system_firmware_update_state_str(state));
+    // The image version reported in the device info changes with a firmware update
+    this->cache_invalidate("getDeviceInfo");
     for(auto &itr : this->event_callbacks) {
         itr.first(EVENT_FIRMWARE_UPDATE_STATE_CHANGED, (void *)state, itr.second);
     }
@@ -21,7 +21,9 @@
 #include <iostream>
 #include <iomanip>
 #include <unistd.h>
+#include <fcntl.h>
 #include <string.h>
+#include <sys/uio.h>
 #include <semaphore.h>
 #include "include/ctrlm_ipc.h"
 #include "include/ctrlm_ipc_voice.h"
@@ -99,6 +101,7 @@ ctrlm_voice_t::ctrlm_voice_t() {
 
         session->audio_pipe[PIPE_READ]     = -1;
         session->audio_pipe[PIPE_WRITE]    = -1;
+        session->audio_pipe_ptt            = false;
         session->audio_sent_bytes          =  0;
         session->audio_sent_samples        =  0;
         session->packets_processed         = 0;
@@ -139,6 +142,9 @@ ctrlm_voice_t::ctrlm_voice_t() {
     }
     this->timeout_ctrl_session_stats_rxd  =  0;
     this->timeout_keyword_beep            =  0;
+    this->audio_pipe_spare[PIPE_READ]     = -1;
+    this->audio_pipe_spare[PIPE_WRITE]    = -1;
+    sem_init(&this->audio_pipe_spare_semaphore, 0, 1);
     this->session_id                      =  0;
     this->software_version                = "N/A";
     this->mask_pii                        = ctrlm_is_production_build() ? JSON_ARRAY_VAL_BOOL_CTRLM_GLOBAL_MASK_PII_0 : JSON_ARRAY_VAL_BOOL_CTRLM_GLOBAL_MASK_PII_1;
@@ -286,6 +292,9 @@ ctrlm_voice_t::ctrlm_voice_t() {
         rfc->add_changed_listener(ctrlm_rfc_t::attrs::VOICE, std::bind(&ctrlm_voice_t::voice_rfc_retrieved_handler, this, std::placeholders::_1));
         rfc->add_changed_listener(ctrlm_rfc_t::attrs::VSDK, std::bind(&ctrlm_voice_t::vsdk_rfc_retrieved_handler, this, std::placeholders::_1));
     }
+
+    // Have a pipe ready for the first PTT session
+    this->voice_session_pipe_spare_fill();
 }
 
 ctrlm_voice_t::~ctrlm_voice_t() {
@@ -312,6 +321,7 @@ ctrlm_voice_t::~ctrlm_voice_t() {
             session->audio_pipe[PIPE_WRITE] = -1;
         }
     }
+    voice_session_pipe_spare_close();
 
     if(this->beep_on_kwd_supported && this->sap_opened) {
         if(!this->obj_sap->close()) {
@@ -326,6 +336,7 @@ ctrlm_voice_t::~ctrlm_voice_t() {
         ctrlm_voice_session_t *session = &this->voice_session[group];
         sem_destroy(&session->current_vsr_err_semaphore);
     }
+    sem_destroy(&this->audio_pipe_spare_semaphore);
 }
 
 bool ctrlm_voice_t::vsdk_is_privacy_enabled(void) {
@@ -1363,6 +1374,7 @@ ctrlm_voice_session_response_status_t ctrlm_voice_t::voice_session_req(ctrlm_net
     }
 
     int fds[2] = { -1, -1 };
+    bool create_pipe = false;
     bool is_mic = ctrlm_voice_device_is_mic(device_type);
     bool is_session_by_text = (l_transcription_in != NULL);
     bool is_session_by_file = (audio_file_in      != NULL);
@@ -1434,15 +1446,12 @@ ctrlm_voice_session_response_status_t ctrlm_voice_t::voice_session_req(ctrlm_net
             return VOICE_SESSION_RESPONSE_BUSY;
         }
 
-        bool create_pipe = (device_type == CTRLM_VOICE_DEVICE_PTT && !use_external_data_pipe);
+        create_pipe = (device_type == CTRLM_VOICE_DEVICE_PTT && !use_external_data_pipe);
         if(create_pipe) {
-            errno = 0;
-            if(pipe(fds) < 0) {
-                int errsv = errno;
-                XLOGD_ERROR("Failed to create pipe <%s>", strerror(errsv));
+            if(!this->voice_session_pipe_get(fds)) {
                 this->voice_session_notify_abort(network_id, controller_id, 0, CTRLM_VOICE_SESSION_ABORT_REASON_FAILURE);
                 return(VOICE_SESSION_RESPONSE_FAILURE);
-            } // set to non-blocking
+            }
         }
 
         if(request_new_session) {
@@ -1479,6 +1488,7 @@ ctrlm_voice_session_response_status_t ctrlm_voice_t::voice_session_req(ctrlm_net
     session->format                    = format;
     session->audio_pipe[PIPE_READ]     = fds[PIPE_READ];
     session->audio_pipe[PIPE_WRITE]    = fds[PIPE_WRITE];
+    session->audio_pipe_ptt            = create_pipe;
     session->controller_id             = controller_id;
     session->network_id                = network_id;
     session->network_type              = ctrlm_network_type_get(network_id);
@@ -1645,6 +1655,60 @@ static void ctrlm_voice_data_post_processing_cb(int bytes_sent, void *user_data)
     }
 }
 
+bool ctrlm_voice_t::voice_session_pipe_get(int *fds) {
+    bool spare = false;
+
+    sem_wait(&this->audio_pipe_spare_semaphore);
+    if(this->audio_pipe_spare[PIPE_READ] >= 0 && this->audio_pipe_spare[PIPE_WRITE] >= 0) {
+        fds[PIPE_READ]                     = this->audio_pipe_spare[PIPE_READ];
+        fds[PIPE_WRITE]                    = this->audio_pipe_spare[PIPE_WRITE];
+        this->audio_pipe_spare[PIPE_READ]  = -1;
+        this->audio_pipe_spare[PIPE_WRITE] = -1;
+        spare = true;
+    }
+    sem_post(&this->audio_pipe_spare_semaphore);
+
+    if(spare) {
+        XLOGD_DEBUG("using spare pipe wr <%d> rd <%d>", fds[PIPE_WRITE], fds[PIPE_READ]);
+        return(true);
+    }
+
+    errno = 0;
+    if(pipe2(fds, O_CLOEXEC) < 0) {
+        int errsv = errno;
+        XLOGD_ERROR("Failed to create pipe <%s>", strerror(errsv));
+        return(false);
+    }
+    return(true);
+}
+
+void ctrlm_voice_t::voice_session_pipe_spare_fill() {
+    sem_wait(&this->audio_pipe_spare_semaphore);
+    if(this->audio_pipe_spare[PIPE_READ] < 0 && this->audio_pipe_spare[PIPE_WRITE] < 0) {
+        errno = 0;
+        if(pipe2(this->audio_pipe_spare, O_CLOEXEC) < 0) {
+            int errsv = errno;
+            XLOGD_WARN("Failed to create spare pipe <%s>", strerror(errsv));
+            this->audio_pipe_spare[PIPE_READ]  = -1;
+            this->audio_pipe_spare[PIPE_WRITE] = -1;
+        }
+    }
+    sem_post(&this->audio_pipe_spare_semaphore);
+}
+
+void ctrlm_voice_t::voice_session_pipe_spare_close() {
+    sem_wait(&this->audio_pipe_spare_semaphore);
+    if(this->audio_pipe_spare[PIPE_READ] >= 0) {
+        close(this->audio_pipe_spare[PIPE_READ]);
+        this->audio_pipe_spare[PIPE_READ] = -1;
+    }
+    if(this->audio_pipe_spare[PIPE_WRITE] >= 0) {
+        close(this->audio_pipe_spare[PIPE_WRITE]);
+        this->audio_pipe_spare[PIPE_WRITE] = -1;
+    }
+    sem_post(&this->audio_pipe_spare_semaphore);
+}
+
 void ctrlm_voice_t::voice_session_data_post_processing(int bytes_sent, const char *action, ctrlm_timestamp_t *timestamp) {
     ctrlm_voice_session_t *session = &this->voice_session[VOICE_SESSION_GROUP_DEFAULT];  // This is for PTT only
 
@@ -1788,8 +1852,7 @@ bool ctrlm_voice_t::voice_session_data(ctrlm_network_id_t network_id, ctrlm_cont
 }
 
 bool ctrlm_voice_t::voice_session_data(ctrlm_network_id_t network_id, ctrlm_controller_id_t controller_id, const char *buffer, long unsigned int length, ctrlm_timestamp_t *timestamp, uint8_t *lqi) {
-    char              local_buf[length + 1];
-    long unsigned int bytes_written = 0;
+    ssize_t           bytes_written = 0;
     ctrlm_voice_session_t *session = &this->voice_session[VOICE_SESSION_GROUP_DEFAULT]; // This is for PTT only
     if(session->state_src != CTRLM_VOICE_STATE_SRC_STREAMING) {
         XLOGD_ERROR("No voice session in progress");
@@ -1833,18 +1896,27 @@ bool ctrlm_voice_t::voice_session_data(ctrlm_network_id_t network_id, ctrlm_cont
     const char *action = "dumped";
     if(session->state_dst != CTRLM_VOICE_STATE_DST_READY) { // destination is accepting more data
        action = "sent";
+       // Opus frames are prefixed with their length. Gather the prefix and the caller's buffer into a single
+       // write so the frame stays contiguous in the pipe without copying the payload.
+       uint8_t      frame_len = (uint8_t)length;
+       struct iovec iov[2];
+       int          iov_qty   = 0;
        if(session->format.type == CTRLM_VOICE_FORMAT_OPUS || session->format.type == CTRLM_VOICE_FORMAT_OPUS_XVP) {
-           // Copy to local buffer to perform a single write to the pipe.  TODO: have the caller reserve 1 bytes at the beginning
-           // of the buffer to eliminate this copy
-           local_buf[0] = length;
-           errno_t safec_rc = memcpy_s(&local_buf[1], sizeof(local_buf)-1, buffer, length);
-           ERR_CHK(safec_rc);
-           buffer = local_buf;
+           iov[iov_qty].iov_base = &frame_len;
+           iov[iov_qty].iov_len  = sizeof(frame_len);
+           iov_qty++;
+       }
+       iov[iov_qty].iov_base = (void *)buffer;
+       iov[iov_qty].iov_len  = length;
+       iov_qty++;
+       if(iov_qty > 1) {
            length++;
        }
 
-       bytes_written = write(session->audio_pipe[PIPE_WRITE], buffer, length);
-       if(bytes_written != length) {
+       do {
+           bytes_written = writev(session->audio_pipe[PIPE_WRITE], iov, iov_qty);
+       } while(bytes_written < 0 && errno == EINTR);
+       if(bytes_written < 0 || (long unsigned int)bytes_written != length) {
            XLOGD_ERROR("Failed to write data to pipe: %s", strerror(errno));
            return(false);
        }
@@ -1894,6 +1966,12 @@ void ctrlm_voice_t::voice_session_end(ctrlm_voice_session_t *session, ctrlm_voic
         XLOGD_INFO("Close write pipe - fd <%d>", session->audio_pipe[PIPE_WRITE]);
         close(session->audio_pipe[PIPE_WRITE]);
         session->audio_pipe[PIPE_WRITE] = -1;
+
+        // Replace the pipe that was taken for this session now that audio is done
+        if(session->audio_pipe_ptt) {
+            session->audio_pipe_ptt = false;
+            this->voice_session_pipe_spare_fill();
+        }
     }
 
     // Send main queue message
@@ -1927,7 +2005,7 @@ void ctrlm_voice_t::voice_session_end(ctrlm_voice_session_t *session, ctrlm_voic
         }
         #endif
     }
-    ctrlm_main_queue_handler_push(CTRLM_HANDLER_NETWORK, (ctrlm_msg_handler_network_t)&ctrlm_obj_network_t::ind_process_voice_session_end, &end, sizeof(end), NULL, session->network_id);
+    ctrlm_main_queue_handler_push_priority(CTRLM_MAIN_QUEUE_PRIORITY_INTERACTIVE, CTRLM_HANDLER_NETWORK, (ctrlm_msg_handler_network_t)&ctrlm_obj_network_t::ind_process_voice_session_end, &end, sizeof(end), NULL, session->network_id);
 
     // clear session_active_controller for controllers that don't support voice command status
     if(!session->controller_command_status) {
@@ -2058,6 +2136,7 @@ void ctrlm_voice_t::voice_session_stats_clear(ctrlm_voice_session_t *session) {
    timing->srvr_audio_txd_keyword = { 0, 0 };
    timing->srvr_audio_txd_final   = { 0, 0 };
    timing->srvr_rsp_keyword       = { 0, 0 };
+   timing->srvr_response          = { 0, 0 };
    timing->srvr_disconnect        = { 0, 0 };
 }
 
@@ -2135,6 +2214,17 @@ void ctrlm_voice_t::voice_session_stats_print(ctrlm_voice_session_t *session) {
          }
       }
    }
+
+   session_timeline.add(session->ipc_common_data.session_id_ctrlm, ctrlm_voice_device_str(session->voice_device), *timing);
+   session_timeline.phase_stats_log();
+}
+
+json_t *ctrlm_voice_t::voice_session_phase_stats_json() const {
+   return(session_timeline.phase_stats_json());
+}
+
+bool ctrlm_voice_t::voice_session_timeline_export(const char *path) const {
+   return(session_timeline.trace_export(path));
 }
 
 void ctrlm_voice_t::voice_session_info(xrsr_src_t src, ctrlm_voice_session_info_t *data) {
@@ -3114,6 +3204,10 @@ void ctrlm_voice_t::voice_session_transcription_callback(const uuid_t uuid, cons
         return;
     }
 
+    if(session->session_timing.srvr_response.tv_sec == 0 && session->session_timing.srvr_response.tv_nsec == 0) {
+        rdkx_timestamp_get_realtime(&session->session_timing.srvr_response);
+    }
+
     if(transcription) {
         session->transcription = transcription;
     } else {
@@ -3130,6 +3224,9 @@ void ctrlm_voice_t::voice_server_return_code_callback(const uuid_t uuid, const c
         XLOGD_ERROR("session not found");
         return;
     }
+    if(session->session_timing.srvr_response.tv_sec == 0 && session->session_timing.srvr_response.tv_nsec == 0) {
+        rdkx_timestamp_get_realtime(&session->session_timing.srvr_response);
+    }
     session->server_ret_code = ret_code;
     if(reason != NULL) {
         session->server_message = reason;
@@ -3841,6 +3938,10 @@ void ctrlm_voice_t::voice_device_enable(ctrlm_voice_device_t device, bool db_wri
     }
 
     sem_post(&this->device_status_semaphore);
+
+    if(device == CTRLM_VOICE_DEVICE_PTT) {
+        this->voice_session_pipe_spare_fill();
+    }
 }
 
 void ctrlm_voice_t::voice_device_disable(ctrlm_voice_device_t device, bool db_write, bool *update_routes) {
@@ -3859,6 +3960,10 @@ void ctrlm_voice_t::voice_device_disable(ctrlm_voice_device_t device, bool db_wr
     }
 
     sem_post(&this->device_status_semaphore);
+
+    if(device == CTRLM_VOICE_DEVICE_PTT) { // No PTT sessions until it is enabled again
+        this->voice_session_pipe_spare_close();
+    }
 }
 
 void ctrlm_voice_system_audio_player_event_handler(system_audio_player_event_t event, void *user_data) {
@@ -34,6 +34,7 @@
 #include "xr_timestamp.h"
 #include "ctrlm_voice_types.h"
 #include "ctrlm_voice_ipc.h"
+#include "ctrlm_voice_timeline.h"
 #include "ctrlm_rfc.h"
 #include "xrsr.h"
 #include "ctrlm_voice_telemetry_events.h"
@@ -327,29 +328,6 @@ typedef struct {
    uint16_t par_voice_eos_timeout;
 } voice_params_par_t;
 
-typedef struct {
-   bool             available;
-   bool             connect_attempt;
-   bool             connect_success;
-   bool             has_keyword;
-   rdkx_timestamp_t ctrl_request;
-   rdkx_timestamp_t ctrl_response;
-   rdkx_timestamp_t ctrl_audio_rxd_first;
-   rdkx_timestamp_t ctrl_audio_rxd_keyword;
-   rdkx_timestamp_t ctrl_audio_rxd_final;
-   rdkx_timestamp_t ctrl_stop;
-   rdkx_timestamp_t ctrl_cmd_status_wr;
-   rdkx_timestamp_t ctrl_cmd_status_rd;
-   rdkx_timestamp_t srvr_request;
-   rdkx_timestamp_t srvr_connect;
-   rdkx_timestamp_t srvr_init_txd;
-   rdkx_timestamp_t srvr_audio_txd_first;
-   rdkx_timestamp_t srvr_audio_txd_keyword;
-   rdkx_timestamp_t srvr_audio_txd_final;
-   rdkx_timestamp_t srvr_rsp_keyword;
-   rdkx_timestamp_t srvr_disconnect;
-} ctrlm_voice_session_timing_t;
-
 typedef struct {
    std::string                     controller_name;
    std::string                     controller_version_sw;
@@ -434,6 +412,7 @@ typedef struct {
    uuid_t                           uuid;
    std::string                      uuid_str;
    int                              audio_pipe[2];
+   bool                             audio_pipe_ptt; // pipe came from voice_session_pipe_get and is replaced when the session ends
    unsigned long                    audio_sent_bytes;
    unsigned long                    audio_sent_samples;
    bool                             requested_more_audio;
@@ -563,6 +542,8 @@ class ctrlm_voice_t {
     void                                  voice_status_set(ctrlm_voice_session_t *session);
     void                                  voice_status_set(const uuid_t uuid);
     void                                  voice_device_update_in_progress_set(bool in_progress);
+    json_t *                              voice_session_phase_stats_json() const;
+    bool                                  voice_session_timeline_export(const char *path) const;
 
     void                                  voice_rfc_retrieved_handler(const ctrlm_rfc_attr_t& attr);
     void                                  vsdk_rfc_retrieved_handler(const ctrlm_rfc_attr_t& attr);
@@ -591,6 +572,10 @@ protected:
     void                                  voice_set_ipc(ctrlm_voice_ipc_t *ipc);
     // End Application Interface
 
+    bool                                  voice_session_pipe_get(int *fds);
+    void                                  voice_session_pipe_spare_fill();
+    void                                  voice_session_pipe_spare_close();
+
     // Static Callbacks
     static int ctrlm_voice_packet_timeout(void *data);
     static int ctrlm_voice_controller_session_stats_rxd_timeout(void *data);
@@ -725,6 +710,11 @@ public:
     bool                                     audio_ducking_beep_in_progress;
 
     // End Current Session Data
+
+    // Audio pipe created ahead of the next PTT session so the request path doesn't pay for it
+    int                      audio_pipe_spare[2];
+    sem_t                    audio_pipe_spare_semaphore;
+
     // Timeout tags
     unsigned int             timeout_ctrl_session_stats_rxd;
     unsigned int             timeout_keyword_beep;
@@ -732,6 +722,9 @@ public:
 
     int packet_loss_threshold;
 
+    // Timelines of the most recent sessions
+    ctrlm_voice_timeline_t   session_timeline;
+
     #ifdef TELEMETRY_SUPPORT
     ctrlm_voice_telemetry_vsr_error_map_t vsr_errors;
     #endif
@@ -0,0 +1,260 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#include <algorithm>
+#include "ctrlm_voice_timeline.h"
+#include "ctrlm_log.h"
+
+static bool               ctrlm_voice_timeline_is_set(const rdkx_timestamp_t &timestamp);
+static unsigned long long ctrlm_voice_timeline_us(const rdkx_timestamp_t &timestamp);
+static signed long long   ctrlm_voice_timeline_elapsed(const rdkx_timestamp_t &begin, const rdkx_timestamp_t &end);
+static void               ctrlm_voice_timeline_span(json_t *events, unsigned long tid, const char *name, const rdkx_timestamp_t &begin, const rdkx_timestamp_t &end);
+static void               ctrlm_voice_timeline_instant(json_t *events, unsigned long tid, const char *name, const rdkx_timestamp_t &timestamp);
+
+ctrlm_voice_timeline_t::ctrlm_voice_timeline_t(size_t capacity) : capacity_(capacity ? capacity : 1) {
+   entries_.reserve(capacity_);
+}
+
+const char *ctrlm_voice_timeline_t::phase_str(ctrlm_voice_phase_t phase) {
+   switch(phase) {
+      case CTRLM_VOICE_PHASE_KEY_TO_STREAM_BEGIN:   return("keyToStreamBegin");
+      case CTRLM_VOICE_PHASE_AUDIO_FIRST_TO_SERVER: return("firstAudioToServer");
+      case CTRLM_VOICE_PHASE_EOS_TO_RESPONSE:       return("endOfSpeechToResponse");
+      default: break;
+   }
+   return("invalid");
+}
+
+void ctrlm_voice_timeline_t::phase_calc(entry_t &entry) {
+   const ctrlm_voice_session_timing_t &timing = entry.timing;
+
+   for(unsigned int phase = 0; phase < CTRLM_VOICE_PHASE_QTY; phase++) {
+      entry.phase_us[phase] = -1;
+   }
+   if(!timing.connect_success) { // Nothing was streamed to the server
+      return;
+   }
+   entry.phase_us[CTRLM_VOICE_PHASE_KEY_TO_STREAM_BEGIN]   = ctrlm_voice_timeline_elapsed(timing.ctrl_request, timing.srvr_audio_txd_first);
+   entry.phase_us[CTRLM_VOICE_PHASE_AUDIO_FIRST_TO_SERVER] = ctrlm_voice_timeline_elapsed(timing.ctrl_audio_rxd_first, timing.srvr_audio_txd_first);
+   if(ctrlm_voice_timeline_is_set(timing.srvr_response)) {
+      entry.phase_us[CTRLM_VOICE_PHASE_EOS_TO_RESPONSE] = ctrlm_voice_timeline_elapsed(timing.srvr_audio_txd_final, timing.srvr_response);
+   } else {
+      entry.phase_us[CTRLM_VOICE_PHASE_EOS_TO_RESPONSE] = ctrlm_voice_timeline_elapsed(timing.srvr_audio_txd_final, timing.srvr_disconnect);
+   }
+}
+
+void ctrlm_voice_timeline_t::add(unsigned long session_id, const std::string &device, const ctrlm_voice_session_timing_t &timing) {
+   entry_t entry;
+   entry.session_id = session_id;
+   entry.device     = device;
+   entry.timing     = timing;
+   phase_calc(entry);
+
+   std::lock_guard<std::mutex> lock(mutex_);
+   if(entries_.size() < capacity_) {
+      entries_.push_back(entry);
+   } else {
+      entries_[next_] = entry;
+   }
+   next_ = (next_ + 1) % capacity_;
+}
+
+void ctrlm_voice_timeline_t::clear() {
+   std::lock_guard<std::mutex> lock(mutex_);
+   entries_.clear();
+   next_ = 0;
+}
+
+size_t ctrlm_voice_timeline_t::size() const {
+   std::lock_guard<std::mutex> lock(mutex_);
+   return(entries_.size());
+}
+
+bool ctrlm_voice_timeline_t::phase_stats(ctrlm_voice_phase_t phase, ctrlm_voice_phase_stats_t *stats) const {
+   if(stats == NULL || (unsigned int)phase >= CTRLM_VOICE_PHASE_QTY) {
+      return(false);
+   }
+   std::vector<unsigned long long> values;
+   {
+      std::lock_guard<std::mutex> lock(mutex_);
+      values.reserve(entries_.size());
+      for(auto const &entry : entries_) {
+         if(entry.phase_us[phase] >= 0) {
+            values.push_back(entry.phase_us[phase]);
+         }
+      }
+   }
+   stats->count  = values.size();
+   stats->p50_us = 0;
+   stats->p95_us = 0;
+   stats->p99_us = 0;
+   stats->max_us = 0;
+   if(values.empty()) {
+      return(false);
+   }
+   std::sort(values.begin(), values.end());
+
+   // Nearest rank
+   auto rank = [&values](unsigned int percent) {
+      size_t index = (values.size() * percent + 99) / 100;
+      return(values[(index > 0) ? (index - 1) : 0]);
+   };
+   stats->p50_us = rank(50);
+   stats->p95_us = rank(95);
+   stats->p99_us = rank(99);
+   stats->max_us = values.back();
+   return(true);
+}
+
+json_t *ctrlm_voice_timeline_t::phase_stats_json() const {
+   json_t *obj = json_object();
+   int     rc  = 0;
+
+   for(unsigned int phase = 0; phase < CTRLM_VOICE_PHASE_QTY; phase++) {
+      ctrlm_voice_phase_stats_t stats;
+      phase_stats((ctrlm_voice_phase_t)phase, &stats);
+
+      json_t *obj_phase = json_object();
+      rc |= json_object_set_new_nocheck(obj_phase, "count", json_integer(stats.count));
+      rc |= json_object_set_new_nocheck(obj_phase, "p50",   json_integer(stats.p50_us / 1000));
+      rc |= json_object_set_new_nocheck(obj_phase, "p95",   json_integer(stats.p95_us / 1000));
+      rc |= json_object_set_new_nocheck(obj_phase, "p99",   json_integer(stats.p99_us / 1000));
+      rc |= json_object_set_new_nocheck(obj_phase, "max",   json_integer(stats.max_us / 1000));
+      rc |= json_object_set_new_nocheck(obj, phase_str((ctrlm_voice_phase_t)phase), obj_phase);
+   }
+   if(rc) {
+      XLOGD_WARN("JSON error..");
+   }
+   return(obj);
+}
+
+void ctrlm_voice_timeline_t::phase_stats_log() const {
+   for(unsigned int phase = 0; phase < CTRLM_VOICE_PHASE_QTY; phase++) {
+      ctrlm_voice_phase_stats_t stats;
+      if(phase_stats((ctrlm_voice_phase_t)phase, &stats)) {
+         XLOGD_INFO("%s sessions <%lu> p50 <%llu> p95 <%llu> p99 <%llu> max <%llu> ms", phase_str((ctrlm_voice_phase_t)phase), stats.count,
+                    stats.p50_us / 1000, stats.p95_us / 1000, stats.p99_us / 1000, stats.max_us / 1000);
+      }
+   }
+}
+
+// Chrome trace event format. Each session is a thread, its phases are complete ("X") events and single points are instant ("i") events.
+json_t *ctrlm_voice_timeline_t::trace_json() const {
+   json_t *events = json_array();
+
+   std::lock_guard<std::mutex> lock(mutex_);
+   for(size_t i = 0; i < entries_.size(); i++) {
+      // Oldest session first
+      const entry_t &entry = entries_[(entries_.size() < capacity_) ? i : ((next_ + i) % capacity_)];
+      const ctrlm_voice_session_timing_t &timing = entry.timing;
+
+      json_t *meta = json_object();
+      json_t *args = json_object();
+      std::string name = "session " + std::to_string(entry.session_id) + " " + entry.device;
+      json_object_set_new_nocheck(args, "name", json_string(name.c_str()));
+      json_object_set_new_nocheck(meta, "name", json_string("thread_name"));
+      json_object_set_new_nocheck(meta, "ph",   json_string("M"));
+      json_object_set_new_nocheck(meta, "pid",  json_integer(1));
+      json_object_set_new_nocheck(meta, "tid",  json_integer(entry.session_id));
+      json_object_set_new_nocheck(meta, "args", args);
+      json_array_append_new(events, meta);
+
+      ctrlm_voice_timeline_span(events, entry.session_id, "controller session",  timing.ctrl_request,         timing.ctrl_stop);
+      ctrlm_voice_timeline_span(events, entry.session_id, "controller audio",    timing.ctrl_audio_rxd_first, timing.ctrl_audio_rxd_final);
+      ctrlm_voice_timeline_span(events, entry.session_id, "server session",      timing.srvr_request,         timing.srvr_disconnect);
+      ctrlm_voice_timeline_span(events, entry.session_id, "server connect",      timing.srvr_request,         timing.srvr_connect);
+      ctrlm_voice_timeline_span(events, entry.session_id, "server stream",       timing.srvr_audio_txd_first, timing.srvr_audio_txd_final);
+      ctrlm_voice_timeline_span(events, entry.session_id, "server response",     timing.srvr_audio_txd_final, timing.srvr_response);
+      ctrlm_voice_timeline_instant(events, entry.session_id, "controller response",  timing.ctrl_response);
+      ctrlm_voice_timeline_instant(events, entry.session_id, "command status write", timing.ctrl_cmd_status_wr);
+      ctrlm_voice_timeline_instant(events, entry.session_id, "command status read",  timing.ctrl_cmd_status_rd);
+      if(timing.has_keyword) {
+         ctrlm_voice_timeline_instant(events, entry.session_id, "keyword received",    timing.ctrl_audio_rxd_keyword);
+         ctrlm_voice_timeline_instant(events, entry.session_id, "keyword sent",        timing.srvr_audio_txd_keyword);
+         ctrlm_voice_timeline_instant(events, entry.session_id, "keyword verified",    timing.srvr_rsp_keyword);
+      }
+   }
+
+   json_t *obj = json_object();
+   json_object_set_new_nocheck(obj, "traceEvents",     events);
+   json_object_set_new_nocheck(obj, "displayTimeUnit", json_string("ms"));
+   return(obj);
+}
+
+bool ctrlm_voice_timeline_t::trace_export(const char *path) const {
+   if(path == NULL) {
+      return(false);
+   }
+   json_t *obj = trace_json();
+   int rc = json_dump_file(obj, path, JSON_COMPACT);
+   json_decref(obj);
+   if(rc != 0) {
+      XLOGD_ERROR("unable to write <%s>", path);
+      return(false);
+   }
+   XLOGD_INFO("exported <%zu> voice session timelines to <%s>", size(), path);
+   return(true);
+}
+
+bool ctrlm_voice_timeline_is_set(const rdkx_timestamp_t &timestamp) {
+   return(timestamp.tv_sec != 0 || timestamp.tv_nsec != 0);
+}
+
+unsigned long long ctrlm_voice_timeline_us(const rdkx_timestamp_t &timestamp) {
+   return((unsigned long long)timestamp.tv_sec * 1000000 + timestamp.tv_nsec / 1000);
+}
+
+// Returns -1 if either timestamp is missing or they are out of order
+signed long long ctrlm_voice_timeline_elapsed(const rdkx_timestamp_t &begin, const rdkx_timestamp_t &end) {
+   if(!ctrlm_voice_timeline_is_set(begin) || !ctrlm_voice_timeline_is_set(end)) {
+      return(-1);
+   }
+   signed long long elapsed = rdkx_timestamp_subtract_us(begin, end);
+   return((elapsed < 0) ? -1 : elapsed);
+}
+
+void ctrlm_voice_timeline_span(json_t *events, unsigned long tid, const char *name, const rdkx_timestamp_t &begin, const rdkx_timestamp_t &end) {
+   signed long long duration = ctrlm_voice_timeline_elapsed(begin, end);
+   if(duration < 0) {
+      return;
+   }
+   json_t *event = json_object();
+   json_object_set_new_nocheck(event, "name", json_string(name));
+   json_object_set_new_nocheck(event, "cat",  json_string("voice"));
+   json_object_set_new_nocheck(event, "ph",   json_string("X"));
+   json_object_set_new_nocheck(event, "ts",   json_integer(ctrlm_voice_timeline_us(begin)));
+   json_object_set_new_nocheck(event, "dur",  json_integer(duration));
+   json_object_set_new_nocheck(event, "pid",  json_integer(1));
+   json_object_set_new_nocheck(event, "tid",  json_integer(tid));
+   json_array_append_new(events, event);
+}
+
+void ctrlm_voice_timeline_instant(json_t *events, unsigned long tid, const char *name, const rdkx_timestamp_t &timestamp) {
+   if(!ctrlm_voice_timeline_is_set(timestamp)) {
+      return;
+   }
+   json_t *event = json_object();
+   json_object_set_new_nocheck(event, "name", json_string(name));
+   json_object_set_new_nocheck(event, "cat",  json_string("voice"));
+   json_object_set_new_nocheck(event, "ph",   json_string("i"));
+   json_object_set_new_nocheck(event, "s",    json_string("t"));
+   json_object_set_new_nocheck(event, "ts",   json_integer(ctrlm_voice_timeline_us(timestamp)));
+   json_object_set_new_nocheck(event, "pid",  json_integer(1));
+   json_object_set_new_nocheck(event, "tid",  json_integer(tid));
+   json_array_append_new(events, event);
+}
@@ -0,0 +1,106 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2024 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+#ifndef __CTRLM_VOICE_TIMELINE_H__
+#define __CTRLM_VOICE_TIMELINE_H__
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include "jansson.h"
+#include "xr_timestamp.h"
+
+#define CTRLM_VOICE_TIMELINE_QTY_DEFAULT (64)
+#define CTRLM_VOICE_TIMELINE_EXPORT_FILE "/tmp/ctrlm_voice_timeline.json"
+
+typedef struct {
+   bool             available;
+   bool             connect_attempt;
+   bool             connect_success;
+   bool             has_keyword;
+   rdkx_timestamp_t ctrl_request;
+   rdkx_timestamp_t ctrl_response;
+   rdkx_timestamp_t ctrl_audio_rxd_first;
+   rdkx_timestamp_t ctrl_audio_rxd_keyword;
+   rdkx_timestamp_t ctrl_audio_rxd_final;
+   rdkx_timestamp_t ctrl_stop;
+   rdkx_timestamp_t ctrl_cmd_status_wr;
+   rdkx_timestamp_t ctrl_cmd_status_rd;
+   rdkx_timestamp_t srvr_request;
+   rdkx_timestamp_t srvr_connect;
+   rdkx_timestamp_t srvr_init_txd;
+   rdkx_timestamp_t srvr_audio_txd_first;
+   rdkx_timestamp_t srvr_audio_txd_keyword;
+   rdkx_timestamp_t srvr_audio_txd_final;
+   rdkx_timestamp_t srvr_rsp_keyword;
+   rdkx_timestamp_t srvr_response;
+   rdkx_timestamp_t srvr_disconnect;
+} ctrlm_voice_session_timing_t;
+
+typedef enum {
+   CTRLM_VOICE_PHASE_KEY_TO_STREAM_BEGIN   = 0, // session request from the controller to the stream beginning at the server
+   CTRLM_VOICE_PHASE_AUDIO_FIRST_TO_SERVER = 1, // first audio received from the source to the stream beginning at the server
+   CTRLM_VOICE_PHASE_EOS_TO_RESPONSE       = 2, // end of the stream to the server's response (or disconnect when there is none)
+   CTRLM_VOICE_PHASE_QTY                   = 3
+} ctrlm_voice_phase_t;
+
+typedef struct {
+   unsigned long      count;
+   unsigned long long p50_us;
+   unsigned long long p95_us;
+   unsigned long long p99_us;
+   unsigned long long max_us;
+} ctrlm_voice_phase_stats_t;
+
+// Keeps the timelines of the most recent voice sessions. The phase percentiles are calculated exactly over the
+// sessions in the ring, so they roll with it and are deterministic for a given set of sessions. Only the timing
+// structure is needed, so sessions from any endpoint (including a local fake one) can be added.
+class ctrlm_voice_timeline_t {
+public:
+   ctrlm_voice_timeline_t(size_t capacity = CTRLM_VOICE_TIMELINE_QTY_DEFAULT);
+
+   void        add(unsigned long session_id, const std::string &device, const ctrlm_voice_session_timing_t &timing);
+   void        clear();
+   size_t      size() const;
+
+   bool        phase_stats(ctrlm_voice_phase_t phase, ctrlm_voice_phase_stats_t *stats) const;
+   json_t *    phase_stats_json() const;
+   void        phase_stats_log() const;
+
+   json_t *    trace_json() const;
+   bool        trace_export(const char *path) const;
+
+   static const char *phase_str(ctrlm_voice_phase_t phase);
+
+private:
+   typedef struct {
+      unsigned long                session_id;
+      std::string                  device;
+      ctrlm_voice_session_timing_t timing;
+      signed long long             phase_us[CTRLM_VOICE_PHASE_QTY]; // -1 when the phase did not happen
+   } entry_t;
+
+   static void phase_calc(entry_t &entry);
+
+   mutable std::mutex   mutex_;
+   std::vector<entry_t> entries_;
+   size_t               capacity_;
+   size_t               next_ = 0;
+};
+
+#endif
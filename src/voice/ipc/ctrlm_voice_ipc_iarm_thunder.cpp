@@ -56,6 +56,7 @@
 #define JSON_TYPES                                    "types"
 #define JSON_MESSAGE                                  "message"
 #define JSON_MASK_PII                                 "maskPii"
+#define JSON_PHASE_LATENCY                            "phaseLatencyMs"
 #define JSON_STREAM_END_REASON                        "reason"
 #define JSON_SESSION_END_RESULT                       "result"
 #define JSON_SESSION_END_RESULT_SUCCESS               "success"
@@ -431,6 +432,7 @@ IARM_Result_t ctrlm_voice_ipc_iarm_thunder_t::status(void *data) {
                rc |= json_array_append_new(obj_capabilities, json_string("WWFEEDBACK"));
             }
             rc |= json_object_set_new_nocheck(obj, JSON_CAPABILITIES, obj_capabilities);
+            rc |= json_object_set_new_nocheck(obj, JSON_PHASE_LATENCY, ctrlm_get_voice_obj()->voice_session_phase_stats_json());
 
             if(rc) {
                 XLOGD_WARN("JSON error..");